@@ -0,0 +1,41 @@
+/**
+ * @file benchmark.h
+ * @author Ceyhun Şen
+ * @brief Common timing functions for benchmarks.
+ */
+
+#ifndef __BENCHMARK_H
+#define __BENCHMARK_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief Get monotonic time in nanoseconds.
+ */
+static inline uint64_t benchmark_now()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Print result of a benchmark.
+ * @param name Benchmark name.
+ * @param elapsed Total elapsed time in nanoseconds.
+ * @param iterations Iteration count.
+ */
+static inline void benchmark_report(const char *name, uint64_t elapsed, uint32_t iterations)
+{
+	double per_iteration = (double)elapsed / iterations;
+
+	printf("%-40s %10.1f ns/op %12.0f op/s\n", name, per_iteration, 1e9 / per_iteration);
+}
+
+#endif // __BENCHMARK_H
@@ -0,0 +1,140 @@
+/**
+ * @file codec.c
+ * @author Ceyhun Şen
+ * @brief Compression ratio and throughput of raw sample codec.
+ *
+ * Runs on a sample log given as argument (see ``mpu925x_log.h``), or on a
+ * synthetic 200 Hz recording of a walking, handheld sensor with sensor noise.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_codec.h"
+#include "mpu925x_log.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define CHANNELS     MPU925X_CODEC_FRAME_CHANNELS
+#define MAX_FRAMES   60000
+#define BUFFER_SIZE  1024
+#define REPEAT       20
+
+int16_t frames[MAX_FRAMES][CHANNELS], decoded[256][MPU925X_CODEC_MAX_CHANNELS];
+uint8_t *stream;
+uint32_t frame_count;
+
+/**
+ * @brief Uniform noise with about given standard deviation.
+ */
+static float noise(float deviation)
+{
+	return deviation * 3.4641f * ((float)rand() / RAND_MAX - 0.5f);
+}
+
+/**
+ * @brief Make synthetic recording: 2 g and 250 dps scales, magnetometer
+ * updates at 100 Hz.
+ */
+static void synthesize()
+{
+	for (uint32_t n = 0; n < MAX_FRAMES; n++) {
+		float t = n / 200.0f, step = 2 * 3.14159265f * 1.8f * t;
+
+		for (uint8_t i = 0; i < 3; i++) {
+			frames[n][i] = (int16_t)((i == 2) * 16384 + 3000 * sinf(step + i) + 800 * sinf(3 * step) + noise(8));
+			frames[n][4 + i] = (int16_t)(400 * sinf(step / 2 + i) + noise(4));
+			frames[n][7 + i] = (n & 1) ? frames[n - 1][7 + i] : (int16_t)(200 * cosf(t / 10 + i) + noise(1));
+		}
+		frames[n][3] = (int16_t)(1600 + 5 * t / 60 + noise(1));
+	}
+	frame_count = MAX_FRAMES;
+}
+
+/**
+ * @brief Read frames from a sample log.
+ */
+static uint8_t load(const char *path)
+{
+	mpu925x_t mpu925x = {0};
+	mpu925x_log_replay replay;
+
+	if (mpu925x_log_replay_open(&replay, path, 0)) {
+		return 1;
+	}
+	mpu925x_log_replay_attach(&replay, &mpu925x);
+	mpu925x_init(&mpu925x, 0);
+
+	while (frame_count < MAX_FRAMES && mpu925x_log_replay_next(&replay) == 0) {
+		mpu925x_get_all_raw(&mpu925x);
+		mpu925x_codec_frame(&mpu925x, frames[frame_count++]);
+	}
+	mpu925x_log_replay_close(&replay);
+
+	return frame_count == 0;
+}
+
+static void benchmark(uint8_t predictor, uint8_t coding, const char *name)
+{
+	uint8_t buffer[BUFFER_SIZE];
+	mpu925x_codec_encoder encoder = {
+		.channels = CHANNELS,
+		.predictor = predictor,
+		.coding = coding,
+		.block_frames = 200,
+		.buffer = buffer,
+		.buffer_size = sizeof(buffer)
+	};
+	mpu925x_codec_block block;
+	uint64_t encode_time = 0, decode_time = 0;
+	uint32_t size = 0;
+
+	for (uint8_t r = 0; r < REPEAT; r++) {
+		mpu925x_codec_encoder_init(&encoder);
+		size = 0;
+
+		uint64_t start = benchmark_now();
+		for (uint32_t n = 0; n <= frame_count; n++) {
+			uint16_t block_size = n < frame_count ? mpu925x_codec_encode(&encoder, frames[n]) : mpu925x_codec_flush(&encoder);
+			for (uint16_t i = 0; i < block_size; i++) {
+				stream[size + i] = buffer[i];
+			}
+			size += block_size;
+		}
+		encode_time += benchmark_now() - start;
+
+		start = benchmark_now();
+		uint32_t position = 0, consumed;
+		while ((consumed = mpu925x_codec_decode(&stream[position], size - position, &decoded[0][0], 256, &block)) > 0) {
+			position += consumed;
+		}
+		decode_time += benchmark_now() - start;
+	}
+
+	double raw = (double)frame_count * CHANNELS * 2;
+	printf("%-24s ratio %5.2f, %5.2f bits/sample, encode %7.1f MB/s, decode %7.1f MB/s\n", name,
+	       raw / size, size * 8.0 / (frame_count * CHANNELS),
+	       raw * REPEAT / encode_time * 1e3, raw * REPEAT / decode_time * 1e3);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1) {
+		if (load(argv[1])) {
+			printf("Can't read %s\n", argv[1]);
+			return 1;
+		}
+	}
+	else {
+		synthesize();
+	}
+
+	stream = malloc((size_t)frame_count * (MPU925X_CODEC_FRAME_SIZE(CHANNELS) + MPU925X_CODEC_OVERHEAD));
+	printf("%u frames, MB/s of raw frames:\n", frame_count);
+	benchmark(MPU925X_CODEC_NONE, MPU925X_CODEC_VARINT, "none, varint");
+	benchmark(MPU925X_CODEC_DELTA, MPU925X_CODEC_VARINT, "delta, varint");
+	benchmark(MPU925X_CODEC_DELTA, MPU925X_CODEC_RICE, "delta, rice");
+	benchmark(MPU925X_CODEC_LINEAR, MPU925X_CODEC_VARINT, "linear, varint");
+	benchmark(MPU925X_CODEC_LINEAR, MPU925X_CODEC_RICE, "linear, rice");
+	free(stream);
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file ekf_ahrs.c
+ * @author Ceyhun Şen
+ * @brief Benchmark for EKF AHRS update cost.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_ekf_ahrs.h"
+#include <math.h>
+
+#define ITERATIONS 1000000
+
+// Keeps results alive so compiler can't remove filter calls.
+volatile float sink;
+
+/**
+ * @brief Configure filter with typical noise levels.
+ */
+void prepare(mpu925x_ekf_ahrs *ekf, float magnetometer_noise)
+{
+	float acceleration[3] = {0, 0, 1};
+	float magnetic_field[3] = {0.4f, 0, -0.9f};
+
+	ekf->gyroscope_noise = 0.005f;
+	ekf->gyroscope_bias_noise = 0.0001f;
+	ekf->accelerometer_noise = 0.02f;
+	ekf->acceleration_rejection = 10.0f;
+	ekf->magnetometer_noise = magnetometer_noise;
+	ekf->sample_period = 0.001f;
+	mpu925x_ekf_ahrs_init(ekf);
+	mpu925x_ekf_ahrs_align(ekf, acceleration, magnetic_field);
+}
+
+void benchmark_predict()
+{
+	mpu925x_ekf_ahrs ekf;
+	float rotation[3] = {0.1f, -0.2f, 0.05f};
+
+	prepare(&ekf, 0);
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		mpu925x_ekf_ahrs_predict(&ekf, rotation, 0.001f);
+	}
+	benchmark_report("predict", benchmark_now() - start, ITERATIONS);
+	sink = ekf.quaternion[0];
+}
+
+void benchmark_update(float magnetometer_noise, const char *name)
+{
+	mpu925x_ekf_ahrs ekf;
+	float rotation[3] = {0.1f, -0.2f, 0.05f};
+	float acceleration[3], magnetic_field[3];
+
+	prepare(&ekf, magnetometer_noise);
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		float phase = (i & 0xFF) * 0.0245f;
+		acceleration[0] = 0.05f * sinf(phase);
+		acceleration[1] = 0.05f * cosf(phase);
+		acceleration[2] = 1.0f;
+		magnetic_field[0] = 0.4f;
+		magnetic_field[1] = 0.02f * sinf(phase);
+		magnetic_field[2] = -0.9f;
+		mpu925x_ekf_ahrs_predict(&ekf, rotation, 0.001f);
+		mpu925x_ekf_ahrs_correct_acceleration(&ekf, acceleration);
+		if (magnetometer_noise > 0) {
+			mpu925x_ekf_ahrs_correct_magnetic_field(&ekf, magnetic_field);
+		}
+	}
+	benchmark_report(name, benchmark_now() - start, ITERATIONS);
+	sink = ekf.quaternion[0];
+}
+
+int main()
+{
+	benchmark_predict();
+	benchmark_update(0, "predict + accelerometer");
+	benchmark_update(0.05f, "predict + accelerometer + magnetometer");
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file fifo.c
+ * @author Ceyhun Şen
+ * @brief Driver cost of draining and decoding FIFO on host.
+ *
+ * Bus is memory backed and FIFO is refilled before every read, so results
+ * show driver overhead on top of bus time.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_internals.h"
+#include <string.h>
+
+#define ITERATIONS 100000
+
+static uint8_t registers[256];
+static uint16_t fifo_count;
+
+/**
+ * @brief Memory backed bus read with an always full FIFO pattern.
+ */
+static uint8_t bus_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	if (reg == FIFO_R_W) {
+		for (uint8_t i = 0; i < size; i++) {
+			buffer[i] = i;
+		}
+		return 0;
+	}
+
+	registers[FIFO_COUNTH] = fifo_count >> 8;
+	registers[FIFO_COUNTL] = fifo_count & 0xFF;
+	memcpy(buffer, &registers[reg], size);
+	return 0;
+}
+
+/**
+ * @brief Memory backed bus write.
+ */
+static uint8_t bus_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	memcpy(&registers[reg], buffer, size);
+	return 0;
+}
+
+/**
+ * @brief Delay is not needed on memory backed bus.
+ */
+static void delay_ms(mpu925x_t *mpu925x, uint32_t delay)
+{
+
+}
+
+// Keeps results alive so compiler can't remove reads.
+volatile int16_t sink;
+
+void benchmark_drain(mpu925x_t *mpu925x, uint8_t sensors, const char *name)
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	mpu925x_fifo_frame frames[64];
+	uint32_t total = 0;
+
+	mpu925x_fifo_start(mpu925x, &capture, sensors, 8000);
+	fifo_count = (FIFO_SIZE - 1) / capture.layout.size * capture.layout.size;
+
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		total += mpu925x_fifo_read(mpu925x, &capture, frames, 64, &block);
+	}
+	benchmark_report(name, benchmark_now() - start, total);
+}
+
+void benchmark_drain_raw(mpu925x_t *mpu925x, uint8_t sensors, const char *name)
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	uint8_t raw[FIFO_SIZE];
+	uint32_t total = 0;
+
+	mpu925x_fifo_start(mpu925x, &capture, sensors, 8000);
+	fifo_count = (FIFO_SIZE - 1) / capture.layout.size * capture.layout.size;
+
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		uint16_t count = mpu925x_fifo_read_raw(mpu925x, &capture, raw, sizeof(raw), &block);
+		for (uint16_t n = 0; n < count; n++) {
+			sink = mpu925x_frame_value(&raw[n * capture.layout.size], capture.layout.acceleration);
+		}
+		total += count;
+	}
+	benchmark_report(name, benchmark_now() - start, total);
+}
+
+int main()
+{
+	mpu925x_t mpu925x = {
+		.master_specific = {
+			.bus_read = bus_read,
+			.bus_write = bus_write,
+			.delay_ms = delay_ms
+		}
+	};
+
+	registers[WHO_AM_I] = 0x71;
+	mpu925x_init(&mpu925x, 0);
+
+	printf("Per frame, nearly full FIFO:\n");
+	benchmark_drain(&mpu925x, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, "accelerometer + gyroscope");
+	benchmark_drain(&mpu925x, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_TEMPERATURE | MPU925X_FIFO_GYROSCOPE, "accelerometer + temperature + gyroscope");
+	benchmark_drain(&mpu925x, MPU925X_FIFO_GYROSCOPE, "gyroscope");
+
+	// AK8963 data and status through slave 0, decoded by generic path.
+	registers[I2C_SLV0_CTRL] = 0x87;
+	benchmark_drain(&mpu925x, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE | MPU925X_FIFO_SLAVE_0, "accelerometer + gyroscope + slave 0");
+	registers[I2C_SLV0_CTRL] = 0;
+	benchmark_drain_raw(&mpu925x, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, "raw, accelerometer + gyroscope");
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file filter.c
+ * @author Ceyhun Şen
+ * @brief Throughput of filter bank stages on blocks of three axis samples.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_filter.h"
+#include <math.h>
+#include <string.h>
+
+#define SAMPLE_RATE 8000.0f
+#define BLOCK       256
+#define BLOCKS      20000
+
+float input[BLOCK][3], samples[BLOCK][3];
+
+// Keeps results alive so compiler can't remove filter calls.
+volatile float sink;
+
+/**
+ * @brief Fill input with vibration like signal.
+ */
+void prepare_input()
+{
+	for (uint16_t n = 0; n < BLOCK; n++) {
+		for (uint8_t i = 0; i < 3; i++) {
+			input[n][i] = sinf(n * 0.1f * (i + 1)) + 0.3f * sinf(n * 1.3f);
+		}
+	}
+}
+
+void benchmark_filter(mpu925x_filter *filter, const char *name)
+{
+	uint64_t elapsed = 0;
+
+	for (uint32_t b = 0; b < BLOCKS; b++) {
+		memcpy(samples, input, sizeof(samples));
+		uint64_t start = benchmark_now();
+		mpu925x_filter_process(filter, samples, BLOCK);
+		elapsed += benchmark_now() - start;
+		sink = samples[BLOCK - 1][0];
+	}
+	benchmark_report(name, elapsed, BLOCKS * BLOCK);
+}
+
+void benchmark_decimator(uint8_t factor, uint8_t tap_count, const char *name)
+{
+	mpu925x_decimator decimator;
+	float taps[MPU925X_DECIMATOR_MAX_TAPS];
+	uint64_t elapsed = 0;
+
+	mpu925x_fir_lowpass(taps, tap_count, 0.4f / factor);
+	mpu925x_decimator_init(&decimator, factor, taps, tap_count);
+	for (uint32_t b = 0; b < BLOCKS; b++) {
+		memcpy(samples, input, sizeof(samples));
+		uint64_t start = benchmark_now();
+		mpu925x_decimator_process(&decimator, samples, BLOCK, samples);
+		elapsed += benchmark_now() - start;
+		sink = samples[0][0];
+	}
+	benchmark_report(name, elapsed, BLOCKS * BLOCK);
+}
+
+int main()
+{
+	mpu925x_filter filter;
+	mpu925x_biquad notch;
+
+	prepare_input();
+	printf("Per three axis input sample, blocks of %d samples:\n", BLOCK);
+
+	mpu925x_filter_init(&filter);
+	mpu925x_filter_add_butterworth_lowpass(&filter, 2, SAMPLE_RATE, 500);
+	benchmark_filter(&filter, "biquad x1 (2nd order low pass)");
+
+	mpu925x_filter_init(&filter);
+	mpu925x_filter_add_butterworth_lowpass(&filter, 4, SAMPLE_RATE, 500);
+	mpu925x_biquad_notch(&notch, SAMPLE_RATE, 120, 10);
+	mpu925x_filter_add(&filter, &notch);
+	mpu925x_biquad_notch(&notch, SAMPLE_RATE, 240, 10);
+	mpu925x_filter_add(&filter, &notch);
+	benchmark_filter(&filter, "biquad x4 (low pass + 2 notches)");
+
+	benchmark_decimator(4, 32, "decimator 32 taps, factor 4");
+	benchmark_decimator(8, 64, "decimator 64 taps, factor 8");
+
+	return 0;
+}
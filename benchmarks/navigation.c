@@ -0,0 +1,96 @@
+/**
+ * @file navigation.c
+ * @author Ceyhun Şen
+ * @brief Per sample cost of gravity compensation and dead reckoning.
+ */
+
+#include "benchmark.h"
+#include "mpu925x.h"
+#include "mpu925x_navigation.h"
+#include <math.h>
+#include <string.h>
+
+#define SAMPLE_RATE 4000.0f
+#define BLOCK       32
+#define BLOCKS      100000
+
+float acceleration[BLOCK][3], rotation[BLOCK][3], samples[BLOCK][3];
+
+// Keeps results alive so compiler can't remove navigation calls.
+volatile float sink;
+
+/**
+ * @brief Fill input with slightly moving, mostly still samples.
+ */
+void prepare_input()
+{
+	for (uint16_t n = 0; n < BLOCK; n++) {
+		acceleration[n][0] = 0.02f * sinf(n * 0.2f);
+		acceleration[n][1] = 0.5f;
+		acceleration[n][2] = 0.866f;
+		rotation[n][0] = sinf(n * 0.3f);
+		rotation[n][1] = 0;
+		rotation[n][2] = 0;
+	}
+}
+
+/**
+ * @brief Configure navigation with zero velocity updates.
+ */
+void prepare(mpu925x_navigation *navigation)
+{
+	memset(navigation, 0, sizeof(*navigation));
+	navigation->sample_period = 1 / SAMPLE_RATE;
+	navigation->zupt_acceleration = 0.05f;
+	navigation->zupt_rotation = 5;
+	navigation->zupt_samples = 100;
+	mpu925x_navigation_init(navigation);
+}
+
+void benchmark_update(const float quaternion[4])
+{
+	mpu925x_navigation navigation;
+	uint64_t start;
+
+	prepare(&navigation);
+	start = benchmark_now();
+	for (uint32_t b = 0; b < BLOCKS; b++) {
+		for (uint16_t n = 0; n < BLOCK; n++) {
+			mpu925x_navigation_update(&navigation, quaternion, acceleration[n], rotation[n]);
+		}
+	}
+	benchmark_report("update", benchmark_now() - start, BLOCKS * BLOCK);
+	sink = navigation.position[0];
+}
+
+void benchmark_process(const float quaternion[4], float (*gyroscope)[3], const char *name)
+{
+	mpu925x_navigation navigation;
+	// Drift corrected period of a FIFO block, 0.2% slow oscillator.
+	mpu925x_fifo_block block = {.period = 1e6f / SAMPLE_RATE * 1.002f};
+	uint64_t elapsed = 0;
+
+	prepare(&navigation);
+	for (uint32_t b = 0; b < BLOCKS; b++) {
+		memcpy(samples, acceleration, sizeof(samples));
+		uint64_t start = benchmark_now();
+		mpu925x_navigation_process(&navigation, quaternion, samples, gyroscope, BLOCK, block.period * 1e-6f);
+		elapsed += benchmark_now() - start;
+		sink = samples[BLOCK - 1][0];
+	}
+	benchmark_report(name, elapsed, BLOCKS * BLOCK);
+}
+
+int main()
+{
+	// 30 degrees about x axis.
+	float quaternion[4] = {0.9659258f, 0.2588190f, 0, 0};
+
+	prepare_input();
+	printf("Per sample, blocks of %d samples:\n", BLOCK);
+	benchmark_update(quaternion);
+	benchmark_process(quaternion, rotation, "process");
+	benchmark_process(quaternion, NULL, "process (acceleration only ZUPT)");
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file shm_latency.c
+ * @author Ceyhun Şen
+ * @brief Benchmark for latency from acquisition to client visibility over
+ * shared memory ring.
+ * 
+ * Publisher thread plays daemon with a simulated sensor at 1 kHz, client
+ * thread busy-polls the ring like a controller would.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_shm.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+#define SAMPLES 3000
+#define PERIOD_NS 1000000
+
+static const char *name = "/mpu925x_benchmark";
+static uint64_t latency[SAMPLES];
+static uint32_t lost;
+
+/**
+ * @brief Publisher thread, publishes samples on absolute deadlines.
+ */
+static void *publisher(void *argument)
+{
+	mpu925x_shm_writer *writer = argument;
+	mpu925x_t mpu925x = {0};
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	for (uint32_t i = 0; i < SAMPLES; i++) {
+		deadline.tv_nsec += PERIOD_NS;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_nsec -= 1000000000L;
+			deadline.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+		// Acquisition time in nanoseconds, stands in for bus read.
+		mpu925x.sensor_data.timestamp = benchmark_now();
+		mpu925x.sensor_data.acceleration_raw[0] = i;
+		mpu925x_shm_publish(writer, &mpu925x);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Client thread, polls ring until all samples are seen.
+ */
+static void *client(void *argument)
+{
+	mpu925x_shm_reader *reader = argument;
+	mpu925x_shm_sample sample;
+	uint32_t received = 0;
+
+	while (received < SAMPLES) {
+		uint8_t status = mpu925x_shm_read_next(reader, &sample);
+		if (status == 1) {
+			continue;
+		}
+		uint64_t now = benchmark_now();
+		if (status == 2) {
+			lost++;
+		}
+		if (sample.sequence < SAMPLES) {
+			latency[sample.sequence] = now - sample.timestamp;
+		}
+		received = sample.sequence + 1;
+	}
+
+	return NULL;
+}
+
+static int compare(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+int main()
+{
+	mpu925x_shm_writer writer;
+	mpu925x_shm_reader reader;
+	mpu925x_shm_sample sample;
+	pthread_t threads[2];
+
+	if (mpu925x_shm_create(&writer, name, 1024, 1000) != 0 || mpu925x_shm_open(&reader, name) != 0) {
+		printf("Can't create shared memory.\n");
+		return 1;
+	}
+
+	pthread_create(&threads[1], NULL, client, &reader);
+	pthread_create(&threads[0], NULL, publisher, &writer);
+	pthread_join(threads[0], NULL);
+	pthread_join(threads[1], NULL);
+
+	qsort(latency, SAMPLES, sizeof(latency[0]), compare);
+	printf("acquisition to client visibility (%d samples, %u lost)\n", SAMPLES, lost);
+	printf("  min %llu ns, median %llu ns, p99 %llu ns, max %llu ns\n",
+	       (unsigned long long)latency[0], (unsigned long long)latency[SAMPLES / 2],
+	       (unsigned long long)latency[SAMPLES * 99 / 100], (unsigned long long)latency[SAMPLES - 1]);
+
+	// Cost of a client read without contention.
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < 1000000; i++) {
+		mpu925x_shm_read_latest(&reader, &sample);
+	}
+	benchmark_report("read latest", benchmark_now() - start, 1000000);
+
+	mpu925x_shm_close(&reader);
+	mpu925x_shm_destroy(&writer);
+
+	return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file spectrum.c
+ * @author Ceyhun Şen
+ * @brief Benchmark for in place real FFT and Welch power spectral density.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_spectrum.h"
+#include <math.h>
+
+#define SAMPLE_RATE 8000.0f
+#define ITERATIONS  20000
+
+float data[1024], input[1024][3];
+
+// Keeps results alive so compiler can't remove calls.
+volatile float sink;
+
+void benchmark_fft(uint16_t size, const char *name)
+{
+	uint64_t elapsed = 0;
+
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		for (uint16_t n = 0; n < size; n++) {
+			data[n] = input[n][0];
+		}
+		uint64_t start = benchmark_now();
+		mpu925x_fft_real(data, size);
+		elapsed += benchmark_now() - start;
+		sink = data[1];
+	}
+	benchmark_report(name, elapsed, ITERATIONS);
+}
+
+void benchmark_welch(uint16_t segment_size, const char *name)
+{
+	mpu925x_welch welch;
+	float buffer[1024 * 3 / 2], psd[1024 / 2 + 1];
+
+	mpu925x_welch_init(&welch, buffer, psd, segment_size, SAMPLE_RATE);
+	uint64_t start = benchmark_now();
+	for (uint32_t i = 0; i < ITERATIONS / 10; i++) {
+		mpu925x_welch_push(&welch, &input[0][2], 1024, 3);
+	}
+	benchmark_report(name, benchmark_now() - start, ITERATIONS / 10 * 1024);
+	sink = mpu925x_welch_band_power(&welch, 100, 1000);
+}
+
+int main()
+{
+	for (uint16_t n = 0; n < 1024; n++) {
+		for (uint8_t i = 0; i < 3; i++) {
+			input[n][i] = sinf(2 * 3.14159265f * 120 * (i + 1) * n / SAMPLE_RATE) + 0.01f * (n % 7);
+		}
+	}
+
+	benchmark_fft(256, "real FFT 256");
+	benchmark_fft(1024, "real FFT 1024");
+	printf("Per input sample:\n");
+	benchmark_welch(256, "Welch, 256 segment");
+	benchmark_welch(1024, "Welch, 1024 segment");
+
+	return 0;
+}
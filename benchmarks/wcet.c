@@ -0,0 +1,125 @@
+/**
+ * @file wcet.c
+ * @author Ceyhun Şen
+ * @brief Worst observed execution time of hot-path functions on host.
+ *
+ * Bus functions are memory backed and cost is measured per call, so results
+ * show driver overhead on top of bus time. Bus time is bounded by
+ * ``MPU925X_TRANSACTIONS_*`` transactions.
+ */
+
+#include "benchmark.h"
+#include "mpu925x_internals.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CALLS 100000
+
+static uint8_t registers[2][256];
+static uint64_t elapsed[CALLS];
+
+/**
+ * @brief Memory backed bus read.
+ */
+static uint8_t bus_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	memcpy(buffer, &registers[slave_address == AK8963_ADDRESS][reg], size);
+	return 0;
+}
+
+/**
+ * @brief Memory backed bus write.
+ */
+static uint8_t bus_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	memcpy(&registers[slave_address == AK8963_ADDRESS][reg], buffer, size);
+	return 0;
+}
+
+/**
+ * @brief Delay is not needed on memory backed bus.
+ */
+static void delay_ms(mpu925x_t *mpu925x, uint32_t delay)
+{
+
+}
+
+/**
+ * @brief Compare function for sorting.
+ */
+static int compare(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Measure every call of a function and print distribution.
+ */
+static void measure(const char *name, mpu925x_t *mpu925x, mpu925x_scheduler *scheduler, void (*function)(mpu925x_t *, mpu925x_scheduler *))
+{
+	for (uint32_t i = 0; i < CALLS; i++) {
+		// Data changes on every call, magnetometer is ready every 10th call.
+		registers[0][ACCEL_XOUT_H + i % 14] = i;
+		registers[1][ST1] = i % 10 == 0;
+
+		uint64_t start = benchmark_now();
+		function(mpu925x, scheduler);
+		elapsed[i] = benchmark_now() - start;
+	}
+
+	qsort(elapsed, CALLS, sizeof(elapsed[0]), compare);
+	printf("%-40s median %6llu ns, p99.9 %6llu ns, max %6llu ns\n", name,
+	       (unsigned long long)elapsed[CALLS / 2],
+	       (unsigned long long)elapsed[CALLS - CALLS / 1000],
+	       (unsigned long long)elapsed[CALLS - 1]);
+}
+
+static void get_acceleration(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler)
+{
+	mpu925x_get_acceleration(mpu925x);
+}
+
+static void get_magnetic_field(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler)
+{
+	mpu925x_get_magnetic_field(mpu925x);
+}
+
+static void get_all(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler)
+{
+	mpu925x_get_all(mpu925x);
+}
+
+static void scheduler_get_all(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler)
+{
+	mpu925x_scheduler_get_all(mpu925x, scheduler);
+}
+
+int main()
+{
+	mpu925x_t mpu925x = {
+		.master_specific = {
+			.bus_read = bus_read,
+			.bus_write = bus_write,
+			.delay_ms = delay_ms
+		},
+		.settings = {
+			.measurement_mode = mpu925x_pipelined_measurement_mode,
+			.real_time = 1
+		}
+	};
+	mpu925x_scheduler scheduler;
+
+	registers[0][WHO_AM_I] = 0x71;
+	registers[1][WIA] = 0x48;
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+
+	measure("get_acceleration", &mpu925x, &scheduler, get_acceleration);
+	measure("get_magnetic_field (pipelined)", &mpu925x, &scheduler, get_magnetic_field);
+	measure("get_all", &mpu925x, &scheduler, get_all);
+	measure("scheduler_get_all", &mpu925x, &scheduler, scheduler_get_all);
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Reference Linux daemon which publishes MPU-925X samples over shared
+ * memory.
+ * 
+ * Usage: linux_shm_daemon [i2c device] [shared memory name] [rate in Hz]
+ * 
+ * Build:
+ * gcc -O2 -I../inc -I../extras ../src/mpu925x_*.c ../extras/mpu925x_linux_i2c.c
+ * ../extras/mpu925x_shm.c linux_shm_daemon.c -o linux_shm_daemon -lrt
+ * 
+ * Clients map the ring with ``mpu925x_shm_open`` and read samples without
+ * system calls, see ``mpu925x_shm.h``.
+ * */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "mpu925x.h"
+#include "mpu925x_linux_i2c.h"
+#include "mpu925x_shm.h"
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Ring holds 1 second of samples at 1 kHz.
+#define RING_CAPACITY 1024
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int signal_number)
+{
+	running = 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *device = argc > 1 ? argv[1] : "/dev/i2c-1";
+	const char *name = argc > 2 ? argv[2] : "/mpu925x";
+	uint32_t rate = argc > 3 ? strtoul(argv[3], NULL, 10) : 1000;
+	mpu925x_t mpu925x = {
+		.settings = {
+			.accelerometer_scale = mpu925x_2g,
+			.gyroscope_scale = mpu925x_500dps,
+			.orientation = mpu925x_z_plus
+		}
+	};
+	mpu925x_linux_i2c transport;
+	mpu925x_scheduler scheduler;
+	mpu925x_shm_writer writer;
+
+	if (rate == 0 || rate > 1000) {
+		fprintf(stderr, "Rate must be between 1 and 1000 Hz.\n");
+		return 1;
+	}
+
+	if (mpu925x_linux_i2c_open(&transport, &mpu925x, device) != 0) {
+		fprintf(stderr, "Can't open %s.\n", device);
+		return 1;
+	}
+	if (mpu925x_init(&mpu925x, 0) != 0) {
+		fprintf(stderr, "Can't initialize sensor.\n");
+		return 1;
+	}
+
+	// Output data rate is 1 kHz / (1 + divider) with low pass filters enabled.
+	mpu925x_set_accelerometer_dlpf(&mpu925x, 1, 2);
+	mpu925x_set_gyroscope_dlpf(&mpu925x, 0b11, 2);
+	mpu925x_set_sample_rate_divider(&mpu925x, 1000 / rate - 1);
+	rate = 1000 / (1000 / rate);
+	mpu925x_scheduler_init(&mpu925x, &scheduler, rate);
+
+	if (mpu925x_shm_create(&writer, name, RING_CAPACITY, rate) != 0) {
+		fprintf(stderr, "Can't create shared memory %s.\n", name);
+		return 1;
+	}
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+
+	// Real-time priority reduces acquisition jitter, it needs privileges.
+	struct sched_param parameter = {.sched_priority = 50};
+	if (sched_setscheduler(0, SCHED_FIFO, &parameter) != 0) {
+		fprintf(stderr, "Running without real-time priority.\n");
+	}
+
+	// Acquire on absolute deadlines, so period doesn't drift with work time.
+	struct timespec deadline;
+	long period = 1000000000L / rate;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	while (running) {
+		deadline.tv_nsec += period;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_nsec -= 1000000000L;
+			deadline.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+		mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+		mpu925x_shm_publish(&writer, &mpu925x);
+	}
+
+	mpu925x_shm_destroy(&writer);
+	mpu925x_linux_i2c_close(&transport);
+
+	return 0;
+}
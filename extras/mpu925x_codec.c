@@ -0,0 +1,486 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Raw sample codec for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_codec.h"
+#include "mpu925x_internals.h"
+#include <stddef.h>
+
+#define CODEC_SYNC_0      0xA5
+#define CODEC_SYNC_1      0x5A
+#define CODEC_HEADER_SIZE 12
+#define CODEC_PAYLOAD     (2 + CODEC_HEADER_SIZE)
+
+// Rice coding
+#define RICE_ESCAPE       16
+#define RICE_INITIAL_SUM  4
+#define RICE_RESCALE      32
+
+/*******************************************************************************
+ * Residual helpers
+ ******************************************************************************/
+
+static uint16_t zigzag(uint16_t residual)
+{
+	return (uint16_t)(residual << 1) ^ (uint16_t)-(residual >> 15);
+}
+
+static uint16_t unzigzag(uint16_t value)
+{
+	return (value >> 1) ^ (uint16_t)-(value & 1);
+}
+
+/**
+ * @brief Predict a sample from previous samples of the same block.
+ * @param previous Last two samples of every channel.
+ * @param predictor Predictor type.
+ * @param index Index of frame in block.
+ * @param channel Channel index.
+ * @returns Prediction.
+ * */
+static uint16_t predict(int16_t previous[2][MPU925X_CODEC_MAX_CHANNELS], uint8_t predictor, uint16_t index, uint8_t channel)
+{
+	if (predictor == MPU925X_CODEC_NONE || index == 0) {
+		return 0;
+	}
+	else if (predictor == MPU925X_CODEC_DELTA || index == 1) {
+		return (uint16_t)previous[0][channel];
+	}
+	else {
+		return (uint16_t)(2 * (uint16_t)previous[0][channel] - (uint16_t)previous[1][channel]);
+	}
+}
+
+/**
+ * @brief Rice parameter from mean residual of a channel.
+ * */
+static uint8_t rice_parameter(uint32_t sum, uint8_t count)
+{
+	uint8_t k = 0;
+
+	while (((uint32_t)count << k) < sum && k < 15) {
+		k++;
+	}
+
+	return k;
+}
+
+/**
+ * @brief Update Rice statistics after a frame.
+ * */
+static void rice_update(uint32_t *sum, uint8_t *count, uint8_t channels)
+{
+	if (++*count == RICE_RESCALE) {
+		for (uint8_t i = 0; i < channels; i++) {
+			sum[i] >>= 1;
+		}
+		*count >>= 1;
+	}
+}
+
+/*******************************************************************************
+ * Encoder
+ ******************************************************************************/
+
+/**
+ * @brief Make a frame of last read raw sample.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param frame Frame of ``MPU925X_CODEC_FRAME_CHANNELS`` channels.
+ * */
+void mpu925x_codec_frame(mpu925x_t *mpu925x, int16_t *frame)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		frame[i] = mpu925x->sensor_data.acceleration_raw[i];
+		frame[4 + i] = mpu925x->sensor_data.rotation_raw[i];
+		frame[7 + i] = mpu925x->sensor_data.magnet_raw[i];
+	}
+	frame[3] = mpu925x->sensor_data.temperature_raw;
+}
+
+/**
+ * @brief Check configuration and reset encoder.
+ * @param encoder Encoder struct pointer.
+ * @returns 0 on success, 1 on invalid configuration.
+ * */
+uint8_t mpu925x_codec_encoder_init(mpu925x_codec_encoder *encoder)
+{
+	if (encoder->channels == 0 || encoder->channels > MPU925X_CODEC_MAX_CHANNELS ||
+	    encoder->predictor > MPU925X_CODEC_LINEAR || encoder->coding > MPU925X_CODEC_RICE ||
+	    encoder->block_frames == 0 || encoder->buffer == NULL ||
+	    encoder->buffer_size < MPU925X_CODEC_OVERHEAD + MPU925X_CODEC_FRAME_SIZE(encoder->channels)) {
+		return 1;
+	}
+
+	encoder->sequence = 0;
+	encoder->frames = 0;
+
+	return 0;
+}
+
+static void put_byte(mpu925x_codec_encoder *encoder, uint8_t byte)
+{
+	encoder->buffer[encoder->size++] = byte;
+}
+
+/**
+ * @brief Append up to 16 bits to bit stream.
+ * */
+static void put_bits(mpu925x_codec_encoder *encoder, uint32_t value, uint8_t count)
+{
+	encoder->bits = (encoder->bits << count) | value;
+	encoder->bit_count += count;
+
+	while (encoder->bit_count >= 8) {
+		encoder->bit_count -= 8;
+		put_byte(encoder, (uint8_t)(encoder->bits >> encoder->bit_count));
+	}
+	encoder->bits &= (1UL << encoder->bit_count) - 1;
+}
+
+static void put_varint(mpu925x_codec_encoder *encoder, uint16_t value)
+{
+	while (value >= 0x80) {
+		put_byte(encoder, (uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	put_byte(encoder, (uint8_t)value);
+}
+
+static void put_rice(mpu925x_codec_encoder *encoder, uint16_t value, uint8_t k)
+{
+	uint16_t quotient = value >> k;
+
+	if (quotient >= RICE_ESCAPE) {
+		put_bits(encoder, (1UL << RICE_ESCAPE) - 1, RICE_ESCAPE);
+		put_bits(encoder, value, 16);
+	}
+	else {
+		// Ones, terminating zero and remainder.
+		put_bits(encoder, ((1UL << quotient) - 1) << 1, quotient + 1);
+		put_bits(encoder, value & ((1UL << k) - 1), k);
+	}
+}
+
+/**
+ * @brief Close current block with header and checksum.
+ * @returns Block size.
+ * */
+static uint16_t finish_block(mpu925x_codec_encoder *encoder)
+{
+	uint8_t *buffer = encoder->buffer;
+
+	// Pad bit stream to a byte.
+	if (encoder->bit_count > 0) {
+		put_bits(encoder, 0, 8 - encoder->bit_count);
+	}
+
+	uint16_t payload_size = encoder->size - CODEC_PAYLOAD;
+	buffer[0] = CODEC_SYNC_0;
+	buffer[1] = CODEC_SYNC_1;
+	buffer[2] = (MPU925X_CODEC_VERSION << 4) | encoder->predictor;
+	buffer[3] = encoder->coding;
+	buffer[4] = encoder->channels;
+	buffer[5] = 0;
+	buffer[6] = (uint8_t)encoder->frames;
+	buffer[7] = (uint8_t)(encoder->frames >> 8);
+	buffer[8] = (uint8_t)payload_size;
+	buffer[9] = (uint8_t)(payload_size >> 8);
+	for (uint8_t i = 0; i < 4; i++) {
+		buffer[10 + i] = (uint8_t)(encoder->sequence >> (i * 8));
+	}
+
+	uint16_t crc = mpu925x_crc16(&buffer[2], CODEC_HEADER_SIZE + payload_size);
+	put_byte(encoder, (uint8_t)crc);
+	put_byte(encoder, (uint8_t)(crc >> 8));
+
+	encoder->sequence += encoder->frames;
+	encoder->frames = 0;
+
+	return encoder->size;
+}
+
+/**
+ * @brief Encode a frame.
+ * 
+ * Block is completed when it has ``block_frames`` frames or buffer can't
+ * hold another frame.
+ * @param encoder Encoder struct pointer.
+ * @param frame Frame of ``channels`` samples.
+ * @returns Size of completed block in ``buffer``, 0 if block is not
+ * complete yet.
+ * */
+uint16_t mpu925x_codec_encode(mpu925x_codec_encoder *encoder, const int16_t *frame)
+{
+	uint8_t channels = encoder->channels;
+
+	if (encoder->frames == 0) {
+		encoder->size = CODEC_PAYLOAD;
+		encoder->bits = 0;
+		encoder->bit_count = 0;
+		encoder->rice_count = 1;
+		for (uint8_t i = 0; i < channels; i++) {
+			encoder->rice_sum[i] = RICE_INITIAL_SUM;
+		}
+	}
+
+	for (uint8_t i = 0; i < channels; i++) {
+		uint16_t prediction = predict(encoder->previous, encoder->predictor, encoder->frames, i);
+		uint16_t value = zigzag((uint16_t)frame[i] - prediction);
+
+		if (encoder->coding == MPU925X_CODEC_VARINT) {
+			put_varint(encoder, value);
+		}
+		else {
+			put_rice(encoder, value, rice_parameter(encoder->rice_sum[i], encoder->rice_count));
+			encoder->rice_sum[i] += value;
+		}
+
+		encoder->previous[1][i] = encoder->previous[0][i];
+		encoder->previous[0][i] = frame[i];
+	}
+	rice_update(encoder->rice_sum, &encoder->rice_count, channels);
+	encoder->frames++;
+
+	if (encoder->frames >= encoder->block_frames ||
+	    encoder->size + MPU925X_CODEC_FRAME_SIZE(channels) + 2 > encoder->buffer_size) {
+		return finish_block(encoder);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Complete a partial block.
+ * @param encoder Encoder struct pointer.
+ * @returns Size of completed block in ``buffer``, 0 if there are no
+ * pending frames.
+ * */
+uint16_t mpu925x_codec_flush(mpu925x_codec_encoder *encoder)
+{
+	if (encoder->frames == 0) {
+		return 0;
+	}
+
+	return finish_block(encoder);
+}
+
+/*******************************************************************************
+ * Decoder
+ ******************************************************************************/
+
+typedef struct codec_reader {
+	const uint8_t *data;
+	uint16_t size;
+	uint16_t position;
+	uint32_t bits;
+	uint8_t bit_count;
+} codec_reader;
+
+/**
+ * @brief Read up to 16 bits from bit stream.
+ * @returns 0 on success, 1 at end of payload.
+ * */
+static uint8_t get_bits(codec_reader *reader, uint8_t count, uint16_t *value)
+{
+	while (reader->bit_count < count) {
+		if (reader->position >= reader->size) {
+			return 1;
+		}
+		reader->bits = (reader->bits << 8) | reader->data[reader->position++];
+		reader->bit_count += 8;
+	}
+
+	reader->bit_count -= count;
+	*value = (uint16_t)((reader->bits >> reader->bit_count) & ((1UL << count) - 1));
+	reader->bits &= (1UL << reader->bit_count) - 1;
+
+	return 0;
+}
+
+static uint8_t get_varint(codec_reader *reader, uint16_t *value)
+{
+	uint32_t result = 0;
+
+	for (uint8_t shift = 0; shift < 21; shift += 7) {
+		if (reader->position >= reader->size) {
+			return 1;
+		}
+
+		uint8_t byte = reader->data[reader->position++];
+		result |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			*value = (uint16_t)result;
+			return result > UINT16_MAX;
+		}
+	}
+
+	return 1;
+}
+
+static uint8_t get_rice(codec_reader *reader, uint8_t k, uint16_t *value)
+{
+	uint16_t quotient = 0, bit, remainder;
+
+	do {
+		if (get_bits(reader, 1, &bit)) {
+			return 1;
+		}
+		quotient += bit;
+	} while (bit && quotient < RICE_ESCAPE);
+
+	if (quotient == RICE_ESCAPE) {
+		return get_bits(reader, 16, value);
+	}
+
+	if (get_bits(reader, k, &remainder)) {
+		return 1;
+	}
+	*value = (uint16_t)((quotient << k) | remainder);
+
+	return 0;
+}
+
+/**
+ * @brief Decode payload of a block.
+ * @returns 0 on success, 1 on malformed payload.
+ * */
+static uint8_t decode_payload(codec_reader *reader, uint8_t predictor, uint8_t coding, uint8_t channels, uint16_t count, int16_t *frames)
+{
+	int16_t previous[2][MPU925X_CODEC_MAX_CHANNELS] = {0};
+	uint32_t rice_sum[MPU925X_CODEC_MAX_CHANNELS];
+	uint8_t rice_count = 1;
+
+	for (uint8_t i = 0; i < channels; i++) {
+		rice_sum[i] = RICE_INITIAL_SUM;
+	}
+
+	for (uint16_t n = 0; n < count; n++) {
+		for (uint8_t i = 0; i < channels; i++) {
+			uint16_t value;
+
+			if (coding == MPU925X_CODEC_VARINT) {
+				if (get_varint(reader, &value)) {
+					return 1;
+				}
+			}
+			else {
+				if (get_rice(reader, rice_parameter(rice_sum[i], rice_count), &value)) {
+					return 1;
+				}
+				rice_sum[i] += value;
+			}
+
+			int16_t sample = (int16_t)(unzigzag(value) + predict(previous, predictor, n, i));
+			frames[n * channels + i] = sample;
+			previous[1][i] = previous[0][i];
+			previous[0][i] = sample;
+		}
+		rice_update(rice_sum, &rice_count, channels);
+	}
+
+	// Only padding may be left.
+	return reader->position != reader->size || reader->bits != 0;
+}
+
+/**
+ * @brief Decode next block from a byte stream.
+ * 
+ * Bytes before a valid block (noise, corrupt or truncated blocks) are
+ * skipped. If no complete block is found, returned size is the number of
+ * bytes that can be dropped and ``block->count`` is 0, rest of data must be
+ * kept and passed again with more data. Blocks are only accepted if their
+ * frames fit in ``max_frames``.
+ * @param data Received bytes.
+ * @param size Number of received bytes.
+ * @param frames Decoded frames, room for ``max_frames`` frames of
+ * ``MPU925X_CODEC_MAX_CHANNELS`` samples. Frames are packed with channel
+ * count of block.
+ * @param max_frames Capacity of ``frames``.
+ * @param block Decoded block information.
+ * @returns Number of consumed bytes.
+ * */
+uint32_t mpu925x_codec_decode(const uint8_t *data, uint32_t size, int16_t *frames, uint16_t max_frames, mpu925x_codec_block *block)
+{
+	uint32_t position = 0;
+
+	block->count = 0;
+
+	for (; position + 2 <= size; position++) {
+		if (data[position] != CODEC_SYNC_0 || data[position + 1] != CODEC_SYNC_1) {
+			continue;
+		}
+		if (size - position < MPU925X_CODEC_OVERHEAD) {
+			break;
+		}
+
+		const uint8_t *header = &data[position + 2];
+		uint8_t predictor = header[0] & 0x0F;
+		uint8_t coding = header[1];
+		uint8_t channels = header[2];
+		uint16_t count = header[4] | (header[5] << 8);
+		uint16_t payload_size = header[6] | (header[7] << 8);
+
+		// Reject implausible headers without waiting for their payload.
+		if (header[0] >> 4 != MPU925X_CODEC_VERSION || predictor > MPU925X_CODEC_LINEAR ||
+		    coding > MPU925X_CODEC_RICE || channels == 0 || channels > MPU925X_CODEC_MAX_CHANNELS ||
+		    count == 0 || count > max_frames ||
+		    payload_size > (uint32_t)count * MPU925X_CODEC_FRAME_SIZE(channels)) {
+			continue;
+		}
+
+		uint32_t block_size = MPU925X_CODEC_OVERHEAD + payload_size;
+		if (size - position < block_size) {
+			break;
+		}
+
+		uint16_t crc = data[position + block_size - 2] | (data[position + block_size - 1] << 8);
+		if (mpu925x_crc16(header, CODEC_HEADER_SIZE + payload_size) != crc) {
+			continue;
+		}
+
+		codec_reader reader = {
+			.data = &header[CODEC_HEADER_SIZE],
+			.size = payload_size
+		};
+		if (decode_payload(&reader, predictor, coding, channels, count, frames)) {
+			continue;
+		}
+
+		block->sequence = header[8] | (header[9] << 8) | ((uint32_t)header[10] << 16) | ((uint32_t)header[11] << 24);
+		block->count = count;
+		block->channels = channels;
+		block->skipped = position;
+
+		return position + block_size;
+	}
+
+	// Keep a possible start of sync marker.
+	if (position + 1 == size && data[position] != CODEC_SYNC_0) {
+		position++;
+	}
+	block->skipped = position;
+
+	return position;
+}
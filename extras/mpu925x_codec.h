@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Raw sample codec header file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_CODEC_H
+#define __MPU925X_CODEC_H
+
+#include "mpu925x.h"
+
+/*
+ * Block format:
+ * 
+ * Sync marker 0xA5 0x5A, 12 byte header, payload and CRC-16/CCITT-FALSE of
+ * header and payload. Header (little endian): 1 byte version (high nibble)
+ * and predictor (low nibble), 1 byte coding, 1 byte channel count, 1 byte
+ * reserved, 2 byte frame count, 2 byte payload size and 4 byte sequence
+ * number of first frame.
+ * 
+ * Payload holds a residual per channel per frame, frame by frame. Residual is
+ * sample minus prediction (modulo 2^16) and it is zigzag mapped. Prediction
+ * restarts at every block, so each block can be decoded alone and a decoder
+ * can resync on next marker after a lost or corrupt block.
+ * 
+ * Varint coding: 7 bits per byte, least significant group first, high bit
+ * set if more bytes follow.
+ * 
+ * Rice coding: bit stream, most significant bit first, padded to a byte at
+ * the end of block. Each residual is quotient in unary (ones ended with a
+ * zero) and k low bits, k adapts to mean residual of its channel. Quotients
+ * from 16 are escaped as 16 ones and 16 bit raw value.
+ */
+
+#define MPU925X_CODEC_VERSION       1
+#define MPU925X_CODEC_MAX_CHANNELS  16
+#define MPU925X_CODEC_OVERHEAD      16
+
+/**
+ * @brief Worst case encoded size of a frame.
+ * */
+#define MPU925X_CODEC_FRAME_SIZE(channels) (4 * (channels) + 1)
+
+/**
+ * @brief Channels of a frame made by ``mpu925x_codec_frame``: acceleration,
+ * temperature, rotation and magnetic field.
+ * */
+#define MPU925X_CODEC_FRAME_CHANNELS 10
+
+/**
+ * @brief Predictors.
+ * */
+#define MPU925X_CODEC_NONE   0
+#define MPU925X_CODEC_DELTA  1
+#define MPU925X_CODEC_LINEAR 2
+
+/**
+ * @brief Residual codings.
+ * */
+#define MPU925X_CODEC_VARINT 0
+#define MPU925X_CODEC_RICE   1
+
+/**
+ * @brief Streaming encoder.
+ * 
+ * Frames are encoded into user owned ``buffer`` until ``block_frames``
+ * frames are collected or buffer can't hold another frame, then block is
+ * complete. Configuration fields must be set before
+ * ``mpu925x_codec_encoder_init``:
+ * - ``channels``: channel count, up to ``MPU925X_CODEC_MAX_CHANNELS``.
+ * - ``predictor``: ``MPU925X_CODEC_DELTA`` suits most sensor data,
+ *   ``MPU925X_CODEC_LINEAR`` suits smooth, oversampled signals.
+ * - ``coding``: ``MPU925X_CODEC_VARINT`` is byte aligned and fastest,
+ *   ``MPU925X_CODEC_RICE`` packs bits and compresses noisy data better.
+ * - ``buffer`` and ``buffer_size``: block buffer, at least
+ *   ``MPU925X_CODEC_OVERHEAD + MPU925X_CODEC_FRAME_SIZE(channels)`` bytes.
+ * 
+ * Completed block stays in buffer until next call to
+ * ``mpu925x_codec_encode``, it must be sent or copied before that.
+ * */
+typedef struct mpu925x_codec_encoder {
+	// Configuration
+	uint8_t channels;
+	uint8_t predictor;
+	uint8_t coding;
+	uint16_t block_frames;
+	uint8_t *buffer;
+	uint16_t buffer_size;
+
+	// State
+	int16_t previous[2][MPU925X_CODEC_MAX_CHANNELS];
+	uint32_t rice_sum[MPU925X_CODEC_MAX_CHANNELS];
+	uint8_t rice_count;
+	uint32_t sequence;
+	uint16_t frames;
+	uint16_t size;
+	uint32_t bits;
+	uint8_t bit_count;
+} mpu925x_codec_encoder;
+
+/**
+ * @brief Decoded block information.
+ * */
+typedef struct mpu925x_codec_block {
+	uint32_t sequence;
+	uint16_t count;
+	uint8_t channels;
+	uint32_t skipped;
+} mpu925x_codec_block;
+
+void mpu925x_codec_frame(mpu925x_t *mpu925x, int16_t *frame);
+uint8_t mpu925x_codec_encoder_init(mpu925x_codec_encoder *encoder);
+uint16_t mpu925x_codec_encode(mpu925x_codec_encoder *encoder, const int16_t *frame);
+uint16_t mpu925x_codec_flush(mpu925x_codec_encoder *encoder);
+uint32_t mpu925x_codec_decode(const uint8_t *data, uint32_t size, int16_t *frames, uint16_t max_frames, mpu925x_codec_block *block);
+
+#endif // __MPU925X_CODEC_H
@@ -0,0 +1,444 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Extended Kalman filter AHRS source file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_ekf_ahrs.h"
+#include <math.h>
+#include <stddef.h>
+
+#define DEGREES_TO_RADIANS         0.017453292519943295f
+#define RADIANS_TO_DEGREES         57.29577951308232f
+
+// Initial standard deviations of attitude (rad) and gyroscope bias (rad/s).
+#define INITIAL_ATTITUDE_SIGMA     0.1f
+#define INITIAL_BIAS_SIGMA         0.05f
+
+/*******************************************************************************
+ * 3x3 kernels
+ ******************************************************************************/
+
+// r = a * b
+static void multiply(float a[3][3], float b[3][3], float r[3][3])
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		r[i][0] = a[i][0] * b[0][0] + a[i][1] * b[1][0] + a[i][2] * b[2][0];
+		r[i][1] = a[i][0] * b[0][1] + a[i][1] * b[1][1] + a[i][2] * b[2][1];
+		r[i][2] = a[i][0] * b[0][2] + a[i][1] * b[1][2] + a[i][2] * b[2][2];
+	}
+}
+
+// r = a * transpose(b)
+static void multiply_transposed(float a[3][3], float b[3][3], float r[3][3])
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		r[i][0] = a[i][0] * b[0][0] + a[i][1] * b[0][1] + a[i][2] * b[0][2];
+		r[i][1] = a[i][0] * b[1][0] + a[i][1] * b[1][1] + a[i][2] * b[1][2];
+		r[i][2] = a[i][0] * b[2][0] + a[i][1] * b[2][1] + a[i][2] * b[2][2];
+	}
+}
+
+// r = transpose(a) * b
+static void transposed_multiply(float a[3][3], float b[3][3], float r[3][3])
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		r[i][0] = a[0][i] * b[0][0] + a[1][i] * b[1][0] + a[2][i] * b[2][0];
+		r[i][1] = a[0][i] * b[0][1] + a[1][i] * b[1][1] + a[2][i] * b[2][1];
+		r[i][2] = a[0][i] * b[0][2] + a[1][i] * b[1][2] + a[2][i] * b[2][2];
+	}
+}
+
+// r = skew symmetric (cross product) matrix of v
+static void skew(const float v[3], float r[3][3])
+{
+	r[0][0] = 0;     r[0][1] = -v[2]; r[0][2] = v[1];
+	r[1][0] = v[2];  r[1][1] = 0;     r[1][2] = -v[0];
+	r[2][0] = -v[1]; r[2][1] = v[0];  r[2][2] = 0;
+}
+
+// Inverse of symmetric matrix, returns 0 if singular.
+static uint8_t invert_symmetric(float a[3][3], float r[3][3])
+{
+	float c00 = a[1][1] * a[2][2] - a[1][2] * a[1][2];
+	float c01 = a[0][2] * a[1][2] - a[0][1] * a[2][2];
+	float c02 = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+	float determinant = a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02;
+
+	if (determinant == 0.0f) {
+		return 0;
+	}
+
+	float inverse = 1.0f / determinant;
+	r[0][0] = c00 * inverse;
+	r[0][1] = r[1][0] = c01 * inverse;
+	r[0][2] = r[2][0] = c02 * inverse;
+	r[1][1] = (a[0][0] * a[2][2] - a[0][2] * a[0][2]) * inverse;
+	r[1][2] = r[2][1] = (a[0][2] * a[0][1] - a[0][0] * a[1][2]) * inverse;
+	r[2][2] = (a[0][0] * a[1][1] - a[0][1] * a[0][1]) * inverse;
+
+	return 1;
+}
+
+static void symmetrize(float a[3][3])
+{
+	a[0][1] = a[1][0] = (a[0][1] + a[1][0]) * 0.5f;
+	a[0][2] = a[2][0] = (a[0][2] + a[2][0]) * 0.5f;
+	a[1][2] = a[2][1] = (a[1][2] + a[2][1]) * 0.5f;
+}
+
+/*******************************************************************************
+ * Quaternion helpers
+ ******************************************************************************/
+
+// q = q * [w, v]
+static void quaternion_multiply(float q[4], float w, const float v[3])
+{
+	float r0 = q[0] * w - q[1] * v[0] - q[2] * v[1] - q[3] * v[2];
+	float r1 = q[0] * v[0] + q[1] * w + q[2] * v[2] - q[3] * v[1];
+	float r2 = q[0] * v[1] - q[1] * v[2] + q[2] * w + q[3] * v[0];
+	float r3 = q[0] * v[2] + q[1] * v[1] - q[2] * v[0] + q[3] * w;
+
+	float norm = 1.0f / sqrtf(r0 * r0 + r1 * r1 + r2 * r2 + r3 * r3);
+	q[0] = r0 * norm;
+	q[1] = r1 * norm;
+	q[2] = r2 * norm;
+	q[3] = r3 * norm;
+}
+
+// r = transpose(R(q)) * v (world to body)
+static void rotate_to_body(const float q[4], const float v[3], float r[3])
+{
+	float w = q[0], x = q[1], y = q[2], z = q[3];
+
+	r[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y + w * z) * v[1] + 2 * (x * z - w * y) * v[2];
+	r[1] = 2 * (x * y - w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z + w * x) * v[2];
+	r[2] = 2 * (x * z + w * y) * v[0] + 2 * (y * z - w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+// r = R(q) * v (body to world)
+static void rotate_to_world(const float q[4], const float v[3], float r[3])
+{
+	float w = q[0], x = q[1], y = q[2], z = q[3];
+
+	r[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y - w * z) * v[1] + 2 * (x * z + w * y) * v[2];
+	r[1] = 2 * (x * y + w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z - w * x) * v[2];
+	r[2] = 2 * (x * z - w * y) * v[0] + 2 * (y * z + w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+/*******************************************************************************
+ * Filter
+ ******************************************************************************/
+
+/**
+ * @brief Initialize EKF AHRS state.
+ * 
+ * Attitude is set to identity, it is aligned with first sample by
+ * ``mpu925x_ekf_ahrs_update``.
+ * @param ekf EKF AHRS struct pointer.
+ * */
+void mpu925x_ekf_ahrs_init(mpu925x_ekf_ahrs *ekf)
+{
+	ekf->quaternion[0] = 1;
+	for (uint8_t i = 0; i < 3; i++) {
+		ekf->quaternion[i + 1] = 0;
+		ekf->gyroscope_bias[i] = 0;
+		ekf->magnetic_reference[i] = 0;
+		for (uint8_t j = 0; j < 3; j++) {
+			ekf->covariance_attitude[i][j] = 0;
+			ekf->covariance_cross[i][j] = 0;
+			ekf->covariance_bias[i][j] = 0;
+		}
+		ekf->covariance_attitude[i][i] = INITIAL_ATTITUDE_SIGMA * INITIAL_ATTITUDE_SIGMA;
+		ekf->covariance_bias[i][i] = INITIAL_BIAS_SIGMA * INITIAL_BIAS_SIGMA;
+	}
+	ekf->timestamp = 0;
+	ekf->initialized = 0;
+}
+
+/**
+ * @brief Align attitude with gravity and set magnetic reference.
+ * 
+ * Roll and pitch are taken from acceleration, yaw is set to 0, so world x axis
+ * is initial heading. If magnetic field is given, its world frame direction
+ * is stored as reference of magnetometer updates.
+ * @param ekf EKF AHRS struct pointer.
+ * @param acceleration Acceleration in g.
+ * @param magnetic_field Magnetic field in any unit (in accelerometer axes), or
+ * NULL.
+ * */
+void mpu925x_ekf_ahrs_align(mpu925x_ekf_ahrs *ekf, float *acceleration, float *magnetic_field)
+{
+	float roll = atan2f(acceleration[1], acceleration[2]);
+	float pitch = atan2f(-acceleration[0], sqrtf(acceleration[1] * acceleration[1] + acceleration[2] * acceleration[2]));
+	float cr = cosf(roll / 2), sr = sinf(roll / 2), cp = cosf(pitch / 2), sp = sinf(pitch / 2);
+
+	ekf->quaternion[0] = cr * cp;
+	ekf->quaternion[1] = sr * cp;
+	ekf->quaternion[2] = cr * sp;
+	ekf->quaternion[3] = -sr * sp;
+
+	if (magnetic_field != NULL) {
+		float norm = sqrtf(magnetic_field[0] * magnetic_field[0] + magnetic_field[1] * magnetic_field[1] + magnetic_field[2] * magnetic_field[2]);
+		if (norm > 0) {
+			float direction[3] = {magnetic_field[0] / norm, magnetic_field[1] / norm, magnetic_field[2] / norm};
+			rotate_to_world(ekf->quaternion, direction, ekf->magnetic_reference);
+		}
+	}
+
+	ekf->initialized = 1;
+}
+
+/**
+ * @brief Propagate state and covariance with gyroscope measurement.
+ * @param ekf EKF AHRS struct pointer.
+ * @param rotation Measured angular rate in rad/s.
+ * @param dt Time step in seconds.
+ * */
+void mpu925x_ekf_ahrs_predict(mpu925x_ekf_ahrs *ekf, float *rotation, float dt)
+{
+	float angle[3], phi[3][3], temporary[3][3], phi_b[3][3];
+	float (*a)[3] = ekf->covariance_attitude;
+	float (*b)[3] = ekf->covariance_cross;
+	float (*c)[3] = ekf->covariance_bias;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		angle[i] = (rotation[i] - ekf->gyroscope_bias[i]) * dt;
+	}
+
+	// Nominal attitude.
+	float magnitude = sqrtf(angle[0] * angle[0] + angle[1] * angle[1] + angle[2] * angle[2]);
+	float half_sin = magnitude > 1e-9f ? sinf(magnitude / 2) / magnitude : 0.5f;
+	float half_angle[3] = {angle[0] * half_sin, angle[1] * half_sin, angle[2] * half_sin};
+	quaternion_multiply(ekf->quaternion, cosf(magnitude / 2), half_angle);
+
+	// Error transition, phi = I - [angle]x.
+	skew(angle, phi);
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			phi[i][j] = -phi[i][j];
+		}
+		phi[i][i] = 1;
+	}
+
+	// Covariance blocks of F * P * F' + Q with F = [phi, -dt * I; 0, I].
+	multiply(phi, b, phi_b);
+	multiply(phi, a, temporary);
+	multiply_transposed(temporary, phi, a);
+
+	float attitude_noise = ekf->gyroscope_noise * ekf->gyroscope_noise * dt;
+	float bias_noise = ekf->gyroscope_bias_noise * ekf->gyroscope_bias_noise * dt;
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			a[i][j] += -dt * (phi_b[i][j] + phi_b[j][i]) + dt * dt * c[i][j];
+			b[i][j] = phi_b[i][j] - dt * c[i][j];
+		}
+		a[i][i] += attitude_noise;
+		c[i][i] += bias_noise;
+	}
+	symmetrize(a);
+}
+
+/**
+ * @brief Correct state with a unit vector measurement.
+ * @param ekf EKF AHRS struct pointer.
+ * @param predicted Predicted measurement in body frame.
+ * @param measured Measured unit vector in body frame.
+ * @param variance Measurement noise variance.
+ * */
+static void correct(mpu925x_ekf_ahrs *ekf, const float predicted[3], const float measured[3], float variance)
+{
+	float h[3][3], ha[3][3], hb[3][3], s[3][3], s_inverse[3][3], gain_attitude[3][3], gain_bias[3][3], temporary[3][3];
+	float residual[3], error_attitude[3], error_bias[3];
+	float (*a)[3] = ekf->covariance_attitude;
+	float (*b)[3] = ekf->covariance_cross;
+	float (*c)[3] = ekf->covariance_bias;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		residual[i] = measured[i] - predicted[i];
+	}
+
+	// H = [[predicted]x, 0].
+	skew(predicted, h);
+	multiply(h, a, ha);
+	multiply(h, b, hb);
+	multiply_transposed(ha, h, s);
+	for (uint8_t i = 0; i < 3; i++) {
+		s[i][i] += variance;
+	}
+	if (!invert_symmetric(s, s_inverse)) {
+		return;
+	}
+
+	// K = P * H' * S^-1, P * H' blocks are transpose(H * A) and transpose(H * B).
+	transposed_multiply(ha, s_inverse, gain_attitude);
+	transposed_multiply(hb, s_inverse, gain_bias);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		error_attitude[i] = gain_attitude[i][0] * residual[0] + gain_attitude[i][1] * residual[1] + gain_attitude[i][2] * residual[2];
+		error_bias[i] = gain_bias[i][0] * residual[0] + gain_bias[i][1] * residual[1] + gain_bias[i][2] * residual[2];
+	}
+
+	// P = P - K * H * P.
+	multiply(gain_attitude, ha, temporary);
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			a[i][j] -= temporary[i][j];
+		}
+	}
+	multiply(gain_bias, hb, temporary);
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			c[i][j] -= temporary[i][j];
+		}
+	}
+	multiply(gain_attitude, hb, temporary);
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			b[i][j] -= temporary[i][j];
+		}
+	}
+	symmetrize(a);
+	symmetrize(c);
+
+	// Inject error state into nominal state.
+	float half_error[3] = {error_attitude[0] / 2, error_attitude[1] / 2, error_attitude[2] / 2};
+	quaternion_multiply(ekf->quaternion, 1, half_error);
+	for (uint8_t i = 0; i < 3; i++) {
+		ekf->gyroscope_bias[i] += error_bias[i];
+	}
+}
+
+/**
+ * @brief Correct attitude and gyroscope bias with accelerometer measurement.
+ * 
+ * Measurement noise is inflated with acceleration norm error, so updates are
+ * weaker while platform accelerates.
+ * @param ekf EKF AHRS struct pointer.
+ * @param acceleration Acceleration in g.
+ * */
+void mpu925x_ekf_ahrs_correct_acceleration(mpu925x_ekf_ahrs *ekf, float *acceleration)
+{
+	const float up[3] = {0, 0, 1};
+	float predicted[3], measured[3];
+	float norm = sqrtf(acceleration[0] * acceleration[0] + acceleration[1] * acceleration[1] + acceleration[2] * acceleration[2]);
+
+	if (norm < 1e-3f) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		measured[i] = acceleration[i] / norm;
+	}
+	rotate_to_body(ekf->quaternion, up, predicted);
+
+	float deviation = ekf->acceleration_rejection * (norm - 1);
+	float variance = ekf->accelerometer_noise * ekf->accelerometer_noise + deviation * deviation;
+
+	correct(ekf, predicted, measured, variance);
+}
+
+/**
+ * @brief Correct attitude and gyroscope bias with magnetometer measurement.
+ * 
+ * Magnetic field must be in accelerometer axes (see
+ * ``mpu925x_set_mounting_matrix``). Does nothing if magnetic reference is not
+ * set by ``mpu925x_ekf_ahrs_align``.
+ * @param ekf EKF AHRS struct pointer.
+ * @param magnetic_field Magnetic field in any unit.
+ * */
+void mpu925x_ekf_ahrs_correct_magnetic_field(mpu925x_ekf_ahrs *ekf, float *magnetic_field)
+{
+	float predicted[3], measured[3];
+	float norm = sqrtf(magnetic_field[0] * magnetic_field[0] + magnetic_field[1] * magnetic_field[1] + magnetic_field[2] * magnetic_field[2]);
+	float *reference = ekf->magnetic_reference;
+
+	if (norm <= 0 || (reference[0] == 0 && reference[1] == 0 && reference[2] == 0)) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		measured[i] = magnetic_field[i] / norm;
+	}
+	rotate_to_body(ekf->quaternion, reference, predicted);
+
+	correct(ekf, predicted, measured, ekf->magnetometer_noise * ekf->magnetometer_noise);
+}
+
+/**
+ * @brief Update EKF AHRS with last read sensor data.
+ * 
+ * Uses acceleration, rotation, magnetic field and timestamp already stored in
+ * ``sensor_data``. First call aligns attitude. Time step is taken from
+ * timestamps, or ``sample_period`` if timestamps don't advance.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param ekf EKF AHRS struct pointer.
+ * */
+void mpu925x_ekf_ahrs_update(mpu925x_t *mpu925x, mpu925x_ekf_ahrs *ekf)
+{
+	float rotation[3];
+	uint8_t use_magnetometer = ekf->magnetometer_noise > 0;
+
+	if (!ekf->initialized) {
+		mpu925x_ekf_ahrs_align(ekf, mpu925x->sensor_data.acceleration, use_magnetometer ? mpu925x->sensor_data.magnetic_field : NULL);
+		ekf->timestamp = mpu925x->sensor_data.timestamp;
+		return;
+	}
+
+	float dt = ekf->sample_period;
+	if (mpu925x->sensor_data.timestamp > ekf->timestamp) {
+		dt = (mpu925x->sensor_data.timestamp - ekf->timestamp) * 1e-6f;
+	}
+	ekf->timestamp = mpu925x->sensor_data.timestamp;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		rotation[i] = mpu925x->sensor_data.rotation[i] * DEGREES_TO_RADIANS;
+	}
+
+	mpu925x_ekf_ahrs_predict(ekf, rotation, dt);
+	mpu925x_ekf_ahrs_correct_acceleration(ekf, mpu925x->sensor_data.acceleration);
+	if (use_magnetometer) {
+		mpu925x_ekf_ahrs_correct_magnetic_field(ekf, mpu925x->sensor_data.magnetic_field);
+	}
+}
+
+/**
+ * @brief Get attitude as Euler angles.
+ * @param ekf EKF AHRS struct pointer.
+ * @param roll Roll angle in degrees.
+ * @param pitch Pitch angle in degrees.
+ * @param yaw Yaw angle in degrees, relative to initial heading.
+ * */
+void mpu925x_ekf_ahrs_get_euler(mpu925x_ekf_ahrs *ekf, float *roll, float *pitch, float *yaw)
+{
+	float w = ekf->quaternion[0], x = ekf->quaternion[1], y = ekf->quaternion[2], z = ekf->quaternion[3];
+	float sine_pitch = 2 * (w * y - z * x);
+
+	if (sine_pitch > 1)
+		sine_pitch = 1;
+	if (sine_pitch < -1)
+		sine_pitch = -1;
+
+	*roll = atan2f(2 * (w * x + y * z), 1 - 2 * (x * x + y * y)) * RADIANS_TO_DEGREES;
+	*pitch = asinf(sine_pitch) * RADIANS_TO_DEGREES;
+	*yaw = atan2f(2 * (w * z + x * y), 1 - 2 * (y * y + z * z)) * RADIANS_TO_DEGREES;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Extended Kalman filter AHRS header file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_EKF_AHRS_H
+#define __MPU925X_EKF_AHRS_H
+
+#include "mpu925x.h"
+
+/**
+ * @brief Error-state extended Kalman filter AHRS.
+ * 
+ * Nominal state is attitude quaternion (body to world, world z axis up) and
+ * gyroscope bias. Error state is 3 attitude error angles and 3 gyroscope bias
+ * errors, so covariance is 6x6 and it is stored and processed as 3x3 blocks.
+ * No dynamic memory is used.
+ * 
+ * Configuration fields (noise densities) must be set by user before
+ * ``mpu925x_ekf_ahrs_init``:
+ * - ``gyroscope_noise``: gyroscope noise density in rad/s/sqrt(Hz).
+ * - ``gyroscope_bias_noise``: gyroscope bias random walk in rad/s^2/sqrt(Hz).
+ * - ``accelerometer_noise``: accelerometer noise in g.
+ * - ``acceleration_rejection``: accelerometer noise inflation per g of
+ *   acceleration norm error, so accelerometer is trusted less while platform
+ *   accelerates.
+ * - ``magnetometer_noise``: normalized magnetometer noise, 0 disables
+ *   magnetometer updates.
+ * - ``sample_period``: sample period in seconds, used when timestamps don't
+ *   advance (``get_time_us`` isn't provided).
+ * */
+typedef struct mpu925x_ekf_ahrs {
+	// Configuration
+	float gyroscope_noise;
+	float gyroscope_bias_noise;
+	float accelerometer_noise;
+	float acceleration_rejection;
+	float magnetometer_noise;
+	float sample_period;
+
+	// State
+	float quaternion[4];
+	float gyroscope_bias[3];
+	float covariance_attitude[3][3];
+	float covariance_cross[3][3];
+	float covariance_bias[3][3];
+	float magnetic_reference[3];
+	uint64_t timestamp;
+	uint8_t initialized;
+} mpu925x_ekf_ahrs;
+
+void mpu925x_ekf_ahrs_init(mpu925x_ekf_ahrs *ekf);
+void mpu925x_ekf_ahrs_update(mpu925x_t *mpu925x, mpu925x_ekf_ahrs *ekf);
+void mpu925x_ekf_ahrs_align(mpu925x_ekf_ahrs *ekf, float *acceleration, float *magnetic_field);
+void mpu925x_ekf_ahrs_predict(mpu925x_ekf_ahrs *ekf, float *rotation, float dt);
+void mpu925x_ekf_ahrs_correct_acceleration(mpu925x_ekf_ahrs *ekf, float *acceleration);
+void mpu925x_ekf_ahrs_correct_magnetic_field(mpu925x_ekf_ahrs *ekf, float *magnetic_field);
+void mpu925x_ekf_ahrs_get_euler(mpu925x_ekf_ahrs *ekf, float *roll, float *pitch, float *yaw);
+
+#endif // __MPU925X_EKF_AHRS_H
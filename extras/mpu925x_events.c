@@ -0,0 +1,228 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Motion event detection source file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_events.h"
+#include <math.h>
+#include <string.h>
+
+// Time constants of gravity tracking and step smoothing in seconds.
+#define GRAVITY_TIME_CONSTANT 0.5f
+#define STEP_TIME_CONSTANT    0.02f
+
+// Samples since an event which didn't happen yet.
+#define NEVER                 UINT32_MAX
+
+enum tap_state {
+	TAP_IDLE = 0,
+	TAP_PULSE,
+	TAP_TOO_LONG,
+	TAP_LATENCY
+};
+
+// Convert milliseconds to samples, at least 1.
+static uint32_t to_samples(mpu925x_events *events, uint16_t time)
+{
+	uint32_t samples = time * events->sample_rate / 1000 + 0.5f;
+
+	return samples > 0 ? samples : 1;
+}
+
+/**
+ * @brief Initialize event detector from its configuration.
+ * @param events Events struct pointer.
+ * */
+void mpu925x_events_init(mpu925x_events *events)
+{
+	events->gravity_gain = 1 / (1 + GRAVITY_TIME_CONSTANT * events->sample_rate);
+	events->step_gain = 1 / (1 + STEP_TIME_CONSTANT * events->sample_rate);
+	events->tap_samples = to_samples(events, events->tap_duration);
+	events->tap_latency_samples = to_samples(events, events->tap_latency);
+	events->double_tap_samples = to_samples(events, events->double_tap_window);
+	events->free_fall_samples = to_samples(events, events->free_fall_time);
+	events->shock_samples = to_samples(events, events->shock_holdoff);
+	events->inactivity_samples = to_samples(events, events->inactivity_time);
+	events->step_samples = to_samples(events, events->step_interval);
+
+	events->tap_state = TAP_IDLE;
+	events->tap_length = 0;
+	events->tap_quiet = 0;
+	events->since_tap = NEVER;
+	events->free_fall_length = 0;
+	events->shock_quiet = 0;
+	events->still_length = 0;
+	events->since_step = NEVER;
+	events->steps = 0;
+	events->step_armed = 0;
+	events->inactive = 0;
+	events->initialized = 0;
+}
+
+// Tap and double tap state machine.
+static uint8_t update_tap(mpu925x_events *events, float dynamic)
+{
+	uint8_t flags = 0;
+
+	if (events->since_tap != NEVER)
+		events->since_tap++;
+
+	switch (events->tap_state) {
+		case TAP_IDLE:
+			if (dynamic >= events->tap_threshold) {
+				events->tap_state = TAP_PULSE;
+				events->tap_length = 1;
+			}
+			break;
+		case TAP_PULSE:
+			if (dynamic >= events->tap_threshold) {
+				if (++events->tap_length > events->tap_samples)
+					events->tap_state = TAP_TOO_LONG;
+				break;
+			}
+			flags |= MPU925X_EVENT_TAP;
+			// Third tap starts a new pair.
+			if (events->since_tap <= events->double_tap_samples) {
+				flags |= MPU925X_EVENT_DOUBLE_TAP;
+				events->since_tap = NEVER;
+			}
+			else {
+				events->since_tap = 0;
+			}
+			events->tap_state = TAP_LATENCY;
+			events->tap_quiet = events->tap_latency_samples;
+			break;
+		case TAP_TOO_LONG:
+			if (dynamic < events->tap_threshold)
+				events->tap_state = TAP_IDLE;
+			break;
+		case TAP_LATENCY:
+			if (--events->tap_quiet == 0)
+				events->tap_state = TAP_IDLE;
+			break;
+	}
+
+	return flags;
+}
+
+/**
+ * @brief Process a sample.
+ * @param events Events struct pointer.
+ * @param acceleration Acceleration in g's.
+ * @returns ``MPU925X_EVENT_*`` flags of events detected at this sample.
+ * */
+uint8_t mpu925x_events_update(mpu925x_events *events, const float *acceleration)
+{
+	float norm = sqrtf(acceleration[0] * acceleration[0] + acceleration[1] * acceleration[1] + acceleration[2] * acceleration[2]);
+	float dynamic = 0;
+	uint8_t moved = 0;
+	uint8_t flags = 0;
+
+	if (!events->initialized) {
+		memcpy(events->gravity, acceleration, sizeof(events->gravity));
+		memcpy(events->reference, acceleration, sizeof(events->reference));
+		events->smoothed_norm = norm;
+		events->initialized = 1;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		float difference = acceleration[i] - events->gravity[i];
+		dynamic += difference * difference;
+		events->gravity[i] += difference * events->gravity_gain;
+		moved |= fabsf(acceleration[i] - events->reference[i]) > events->inactivity_threshold;
+	}
+
+	if (events->tap_threshold > 0)
+		flags |= update_tap(events, sqrtf(dynamic));
+
+	if (events->free_fall_threshold > 0) {
+		if (norm >= events->free_fall_threshold)
+			events->free_fall_length = 0;
+		else if (events->free_fall_length < events->free_fall_samples && ++events->free_fall_length == events->free_fall_samples)
+			flags |= MPU925X_EVENT_FREE_FALL;
+	}
+
+	if (events->shock_threshold > 0) {
+		if (events->shock_quiet > 0) {
+			events->shock_quiet--;
+		}
+		else if (norm >= events->shock_threshold) {
+			flags |= MPU925X_EVENT_SHOCK;
+			events->shock_quiet = events->shock_samples;
+		}
+	}
+
+	if (events->inactivity_threshold > 0) {
+		if (moved) {
+			memcpy(events->reference, acceleration, sizeof(events->reference));
+			events->still_length = 0;
+			if (events->inactive)
+				flags |= MPU925X_EVENT_ACTIVITY;
+			events->inactive = 0;
+		}
+		else if (!events->inactive && ++events->still_length >= events->inactivity_samples) {
+			flags |= MPU925X_EVENT_INACTIVITY;
+			events->inactive = 1;
+		}
+	}
+
+	if (events->step_threshold > 0) {
+		events->smoothed_norm += (norm - events->smoothed_norm) * events->step_gain;
+		if (events->since_step != NEVER)
+			events->since_step++;
+
+		// A step is a rise above threshold after norm fell below 1 g.
+		if (events->smoothed_norm < 1) {
+			events->step_armed = 1;
+		}
+		else if (events->step_armed && events->smoothed_norm > 1 + events->step_threshold) {
+			events->step_armed = 0;
+			if (events->since_step >= events->step_samples) {
+				flags |= MPU925X_EVENT_STEP;
+				events->steps++;
+				events->since_step = 0;
+			}
+		}
+	}
+
+	return flags;
+}
+
+/**
+ * @brief Process a block of samples.
+ * @param events Events struct pointer.
+ * @param acceleration Acceleration samples in g's.
+ * @param count Sample count.
+ * @returns ``MPU925X_EVENT_*`` flags of events detected in block.
+ * */
+uint8_t mpu925x_events_process(mpu925x_events *events, float (*acceleration)[3], uint16_t count)
+{
+	uint8_t flags = 0;
+
+	for (uint16_t n = 0; n < count; n++) {
+		flags |= mpu925x_events_update(events, acceleration[n]);
+	}
+
+	return flags;
+}
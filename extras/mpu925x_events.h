@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Motion event detection header file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_EVENTS_H
+#define __MPU925X_EVENTS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Event flags returned by ``mpu925x_events_update``.
+ * */
+#define MPU925X_EVENT_TAP        0x01
+#define MPU925X_EVENT_DOUBLE_TAP 0x02
+#define MPU925X_EVENT_FREE_FALL  0x04
+#define MPU925X_EVENT_SHOCK      0x08
+#define MPU925X_EVENT_INACTIVITY 0x10
+#define MPU925X_EVENT_ACTIVITY   0x20
+#define MPU925X_EVENT_STEP       0x40
+
+/**
+ * @brief Incremental motion event detector.
+ * 
+ * Every sample is processed in constant time and memory. Thresholds are in
+ * g's and times are in milliseconds, a zero threshold disables its event:
+ * - Tap: dynamic acceleration (acceleration minus slowly tracked gravity)
+ *   exceeds ``tap_threshold`` for at most ``tap_duration``. Following
+ *   ``tap_latency`` is ignored, a second tap within ``double_tap_window`` of
+ *   the first one is also a double tap.
+ * - Free-fall: acceleration norm stays below ``free_fall_threshold`` for
+ *   ``free_fall_time``.
+ * - Shock: acceleration norm exceeds ``shock_threshold``, then shocks are
+ *   ignored for ``shock_holdoff``.
+ * - Inactivity: no axis moves more than ``inactivity_threshold`` from a
+ *   reference sample for ``inactivity_time``. Activity is reported when it
+ *   moves again.
+ * - Step: smoothed acceleration norm rises ``step_threshold`` above 1 g, at
+ *   least ``step_interval`` after previous step.
+ * 
+ * Configuration fields must be set before ``mpu925x_events_init``.
+ * */
+typedef struct mpu925x_events {
+	// Configuration
+	float sample_rate;
+	float tap_threshold;
+	uint16_t tap_duration, tap_latency, double_tap_window;
+	float free_fall_threshold;
+	uint16_t free_fall_time;
+	float shock_threshold;
+	uint16_t shock_holdoff;
+	float inactivity_threshold;
+	uint16_t inactivity_time;
+	float step_threshold;
+	uint16_t step_interval;
+
+	// Derived from configuration
+	float gravity_gain, step_gain;
+	uint32_t tap_samples, tap_latency_samples, double_tap_samples;
+	uint32_t free_fall_samples, shock_samples;
+	uint32_t inactivity_samples, step_samples;
+
+	// State
+	float gravity[3];
+	float reference[3];
+	float smoothed_norm;
+	uint32_t tap_length, tap_quiet, since_tap;
+	uint32_t free_fall_length, shock_quiet;
+	uint32_t still_length, since_step;
+	uint32_t steps;
+	uint8_t tap_state;
+	uint8_t step_armed;
+	uint8_t inactive;
+	uint8_t initialized;
+} mpu925x_events;
+
+void mpu925x_events_init(mpu925x_events *events);
+uint8_t mpu925x_events_update(mpu925x_events *events, const float *acceleration);
+uint8_t mpu925x_events_process(mpu925x_events *events, float (*acceleration)[3], uint16_t count);
+
+#endif // __MPU925X_EVENTS_H
@@ -0,0 +1,281 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Digital filter bank source file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_filter.h"
+#include <math.h>
+#include <string.h>
+
+#define PI 3.14159265358979f
+
+/*******************************************************************************
+ * Coefficient design
+ ******************************************************************************/
+
+// Normalize by a0 and store.
+static void normalize(mpu925x_biquad *biquad, float b0, float b1, float b2, float a0, float a1, float a2)
+{
+	biquad->b0 = b0 / a0;
+	biquad->b1 = b1 / a0;
+	biquad->b2 = b2 / a0;
+	biquad->a1 = a1 / a0;
+	biquad->a2 = a2 / a0;
+}
+
+/**
+ * @brief Design second order low pass section.
+ * @param biquad Biquad struct pointer.
+ * @param sample_rate Sample rate in Hz.
+ * @param cutoff Cutoff frequency in Hz.
+ * @param q Quality factor, 0.7071 for Butterworth response.
+ * */
+void mpu925x_biquad_lowpass(mpu925x_biquad *biquad, float sample_rate, float cutoff, float q)
+{
+	float w0 = 2 * PI * cutoff / sample_rate;
+	float cosine = cosf(w0), alpha = sinf(w0) / (2 * q);
+
+	normalize(biquad, (1 - cosine) / 2, 1 - cosine, (1 - cosine) / 2, 1 + alpha, -2 * cosine, 1 - alpha);
+}
+
+/**
+ * @brief Design second order high pass section.
+ * @param biquad Biquad struct pointer.
+ * @param sample_rate Sample rate in Hz.
+ * @param cutoff Cutoff frequency in Hz.
+ * @param q Quality factor, 0.7071 for Butterworth response.
+ * */
+void mpu925x_biquad_highpass(mpu925x_biquad *biquad, float sample_rate, float cutoff, float q)
+{
+	float w0 = 2 * PI * cutoff / sample_rate;
+	float cosine = cosf(w0), alpha = sinf(w0) / (2 * q);
+
+	normalize(biquad, (1 + cosine) / 2, -(1 + cosine), (1 + cosine) / 2, 1 + alpha, -2 * cosine, 1 - alpha);
+}
+
+/**
+ * @brief Design notch section.
+ * @param biquad Biquad struct pointer.
+ * @param sample_rate Sample rate in Hz.
+ * @param frequency Rejected frequency in Hz.
+ * @param bandwidth -3 dB bandwidth in Hz.
+ * */
+void mpu925x_biquad_notch(mpu925x_biquad *biquad, float sample_rate, float frequency, float bandwidth)
+{
+	float w0 = 2 * PI * frequency / sample_rate;
+	float cosine = cosf(w0), alpha = sinf(w0) * bandwidth / (2 * frequency);
+
+	normalize(biquad, 1, -2 * cosine, 1, 1 + alpha, -2 * cosine, 1 - alpha);
+}
+
+/**
+ * @brief Design Hamming windowed sinc low pass FIR filter with unity DC gain.
+ * @param taps Tap array.
+ * @param tap_count Tap count.
+ * @param cutoff Cutoff frequency relative to sample rate, from 0 to 0.5.
+ * */
+void mpu925x_fir_lowpass(float *taps, uint8_t tap_count, float cutoff)
+{
+	float center = (tap_count - 1) / 2.0f, sum = 0;
+
+	for (uint8_t i = 0; i < tap_count; i++) {
+		float t = i - center;
+		float sinc = t == 0 ? 2 * cutoff : sinf(2 * PI * cutoff * t) / (PI * t);
+		float window = tap_count > 1 ? 0.54f - 0.46f * cosf(2 * PI * i / (tap_count - 1)) : 1;
+		taps[i] = sinc * window;
+		sum += taps[i];
+	}
+
+	for (uint8_t i = 0; i < tap_count; i++) {
+		taps[i] /= sum;
+	}
+}
+
+/*******************************************************************************
+ * Biquad cascade
+ ******************************************************************************/
+
+/**
+ * @brief Initialize an empty filter cascade.
+ * @param filter Filter struct pointer.
+ * */
+void mpu925x_filter_init(mpu925x_filter *filter)
+{
+	filter->section_count = 0;
+	mpu925x_filter_reset(filter);
+}
+
+/**
+ * @brief Append a section to filter cascade.
+ * @param filter Filter struct pointer.
+ * @param biquad Section coefficients.
+ * @returns 0 on success, 1 if cascade is full.
+ * */
+uint8_t mpu925x_filter_add(mpu925x_filter *filter, const mpu925x_biquad *biquad)
+{
+	if (filter->section_count >= MPU925X_FILTER_MAX_SECTIONS)
+		return 1;
+
+	filter->sections[filter->section_count++] = *biquad;
+
+	return 0;
+}
+
+/**
+ * @brief Append an even order Butterworth low pass filter to cascade.
+ * @param filter Filter struct pointer.
+ * @param order Filter order, must be even.
+ * @param sample_rate Sample rate in Hz.
+ * @param cutoff Cutoff frequency in Hz.
+ * @returns 0 on success, 1 if order is odd or cascade doesn't have room.
+ * */
+uint8_t mpu925x_filter_add_butterworth_lowpass(mpu925x_filter *filter, uint8_t order, float sample_rate, float cutoff)
+{
+	mpu925x_biquad biquad;
+
+	if (order == 0 || order & 1 || filter->section_count + order / 2 > MPU925X_FILTER_MAX_SECTIONS)
+		return 1;
+
+	// Each section realizes a conjugate pole pair.
+	for (uint8_t k = 0; k < order / 2; k++) {
+		float q = 1 / (2 * cosf(PI * (2 * k + 1) / (2 * order)));
+		mpu925x_biquad_lowpass(&biquad, sample_rate, cutoff, q);
+		mpu925x_filter_add(filter, &biquad);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Clear filter state, coefficients are kept.
+ * @param filter Filter struct pointer.
+ * */
+void mpu925x_filter_reset(mpu925x_filter *filter)
+{
+	memset(filter->state, 0, sizeof(filter->state));
+}
+
+/**
+ * @brief Filter a block of three axis samples in place.
+ * 
+ * Block is passed through one section at a time in transposed direct form II,
+ * so coefficients and state stay in registers and the axis loop can be
+ * vectorized by compiler.
+ * @param filter Filter struct pointer.
+ * @param samples Samples, modified in place.
+ * @param count Sample count.
+ * */
+void mpu925x_filter_process(mpu925x_filter *filter, float (*samples)[3], uint16_t count)
+{
+	for (uint8_t s = 0; s < filter->section_count; s++) {
+		const mpu925x_biquad biquad = filter->sections[s];
+		float z1[3], z2[3];
+
+		memcpy(z1, filter->state[s][0], sizeof(z1));
+		memcpy(z2, filter->state[s][1], sizeof(z2));
+
+		for (uint16_t n = 0; n < count; n++) {
+			for (uint8_t i = 0; i < 3; i++) {
+				float x = samples[n][i];
+				float y = biquad.b0 * x + z1[i];
+				z1[i] = biquad.b1 * x - biquad.a1 * y + z2[i];
+				z2[i] = biquad.b2 * x - biquad.a2 * y;
+				samples[n][i] = y;
+			}
+		}
+
+		memcpy(filter->state[s][0], z1, sizeof(z1));
+		memcpy(filter->state[s][1], z2, sizeof(z2));
+	}
+}
+
+/*******************************************************************************
+ * Decimator
+ ******************************************************************************/
+
+/**
+ * @brief Initialize decimator with given taps.
+ * @param decimator Decimator struct pointer.
+ * @param factor Decimation factor.
+ * @param taps Tap array, see ``mpu925x_fir_lowpass``.
+ * @param tap_count Tap count, at most ``MPU925X_DECIMATOR_MAX_TAPS``.
+ * @returns 0 on success, 1 if factor or tap count is invalid.
+ * */
+uint8_t mpu925x_decimator_init(mpu925x_decimator *decimator, uint8_t factor, const float *taps, uint8_t tap_count)
+{
+	if (factor == 0 || tap_count == 0 || tap_count > MPU925X_DECIMATOR_MAX_TAPS)
+		return 1;
+
+	memcpy(decimator->taps, taps, tap_count * sizeof(float));
+	decimator->tap_count = tap_count;
+	decimator->factor = factor;
+	decimator->phase = 0;
+	decimator->position = 0;
+	memset(decimator->delay, 0, sizeof(decimator->delay));
+
+	return 0;
+}
+
+/**
+ * @brief Filter and decimate a block of three axis samples.
+ * 
+ * Output may be the same array as input. Phase is kept between calls, so
+ * block size doesn't need to be a multiple of decimation factor.
+ * @param decimator Decimator struct pointer.
+ * @param input Input samples.
+ * @param count Input sample count.
+ * @param output Output samples, needs room for ``count / factor + 1``
+ * samples.
+ * @returns Output sample count.
+ * */
+uint16_t mpu925x_decimator_process(mpu925x_decimator *decimator, float (*input)[3], uint16_t count, float (*output)[3])
+{
+	const uint8_t tap_count = decimator->tap_count;
+	uint16_t produced = 0;
+
+	for (uint16_t n = 0; n < count; n++) {
+		// Newest sample is at position, older samples follow it.
+		uint8_t position = decimator->position == 0 ? tap_count - 1 : decimator->position - 1;
+		for (uint8_t i = 0; i < 3; i++) {
+			decimator->delay[position][i] = input[n][i];
+			decimator->delay[position + tap_count][i] = input[n][i];
+		}
+		decimator->position = position;
+
+		if (++decimator->phase < decimator->factor)
+			continue;
+		decimator->phase = 0;
+
+		float sum[3] = {0, 0, 0};
+		float (*delay)[3] = &decimator->delay[position];
+		for (uint8_t k = 0; k < tap_count; k++) {
+			for (uint8_t i = 0; i < 3; i++) {
+				sum[i] += decimator->taps[k] * delay[k][i];
+			}
+		}
+		memcpy(output[produced++], sum, sizeof(sum));
+	}
+
+	return produced;
+}
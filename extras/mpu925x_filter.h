@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Digital filter bank header file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_FILTER_H
+#define __MPU925X_FILTER_H
+
+#include <stdint.h>
+
+#define MPU925X_FILTER_MAX_SECTIONS 8
+#define MPU925X_DECIMATOR_MAX_TAPS  64
+
+/**
+ * @brief Normalized biquad coefficients (a0 is 1).
+ * */
+typedef struct mpu925x_biquad {
+	float b0, b1, b2, a1, a2;
+} mpu925x_biquad;
+
+/**
+ * @brief Cascade of biquad sections for three axes.
+ * 
+ * Sections are applied in order. Each axis has its own state, coefficients
+ * are shared. State is kept between calls, so a stream can be processed in
+ * blocks of any size.
+ * */
+typedef struct mpu925x_filter {
+	mpu925x_biquad sections[MPU925X_FILTER_MAX_SECTIONS];
+	uint8_t section_count;
+	float state[MPU925X_FILTER_MAX_SECTIONS][2][3];
+} mpu925x_filter;
+
+/**
+ * @brief Polyphase FIR decimator for three axes.
+ * 
+ * Only every ``factor``'th output is computed, so cost per input sample is
+ * ``tap_count / factor`` multiply-adds per axis. Delay line is stored twice
+ * so every output is a single contiguous dot product.
+ * */
+typedef struct mpu925x_decimator {
+	float taps[MPU925X_DECIMATOR_MAX_TAPS];
+	uint8_t tap_count;
+	uint8_t factor;
+	uint8_t phase;
+	uint8_t position;
+	float delay[2 * MPU925X_DECIMATOR_MAX_TAPS][3];
+} mpu925x_decimator;
+
+// Coefficient design
+void mpu925x_biquad_lowpass(mpu925x_biquad *biquad, float sample_rate, float cutoff, float q);
+void mpu925x_biquad_highpass(mpu925x_biquad *biquad, float sample_rate, float cutoff, float q);
+void mpu925x_biquad_notch(mpu925x_biquad *biquad, float sample_rate, float frequency, float bandwidth);
+void mpu925x_fir_lowpass(float *taps, uint8_t tap_count, float cutoff);
+
+// Biquad cascade
+void mpu925x_filter_init(mpu925x_filter *filter);
+uint8_t mpu925x_filter_add(mpu925x_filter *filter, const mpu925x_biquad *biquad);
+uint8_t mpu925x_filter_add_butterworth_lowpass(mpu925x_filter *filter, uint8_t order, float sample_rate, float cutoff);
+void mpu925x_filter_reset(mpu925x_filter *filter);
+void mpu925x_filter_process(mpu925x_filter *filter, float (*samples)[3], uint16_t count);
+
+// Decimator
+uint8_t mpu925x_decimator_init(mpu925x_decimator *decimator, uint8_t factor, const float *taps, uint8_t tap_count);
+uint16_t mpu925x_decimator_process(mpu925x_decimator *decimator, float (*input)[3], uint16_t count, float (*output)[3]);
+
+#endif // __MPU925X_FILTER_H
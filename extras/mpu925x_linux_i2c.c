@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Linux I2C transport source file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "mpu925x_linux_i2c.h"
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Bus read interface.
+ * */
+static uint8_t linux_i2c_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	mpu925x_linux_i2c *transport = mpu925x->master_specific.bus_handle;
+	struct i2c_msg messages[2] = {
+		{.addr = slave_address, .flags = 0, .len = 1, .buf = &reg},
+		{.addr = slave_address, .flags = I2C_M_RD, .len = size, .buf = buffer}
+	};
+	struct i2c_rdwr_ioctl_data data = {.msgs = messages, .nmsgs = 2};
+
+	return ioctl(transport->descriptor, I2C_RDWR, &data) == 2 ? 0 : 1;
+}
+
+/**
+ * @brief Bus write interface.
+ * */
+static uint8_t linux_i2c_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	mpu925x_linux_i2c *transport = mpu925x->master_specific.bus_handle;
+	uint8_t message[256];
+	struct i2c_msg messages[1] = {
+		{.addr = slave_address, .flags = 0, .len = size + 1, .buf = message}
+	};
+	struct i2c_rdwr_ioctl_data data = {.msgs = messages, .nmsgs = 1};
+
+	message[0] = reg;
+	memcpy(&message[1], buffer, size);
+
+	return ioctl(transport->descriptor, I2C_RDWR, &data) == 1 ? 0 : 1;
+}
+
+/**
+ * @brief Delay interface.
+ * */
+static void linux_delay_ms(mpu925x_t *mpu925x, uint32_t delay)
+{
+	struct timespec time = {.tv_sec = delay / 1000, .tv_nsec = (delay % 1000) * 1000000L};
+
+	while (nanosleep(&time, &time) != 0) {
+	}
+}
+
+/**
+ * @brief Time interface, CLOCK_MONOTONIC in microseconds.
+ * */
+static uint64_t linux_get_time_us(mpu925x_t *mpu925x)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * @brief Open I2C device and attach transport to driver.
+ * 
+ * Sets bus, delay and time functions and bus handle of driver.
+ * @param transport Transport struct pointer.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param device I2C device path, such as "/dev/i2c-1".
+ * @returns 0 on success, 1 if device can't be opened.
+ * */
+uint8_t mpu925x_linux_i2c_open(mpu925x_linux_i2c *transport, mpu925x_t *mpu925x, const char *device)
+{
+	transport->descriptor = open(device, O_RDWR);
+	if (transport->descriptor < 0) {
+		return 1;
+	}
+
+	mpu925x->master_specific.bus_read = linux_i2c_read;
+	mpu925x->master_specific.bus_write = linux_i2c_write;
+	mpu925x->master_specific.delay_ms = linux_delay_ms;
+	mpu925x->master_specific.get_time_us = linux_get_time_us;
+	mpu925x->master_specific.bus_handle = transport;
+
+	return 0;
+}
+
+/**
+ * @brief Close I2C device.
+ * @param transport Transport struct pointer.
+ * */
+void mpu925x_linux_i2c_close(mpu925x_linux_i2c *transport)
+{
+	if (transport->descriptor >= 0) {
+		close(transport->descriptor);
+		transport->descriptor = -1;
+	}
+}
@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Linux I2C transport header file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_LINUX_I2C_H
+#define __MPU925X_LINUX_I2C_H
+
+#include "mpu925x.h"
+
+/**
+ * @brief Linux I2C transport (i2c-dev).
+ * 
+ * Every bus read and write is one combined I2C_RDWR transaction, so register
+ * address and data are never split by another bus master.
+ * */
+typedef struct mpu925x_linux_i2c {
+	int descriptor;
+} mpu925x_linux_i2c;
+
+uint8_t mpu925x_linux_i2c_open(mpu925x_linux_i2c *transport, mpu925x_t *mpu925x, const char *device);
+void mpu925x_linux_i2c_close(mpu925x_linux_i2c *transport);
+
+#endif // __MPU925X_LINUX_I2C_H
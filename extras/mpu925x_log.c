@@ -0,0 +1,508 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Binary sample log source file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "mpu925x_log.h"
+#include "mpu925x_internals.h"
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+// Record types
+#define LOG_RECORD_CONFIG          1
+#define LOG_RECORD_TIME            2
+#define LOG_RECORD_SAMPLE          3
+#define LOG_RECORD_RANGE           4
+
+// Payload sizes
+#define LOG_CONFIG_SIZE            (8 + 6 + 27 * 4)
+#define LOG_TIME_SIZE              8
+#define LOG_SAMPLE_SIZE            (4 + 10 * 2 + 1)
+#define LOG_RANGE_SIZE             2
+
+static const uint8_t log_magic[4] = {'M', '9', 'L', 'G'};
+
+/*******************************************************************************
+ * Little endian helpers
+ ******************************************************************************/
+
+static void put_uint(uint8_t *buffer, uint64_t value, uint8_t size)
+{
+	for (uint8_t i = 0; i < size; i++) {
+		buffer[i] = (uint8_t)(value >> (i * 8));
+	}
+}
+
+static uint64_t get_uint(const uint8_t *buffer, uint8_t size)
+{
+	uint64_t value = 0;
+
+	for (uint8_t i = 0; i < size; i++) {
+		value |= (uint64_t)buffer[i] << (i * 8);
+	}
+
+	return value;
+}
+
+/*******************************************************************************
+ * Recorder
+ ******************************************************************************/
+
+/**
+ * @brief Open log file for appending.
+ * 
+ * File header is written if file is empty.
+ * @param recorder Log recorder struct pointer.
+ * @param path Path of log file.
+ * @returns 0 on success, 1 on failure.
+ * */
+uint8_t mpu925x_log_open(mpu925x_log_recorder *recorder, const char *path)
+{
+	recorder->file = fopen(path, "ab");
+	if (recorder->file == NULL) {
+		return 1;
+	}
+
+	recorder->length = 0;
+	recorder->timestamp = 0;
+	recorder->failed = 0;
+	recorder->accelerometer_scale = mpu925x_2g;
+	recorder->gyroscope_scale = mpu925x_250dps;
+
+	// Writes are buffered by recorder itself.
+	setvbuf(recorder->file, NULL, _IONBF, 0);
+
+	fseek(recorder->file, 0, SEEK_END);
+	if (ftell(recorder->file) == 0) {
+		memcpy(recorder->buffer, log_magic, sizeof(log_magic));
+		recorder->buffer[4] = MPU925X_LOG_VERSION;
+		recorder->length = 5;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Reserve space for a record in write buffer.
+ * @param recorder Log recorder struct pointer.
+ * @param type Record type.
+ * @param size Payload size.
+ * @returns Pointer to payload.
+ * */
+static uint8_t *log_reserve(mpu925x_log_recorder *recorder, uint8_t type, uint8_t size)
+{
+	if (recorder->length + 2 + size > MPU925X_LOG_BUFFER_SIZE) {
+		mpu925x_log_flush(recorder);
+	}
+
+	uint8_t *record = &recorder->buffer[recorder->length];
+	record[0] = type;
+	record[1] = size;
+	recorder->length += 2 + size;
+
+	return record + 2;
+}
+
+/**
+ * @brief Write active configuration to log.
+ * 
+ * Must be called at the start of every recording session and whenever
+ * configuration (scales, modes, calibration, mounting) changes.
+ * @param recorder Log recorder struct pointer.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_log_write_config(mpu925x_log_recorder *recorder, mpu925x_t *mpu925x)
+{
+	uint8_t *payload = log_reserve(recorder, LOG_RECORD_CONFIG, LOG_CONFIG_SIZE);
+	float values[27];
+	uint8_t index = 0;
+
+	put_uint(payload, mpu925x->sensor_data.timestamp, 8);
+	payload[8] = mpu925x->settings.accelerometer_scale;
+	payload[9] = mpu925x->settings.gyroscope_scale;
+	payload[10] = mpu925x->settings.measurement_mode;
+	payload[11] = mpu925x->settings.bit_mode;
+	payload[12] = mpu925x->settings.accelerometer_matrix_enabled;
+	payload[13] = mpu925x->settings.body_frame;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		values[index++] = mpu925x->settings.magnetometer_coefficient[i];
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		values[index++] = mpu925x->settings.accelerometer_bias[i];
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		values[index++] = mpu925x->settings.gyroscope_bias[i];
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			values[index++] = mpu925x->settings.accelerometer_matrix[i][j];
+		}
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			values[index++] = mpu925x->settings.mounting_matrix[i][j];
+		}
+	}
+	for (uint8_t i = 0; i < 27; i++) {
+		mpu925x_pack_float(&payload[14 + i * 4], values[i]);
+	}
+
+	recorder->timestamp = mpu925x->sensor_data.timestamp;
+	recorder->accelerometer_scale = mpu925x->settings.accelerometer_scale;
+	recorder->gyroscope_scale = mpu925x->settings.gyroscope_scale;
+}
+
+/**
+ * @brief Write last read raw sample to log.
+ * 
+ * Uses raw data, magnetometer status, timestamp and range tags already stored
+ * in ``sensor_data``. A range record is written first if sample's ranges
+ * changed. Record is only copied to write buffer, file is written when buffer
+ * is full.
+ * @param recorder Log recorder struct pointer.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_log_write_sample(mpu925x_log_recorder *recorder, mpu925x_t *mpu925x)
+{
+	uint64_t timestamp = mpu925x->sensor_data.timestamp;
+	uint8_t *payload;
+
+	// Time difference must fit in 32 bits.
+	if (timestamp < recorder->timestamp || timestamp - recorder->timestamp > UINT32_MAX) {
+		payload = log_reserve(recorder, LOG_RECORD_TIME, LOG_TIME_SIZE);
+		put_uint(payload, timestamp, 8);
+		recorder->timestamp = timestamp;
+	}
+
+	// Ranges changed since previous record.
+	if (mpu925x->sensor_data.accelerometer_scale != recorder->accelerometer_scale ||
+	    mpu925x->sensor_data.gyroscope_scale != recorder->gyroscope_scale) {
+		payload = log_reserve(recorder, LOG_RECORD_RANGE, LOG_RANGE_SIZE);
+		payload[0] = mpu925x->sensor_data.accelerometer_scale;
+		payload[1] = mpu925x->sensor_data.gyroscope_scale;
+		recorder->accelerometer_scale = mpu925x->sensor_data.accelerometer_scale;
+		recorder->gyroscope_scale = mpu925x->sensor_data.gyroscope_scale;
+	}
+
+	payload = log_reserve(recorder, LOG_RECORD_SAMPLE, LOG_SAMPLE_SIZE);
+	put_uint(payload, timestamp - recorder->timestamp, 4);
+	recorder->timestamp = timestamp;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		put_uint(&payload[4 + i * 2], (uint16_t)mpu925x->sensor_data.acceleration_raw[i], 2);
+		put_uint(&payload[12 + i * 2], (uint16_t)mpu925x->sensor_data.rotation_raw[i], 2);
+		put_uint(&payload[18 + i * 2], (uint16_t)mpu925x->sensor_data.magnet_raw[i], 2);
+	}
+	put_uint(&payload[10], (uint16_t)mpu925x->sensor_data.temperature_raw, 2);
+	payload[24] = mpu925x->sensor_data.magnetometer_status;
+}
+
+/**
+ * @brief Write buffered records to file.
+ * 
+ * Buffer is emptied even if write fails, so recording can go on. A failed
+ * write (e.g. full disk) is remembered and reported by next flush and close,
+ * including writes done implicitly by ``mpu925x_log_write_sample``.
+ * @param recorder Log recorder struct pointer.
+ * @returns 0 on success, 1 if any write to file has failed.
+ * */
+uint8_t mpu925x_log_flush(mpu925x_log_recorder *recorder)
+{
+	if (recorder->length > 0) {
+		if (fwrite(recorder->buffer, 1, recorder->length, recorder->file) != recorder->length) {
+			recorder->failed = 1;
+		}
+		recorder->length = 0;
+	}
+
+	return recorder->failed;
+}
+
+/**
+ * @brief Flush and close log file.
+ * @param recorder Log recorder struct pointer.
+ * @returns 0 on success, 1 if any write to file or closing has failed.
+ * */
+uint8_t mpu925x_log_close(mpu925x_log_recorder *recorder)
+{
+	uint8_t failed = mpu925x_log_flush(recorder);
+
+	if (fclose(recorder->file) != 0) {
+		failed = 1;
+	}
+	recorder->file = NULL;
+
+	return failed;
+}
+
+/*******************************************************************************
+ * Replay
+ ******************************************************************************/
+
+static uint8_t replay_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	mpu925x_log_replay *replay = mpu925x->master_specific.bus_handle;
+	uint8_t *registers = slave_address == AK8963_ADDRESS ? replay->ak_registers : replay->mpu_registers;
+
+	for (uint16_t i = 0; i < size; i++) {
+		buffer[i] = registers[(reg + i) & 0xFF];
+	}
+
+	return 0;
+}
+
+static uint8_t replay_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	mpu925x_log_replay *replay = mpu925x->master_specific.bus_handle;
+	uint8_t *registers = slave_address == AK8963_ADDRESS ? replay->ak_registers : replay->mpu_registers;
+
+	for (uint16_t i = 0; i < size; i++) {
+		registers[(reg + i) & 0xFF] = buffer[i];
+	}
+
+	return 0;
+}
+
+static void replay_delay_ms(mpu925x_t *mpu925x, uint32_t delay)
+{
+	// Log already has original timing, nothing to wait for.
+}
+
+static uint64_t replay_get_time_us(mpu925x_t *mpu925x)
+{
+	mpu925x_log_replay *replay = mpu925x->master_specific.bus_handle;
+
+	return replay->timestamp;
+}
+
+static uint64_t monotonic_us(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**
+ * @brief Open log file for replay.
+ * @param replay Log replay struct pointer.
+ * @param path Path of log file.
+ * @param speed Replay speed relative to original timing, 0 for no waiting.
+ * @returns 0 on success, 1 if file can't be opened, 2 on wrong magic or
+ * version.
+ * */
+uint8_t mpu925x_log_replay_open(mpu925x_log_replay *replay, const char *path, float speed)
+{
+	uint8_t header[5];
+
+	memset(replay, 0, sizeof(*replay));
+	replay->speed = speed;
+
+	replay->file = fopen(path, "rb");
+	if (replay->file == NULL) {
+		return 1;
+	}
+
+	if (fread(header, 1, sizeof(header), replay->file) != sizeof(header) ||
+	    memcmp(header, log_magic, sizeof(log_magic)) != 0 || header[4] != MPU925X_LOG_VERSION) {
+		fclose(replay->file);
+		replay->file = NULL;
+		return 2;
+	}
+
+	// Identity registers, so driver can be initialized on replay.
+	replay->mpu_registers[WHO_AM_I] = 0x71;
+	replay->ak_registers[WIA] = 0x48;
+
+	return 0;
+}
+
+/**
+ * @brief Use log replay as transport of MPU-925X driver.
+ * 
+ * Bus, delay and time functions of given struct are replaced. Call this
+ * function before ``mpu925x_init``.
+ * @param replay Log replay struct pointer.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_log_replay_attach(mpu925x_log_replay *replay, mpu925x_t *mpu925x)
+{
+	replay->mpu925x = mpu925x;
+	mpu925x->master_specific.bus_handle = replay;
+	mpu925x->master_specific.bus_read = replay_read;
+	mpu925x->master_specific.bus_write = replay_write;
+	mpu925x->master_specific.delay_ms = replay_delay_ms;
+	mpu925x->master_specific.get_time_us = replay_get_time_us;
+}
+
+/**
+ * @brief Apply config record to register images and attached driver.
+ * @param replay Log replay struct pointer.
+ * @param payload Config record payload.
+ * */
+static void replay_apply_config(mpu925x_log_replay *replay, const uint8_t *payload)
+{
+	mpu925x_t *mpu925x = replay->mpu925x;
+	float values[27];
+	float accelerometer_matrix[3][3], mounting_matrix[3][3];
+
+	replay->timestamp = get_uint(payload, 8);
+	for (uint8_t i = 0; i < 27; i++) {
+		values[i] = mpu925x_unpack_float(&payload[14 + i * 4]);
+	}
+
+	// Fuse ROM values which give recorded coefficients.
+	for (uint8_t i = 0; i < 3; i++) {
+		replay->ak_registers[ASAX + i] = (uint8_t)((values[i] - 1) * 256 + 128.5);
+	}
+
+	if (mpu925x == NULL) {
+		return;
+	}
+
+	mpu925x_set_accelerometer_scale(mpu925x, payload[8]);
+	mpu925x_set_gyroscope_scale(mpu925x, payload[9]);
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, payload[10]);
+	mpu925x_set_magnetometer_bit_mode(mpu925x, payload[11]);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->settings.magnetometer_coefficient[i] = values[i];
+		mpu925x->settings.accelerometer_bias[i] = values[3 + i];
+		mpu925x->settings.gyroscope_bias[i] = values[6 + i];
+		for (uint8_t j = 0; j < 3; j++) {
+			accelerometer_matrix[i][j] = values[9 + i * 3 + j];
+			mounting_matrix[i][j] = values[18 + i * 3 + j];
+		}
+	}
+
+	mpu925x_set_accelerometer_matrix(mpu925x, payload[12] ? accelerometer_matrix : NULL);
+	mpu925x_set_mounting_matrix(mpu925x, payload[13] ? mounting_matrix : NULL);
+}
+
+/**
+ * @brief Apply sample record to register images.
+ * @param replay Log replay struct pointer.
+ * @param payload Sample record payload.
+ * */
+static void replay_apply_sample(mpu925x_log_replay *replay, const uint8_t *payload)
+{
+	replay->timestamp += get_uint(payload, 4);
+
+	// Acceleration, temperature and rotation are big endian and contiguous.
+	for (uint8_t i = 0; i < 7; i++) {
+		replay->mpu_registers[ACCEL_XOUT_H + i * 2] = payload[4 + i * 2 + 1];
+		replay->mpu_registers[ACCEL_XOUT_H + i * 2 + 1] = payload[4 + i * 2];
+	}
+
+	// Magnetic field is little endian, ST1 and ST2 give recorded status.
+	memcpy(&replay->ak_registers[HXL], &payload[18], 6);
+	replay->ak_registers[ST1] = payload[24] & (MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERRUN);
+	replay->ak_registers[ST2] = payload[24] & MPU925X_MAGNETOMETER_OVERFLOW;
+	if (replay->mpu925x != NULL) {
+		replay->ak_registers[ST2] |= replay->mpu925x->settings.bit_mode << 4;
+	}
+}
+
+/**
+ * @brief Advance replay to next sample.
+ * 
+ * Config, time and range records before the sample are applied on the way.
+ * If replay speed is not 0, this function waits until sample's original time
+ * (scaled by speed) has passed since first sample.
+ * @param replay Log replay struct pointer.
+ * @returns 0 on success, 1 on end of log or truncated record.
+ * */
+uint8_t mpu925x_log_replay_next(mpu925x_log_replay *replay)
+{
+	uint8_t header[2], payload[255];
+
+	while (fread(header, 1, 2, replay->file) == 2) {
+		if (fread(payload, 1, header[1], replay->file) != header[1]) {
+			return 1;
+		}
+
+		switch (header[0]) {
+			case LOG_RECORD_CONFIG:
+				if (header[1] >= LOG_CONFIG_SIZE)
+					replay_apply_config(replay, payload);
+				continue;
+			case LOG_RECORD_TIME:
+				if (header[1] >= LOG_TIME_SIZE)
+					replay->timestamp = get_uint(payload, 8);
+				continue;
+			case LOG_RECORD_RANGE:
+				if (header[1] >= LOG_RANGE_SIZE && replay->mpu925x != NULL) {
+					mpu925x_set_accelerometer_scale(replay->mpu925x, payload[0]);
+					mpu925x_set_gyroscope_scale(replay->mpu925x, payload[1]);
+				}
+				continue;
+			case LOG_RECORD_SAMPLE:
+				if (header[1] < LOG_SAMPLE_SIZE)
+					continue;
+				replay_apply_sample(replay, payload);
+				break;
+			default:
+				// Unknown record, skip.
+				continue;
+		}
+
+		if (replay->speed > 0) {
+			if (!replay->started) {
+				replay->started = 1;
+				replay->first_timestamp = replay->timestamp;
+				replay->wall_start = monotonic_us();
+			}
+
+			uint64_t target = replay->wall_start + (uint64_t)((replay->timestamp - replay->first_timestamp) / replay->speed);
+			uint64_t now = monotonic_us();
+			if (target > now) {
+				struct timespec delay = {
+					.tv_sec = (target - now) / 1000000,
+					.tv_nsec = ((target - now) % 1000000) * 1000
+				};
+				nanosleep(&delay, NULL);
+			}
+		}
+
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Close replayed log file.
+ * @param replay Log replay struct pointer.
+ * */
+void mpu925x_log_replay_close(mpu925x_log_replay *replay)
+{
+	if (replay->file != NULL) {
+		fclose(replay->file);
+		replay->file = NULL;
+	}
+}
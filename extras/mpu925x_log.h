@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Binary sample log header file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_LOG_H
+#define __MPU925X_LOG_H
+
+#include "mpu925x.h"
+#include <stdio.h>
+
+/*
+ * Log format (all values little endian):
+ * 
+ * File header: "M9LG" magic and 1 byte version. Written once, when file is
+ * created. Files are append only, each recording session starts with a config
+ * record.
+ * 
+ * Records: 1 byte type, 1 byte payload length and payload. Unknown record
+ * types are skipped with their length, so new record types can be added
+ * without breaking old readers.
+ * 
+ * Config record payload: 8 byte absolute timestamp (us), accelerometer scale,
+ * gyroscope scale, magnetometer measurement mode, magnetometer bit mode,
+ * accelerometer matrix enabled and body frame flags (1 byte each) followed by
+ * magnetometer coefficients, accelerometer bias, gyroscope bias, accelerometer
+ * matrix and mounting matrix as floats.
+ * 
+ * Time record payload: 8 byte absolute timestamp (us). Written when time
+ * difference between samples doesn't fit in sample record.
+ * 
+ * Sample record payload: 4 byte timestamp difference to previous record (us),
+ * raw acceleration, temperature, rotation and magnetic field as 16 bit signed
+ * integers and magnetometer status (``sensor_data.magnetometer_status``, 1
+ * byte).
+ * 
+ * Range record payload: accelerometer scale and gyroscope scale (1 byte
+ * each). Written before a sample whose full-scale ranges differ from previous
+ * record's (e.g. after automatic range control changed a range).
+ */
+
+/**
+ * @brief Log format version.
+ * */
+#define MPU925X_LOG_VERSION 2
+
+/**
+ * @brief Size of recorder's write buffer in bytes.
+ * */
+#define MPU925X_LOG_BUFFER_SIZE 4096
+
+/**
+ * @brief Sample log recorder.
+ * 
+ * ``failed`` is set when a file write fails, it is reported by
+ * ``mpu925x_log_flush`` and ``mpu925x_log_close``.
+ * */
+typedef struct mpu925x_log_recorder {
+	FILE *file;
+	uint64_t timestamp;
+	uint8_t accelerometer_scale, gyroscope_scale;
+	uint8_t failed;
+	uint16_t length;
+	uint8_t buffer[MPU925X_LOG_BUFFER_SIZE];
+} mpu925x_log_recorder;
+
+/**
+ * @brief Sample log replay transport.
+ * 
+ * Serves bus reads from register images built from log records, so
+ * ``mpu925x_init`` and ``mpu925x_get_*`` functions work unmodified on a log.
+ * ``speed`` is replay speed relative to original timing, 0 means as fast as
+ * possible.
+ * */
+typedef struct mpu925x_log_replay {
+	FILE *file;
+	float speed;
+	uint64_t timestamp;
+	uint64_t first_timestamp;
+	uint64_t wall_start;
+	uint8_t started;
+	uint8_t mpu_registers[256];
+	uint8_t ak_registers[256];
+	mpu925x_t *mpu925x;
+} mpu925x_log_replay;
+
+// Recorder
+uint8_t mpu925x_log_open(mpu925x_log_recorder *recorder, const char *path);
+void mpu925x_log_write_config(mpu925x_log_recorder *recorder, mpu925x_t *mpu925x);
+void mpu925x_log_write_sample(mpu925x_log_recorder *recorder, mpu925x_t *mpu925x);
+uint8_t mpu925x_log_flush(mpu925x_log_recorder *recorder);
+uint8_t mpu925x_log_close(mpu925x_log_recorder *recorder);
+
+// Replay
+uint8_t mpu925x_log_replay_open(mpu925x_log_replay *replay, const char *path, float speed);
+void mpu925x_log_replay_attach(mpu925x_log_replay *replay, mpu925x_t *mpu925x);
+uint8_t mpu925x_log_replay_next(mpu925x_log_replay *replay);
+void mpu925x_log_replay_close(mpu925x_log_replay *replay);
+
+#endif // __MPU925X_LOG_H
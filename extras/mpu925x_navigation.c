@@ -0,0 +1,206 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Linear acceleration and dead reckoning source file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_navigation.h"
+#include <math.h>
+#include <string.h>
+
+// R(q), body to world.
+static void rotation_matrix(const float q[4], float r[3][3])
+{
+	float w = q[0], x = q[1], y = q[2], z = q[3];
+
+	r[0][0] = 1 - 2 * (y * y + z * z);
+	r[0][1] = 2 * (x * y - w * z);
+	r[0][2] = 2 * (x * z + w * y);
+	r[1][0] = 2 * (x * y + w * z);
+	r[1][1] = 1 - 2 * (x * x + z * z);
+	r[1][2] = 2 * (y * z - w * x);
+	r[2][0] = 2 * (x * z - w * y);
+	r[2][1] = 2 * (y * z + w * x);
+	r[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+// Compensate gravity of one sample into linear, integrate it over dt and
+// return 1 if velocity is zeroed.
+static uint8_t step(mpu925x_navigation *navigation, float r[3][3], const float acceleration[3], const float *rotation, float dt, float linear[3])
+{
+	float a0 = acceleration[0], a1 = acceleration[1], a2 = acceleration[2];
+	float scale = navigation->scale;
+
+	linear[0] = (r[0][0] * a0 + r[0][1] * a1 + r[0][2] * a2) * scale;
+	linear[1] = (r[1][0] * a0 + r[1][1] * a1 + r[1][2] * a2) * scale;
+	linear[2] = (r[2][0] * a0 + r[2][1] * a1 + r[2][2] * a2 - navigation->gravity) * scale;
+
+	if (navigation->zupt_acceleration_squared > 0) {
+		uint8_t still = linear[0] * linear[0] + linear[1] * linear[1] + linear[2] * linear[2] < navigation->zupt_acceleration_squared;
+		if (still && rotation != NULL && navigation->zupt_rotation_squared > 0) {
+			still = rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] < navigation->zupt_rotation_squared;
+		}
+
+		if (!still) {
+			navigation->still_length = 0;
+		}
+		else if (navigation->still_length < navigation->zupt_samples) {
+			navigation->still_length++;
+		}
+
+		if (still && navigation->still_length >= navigation->zupt_samples) {
+			navigation->velocity[0] = navigation->velocity[1] = navigation->velocity[2] = 0;
+			navigation->still = 1;
+			return 1;
+		}
+	}
+	navigation->still = 0;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		navigation->position[i] += (navigation->velocity[i] + 0.5f * linear[i] * dt) * dt;
+		navigation->velocity[i] += linear[i] * dt;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Initialize navigation from its configuration and reset its state.
+ * @param navigation Navigation struct pointer.
+ * */
+void mpu925x_navigation_init(mpu925x_navigation *navigation)
+{
+	if (navigation->gravity <= 0) {
+		navigation->gravity = 1;
+	}
+	if (navigation->local_gravity <= 0) {
+		navigation->local_gravity = MPU925X_STANDARD_GRAVITY;
+	}
+	navigation->scale = navigation->local_gravity / navigation->gravity;
+
+	float acceleration = navigation->zupt_acceleration * navigation->local_gravity;
+	navigation->zupt_acceleration_squared = acceleration * acceleration;
+	navigation->zupt_rotation_squared = navigation->zupt_rotation * navigation->zupt_rotation;
+
+	mpu925x_navigation_reset(navigation);
+}
+
+/**
+ * @brief Reset linear acceleration, velocity and position to zero.
+ * 
+ * Should be called at start of every dead reckoning segment.
+ * @param navigation Navigation struct pointer.
+ * */
+void mpu925x_navigation_reset(mpu925x_navigation *navigation)
+{
+	memset(navigation->linear_acceleration, 0, sizeof(navigation->linear_acceleration));
+	memset(navigation->velocity, 0, sizeof(navigation->velocity));
+	memset(navigation->position, 0, sizeof(navigation->position));
+	navigation->still_length = 0;
+	navigation->still = 0;
+}
+
+/**
+ * @brief Measure gravity norm from samples taken at rest and apply it.
+ * 
+ * Calibrated accelerometer still reads gravity a little off 1 g (scale error,
+ * local gravity), measuring it removes that offset from linear acceleration.
+ * State is reset.
+ * @param navigation Navigation struct pointer.
+ * @param acceleration Acceleration samples in g's, taken at rest.
+ * @param count Sample count.
+ * @returns Measured gravity norm in g's.
+ * */
+float mpu925x_navigation_measure_gravity(mpu925x_navigation *navigation, float (*acceleration)[3], uint16_t count)
+{
+	float sum = 0;
+
+	for (uint16_t n = 0; n < count; n++) {
+		sum += sqrtf(acceleration[n][0] * acceleration[n][0] + acceleration[n][1] * acceleration[n][1] + acceleration[n][2] * acceleration[n][2]);
+	}
+
+	if (count > 0) {
+		navigation->gravity = sum / count;
+		mpu925x_navigation_init(navigation);
+	}
+
+	return navigation->gravity;
+}
+
+/**
+ * @brief Update navigation with one sample.
+ * 
+ * Linear acceleration in world frame (m/s^2) is stored in
+ * ``linear_acceleration``, it is integrated over ``sample_period``.
+ * @param navigation Navigation struct pointer.
+ * @param quaternion Attitude quaternion, body to world.
+ * @param acceleration Acceleration in g's, body frame.
+ * @param rotation Rotation in degrees per second, can be NULL.
+ * @returns 1 if velocity is zeroed by zero velocity update, 0 if not.
+ * */
+uint8_t mpu925x_navigation_update(mpu925x_navigation *navigation, const float quaternion[4], const float acceleration[3], const float rotation[3])
+{
+	float r[3][3];
+
+	rotation_matrix(quaternion, r);
+
+	return step(navigation, r, acceleration, rotation, navigation->sample_period, navigation->linear_acceleration);
+}
+
+/**
+ * @brief Update navigation with a block of samples.
+ * 
+ * Rotation matrix is computed once per block from ``quaternion``, so block
+ * should be short compared to attitude changes (e.g. a FIFO drain). Samples
+ * of ``acceleration`` are replaced with linear acceleration in world frame
+ * (m/s^2) in place. Samples are integrated over ``period``, pass drift
+ * corrected ``period`` of FIFO block (``block.period * 1e-6``), so
+ * integration follows actual sample rate of sensor oscillator over long runs.
+ * @param navigation Navigation struct pointer.
+ * @param quaternion Attitude quaternion, body to world.
+ * @param acceleration Acceleration samples in g's, body frame.
+ * @param rotation Rotation samples in degrees per second, can be NULL.
+ * @param count Sample count.
+ * @param period Sample period in seconds, 0 for ``sample_period``.
+ * @returns Count of samples where velocity is zeroed.
+ * */
+uint16_t mpu925x_navigation_process(mpu925x_navigation *navigation, const float quaternion[4], float (*acceleration)[3], float (*rotation)[3], uint16_t count, float period)
+{
+	float r[3][3];
+	float dt = period > 0 ? period : navigation->sample_period;
+	uint16_t still = 0;
+
+	rotation_matrix(quaternion, r);
+
+	for (uint16_t n = 0; n < count; n++) {
+		float linear[3];
+		still += step(navigation, r, acceleration[n], rotation != NULL ? rotation[n] : NULL, dt, linear);
+		memcpy(acceleration[n], linear, sizeof(linear));
+	}
+
+	if (count > 0) {
+		memcpy(navigation->linear_acceleration, acceleration[count - 1], sizeof(navigation->linear_acceleration));
+	}
+
+	return still;
+}
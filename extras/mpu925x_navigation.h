@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Linear acceleration and dead reckoning header file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_NAVIGATION_H
+#define __MPU925X_NAVIGATION_H
+
+#include <stdint.h>
+
+/**
+ * @brief Standard gravity in m/s^2.
+ * */
+#define MPU925X_STANDARD_GRAVITY 9.80665f
+
+/**
+ * @brief Gravity compensated linear acceleration and dead reckoning.
+ * 
+ * Acceleration (g's, body frame) is rotated to world frame with an attitude
+ * quaternion (body to world, world z axis up, e.g. ``quaternion`` of EKF AHRS),
+ * gravity is subtracted and result is converted to m/s^2. Linear acceleration
+ * is integrated to velocity and position with sample period of each block
+ * (drift corrected ``period`` of a FIFO block) or a fixed one. Drift of
+ * integration grows quickly, so it is only meant for short segments between
+ * zero velocity updates (ZUPT): when linear acceleration and rotation stay
+ * below their thresholds for ``zupt_samples`` samples, velocity is set to zero
+ * and position is held.
+ * 
+ * Configuration fields must be set before ``mpu925x_navigation_init``:
+ * - ``sample_period``: sample period in seconds, used by
+ *   ``mpu925x_navigation_update`` and when a block has no period.
+ * - ``gravity``: gravity norm in g's as measured by calibrated accelerometer
+ *   at rest (see ``mpu925x_navigation_measure_gravity``), 0 is 1 g.
+ * - ``local_gravity``: local gravity in m/s^2, 0 is standard gravity.
+ * - ``zupt_acceleration``: linear acceleration threshold in g's, 0 disables
+ *   zero velocity updates.
+ * - ``zupt_rotation``: rotation threshold in degrees per second, 0 ignores
+ *   rotation.
+ * - ``zupt_samples``: samples below thresholds before velocity is zeroed.
+ * */
+typedef struct mpu925x_navigation {
+	// Configuration
+	float sample_period;
+	float gravity;
+	float local_gravity;
+	float zupt_acceleration;
+	float zupt_rotation;
+	uint16_t zupt_samples;
+
+	// Derived from configuration
+	float scale;
+	float zupt_acceleration_squared, zupt_rotation_squared;
+
+	// State
+	float linear_acceleration[3];
+	float velocity[3];
+	float position[3];
+	uint32_t still_length;
+	uint8_t still;
+} mpu925x_navigation;
+
+void mpu925x_navigation_init(mpu925x_navigation *navigation);
+void mpu925x_navigation_reset(mpu925x_navigation *navigation);
+float mpu925x_navigation_measure_gravity(mpu925x_navigation *navigation, float (*acceleration)[3], uint16_t count);
+uint8_t mpu925x_navigation_update(mpu925x_navigation *navigation, const float quaternion[4], const float acceleration[3], const float rotation[3]);
+uint16_t mpu925x_navigation_process(mpu925x_navigation *navigation, const float quaternion[4], float (*acceleration)[3], float (*rotation)[3], uint16_t count, float period);
+
+#endif // __MPU925X_NAVIGATION_H
@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Shared memory sample ring source file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "mpu925x_shm.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// "M9SM"
+#define SHM_MAGIC                  0x4D53394D
+
+/**
+ * @brief Get CLOCK_MONOTONIC time.
+ * @returns Time in nanoseconds.
+ * */
+uint64_t mpu925x_shm_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Copy a slot consistently.
+ * @param slot Slot pointer.
+ * @param sample Destination sample.
+ * */
+static void read_slot(const mpu925x_shm_slot *slot, mpu925x_shm_sample *sample)
+{
+	for (;;) {
+		unsigned int before = atomic_load_explicit((atomic_uint *)&slot->sequence, memory_order_acquire);
+		if (before & 1) {
+			continue;
+		}
+
+		memcpy(sample, &slot->sample, sizeof(*sample));
+
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit((atomic_uint *)&slot->sequence, memory_order_relaxed) == before) {
+			return;
+		}
+	}
+}
+
+/*******************************************************************************
+ * Writer
+ ******************************************************************************/
+
+/**
+ * @brief Create shared memory ring.
+ * 
+ * Existing object with same name is replaced.
+ * @param writer Writer struct pointer.
+ * @param name Shared memory object name, such as "/mpu925x".
+ * @param capacity Number of slots.
+ * @param sample_rate Publishing rate in Hz, informative for clients.
+ * @returns 0 on success, 1 on failure.
+ * */
+uint8_t mpu925x_shm_create(mpu925x_shm_writer *writer, const char *name, uint32_t capacity, uint32_t sample_rate)
+{
+	uint64_t size = sizeof(mpu925x_shm_ring) + (uint64_t)capacity * sizeof(mpu925x_shm_slot);
+
+	if (capacity == 0 || strlen(name) >= sizeof(writer->name)) {
+		return 1;
+	}
+
+	shm_unlink(name);
+	int descriptor = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (descriptor < 0) {
+		return 1;
+	}
+	if (ftruncate(descriptor, size) != 0) {
+		close(descriptor);
+		shm_unlink(name);
+		return 1;
+	}
+
+	void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (memory == MAP_FAILED) {
+		shm_unlink(name);
+		return 1;
+	}
+
+	// New object is zero filled, so all slots are empty and consistent.
+	writer->ring = memory;
+	writer->ring->capacity = capacity;
+	writer->ring->sample_rate = sample_rate;
+	writer->ring->slot_size = sizeof(mpu925x_shm_slot);
+	writer->ring->version = MPU925X_SHM_VERSION;
+	atomic_store_explicit(&writer->ring->published, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	writer->ring->magic = SHM_MAGIC;
+
+	strcpy(writer->name, name);
+	writer->size = size;
+	writer->published = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Publish last read sensor data.
+ * 
+ * Never blocks, slow readers lose oldest samples.
+ * @param writer Writer struct pointer.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_shm_publish(mpu925x_shm_writer *writer, mpu925x_t *mpu925x)
+{
+	mpu925x_shm_slot *slot = &writer->ring->slots[writer->published % writer->ring->capacity];
+	mpu925x_shm_sample *sample = &slot->sample;
+	unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+	// Odd sequence marks slot as being written.
+	atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	sample->timestamp = mpu925x->sensor_data.timestamp;
+	sample->sequence = writer->published;
+	for (uint8_t i = 0; i < 3; i++) {
+		sample->acceleration_raw[i] = mpu925x->sensor_data.acceleration_raw[i];
+		sample->rotation_raw[i] = mpu925x->sensor_data.rotation_raw[i];
+		sample->magnet_raw[i] = mpu925x->sensor_data.magnet_raw[i];
+		sample->acceleration[i] = mpu925x->sensor_data.acceleration[i];
+		sample->rotation[i] = mpu925x->sensor_data.rotation[i];
+		sample->magnetic_field[i] = mpu925x->sensor_data.magnetic_field[i];
+	}
+	sample->temperature_raw = mpu925x->sensor_data.temperature_raw;
+	sample->temperature = mpu925x->sensor_data.temperature;
+	sample->refreshed = mpu925x->sensor_data.refreshed;
+	sample->magnetometer_status = mpu925x->sensor_data.magnetometer_status;
+	sample->publish_time = mpu925x_shm_now();
+
+	atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+
+	writer->published++;
+	atomic_store_explicit(&writer->ring->published, writer->published, memory_order_release);
+}
+
+/**
+ * @brief Unmap and remove shared memory ring.
+ * 
+ * Clients which already mapped the ring keep their mapping.
+ * @param writer Writer struct pointer.
+ * */
+void mpu925x_shm_destroy(mpu925x_shm_writer *writer)
+{
+	if (writer->ring != NULL) {
+		munmap(writer->ring, writer->size);
+		shm_unlink(writer->name);
+		writer->ring = NULL;
+	}
+}
+
+/*******************************************************************************
+ * Reader
+ ******************************************************************************/
+
+/**
+ * @brief Map shared memory ring read only.
+ * 
+ * Reader starts from samples published after opening.
+ * @param reader Reader struct pointer.
+ * @param name Shared memory object name.
+ * @returns 0 on success, 1 if object can't be mapped, 2 on incompatible
+ * layout.
+ * */
+uint8_t mpu925x_shm_open(mpu925x_shm_reader *reader, const char *name)
+{
+	struct stat status;
+
+	int descriptor = shm_open(name, O_RDONLY, 0);
+	if (descriptor < 0) {
+		return 1;
+	}
+	if (fstat(descriptor, &status) != 0 || (uint64_t)status.st_size < sizeof(mpu925x_shm_ring)) {
+		close(descriptor);
+		return 1;
+	}
+
+	void *memory = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (memory == MAP_FAILED) {
+		return 1;
+	}
+
+	const mpu925x_shm_ring *ring = memory;
+	if (ring->magic != SHM_MAGIC || ring->version != MPU925X_SHM_VERSION || ring->slot_size != sizeof(mpu925x_shm_slot) ||
+	    sizeof(mpu925x_shm_ring) + (uint64_t)ring->capacity * sizeof(mpu925x_shm_slot) > (uint64_t)status.st_size) {
+		munmap(memory, status.st_size);
+		return 2;
+	}
+
+	reader->ring = ring;
+	reader->size = status.st_size;
+	reader->next = atomic_load_explicit((atomic_ullong *)&ring->published, memory_order_acquire);
+
+	return 0;
+}
+
+/**
+ * @brief Read newest sample.
+ * @param reader Reader struct pointer.
+ * @param sample Destination sample.
+ * @returns 0 on success, 1 if nothing is published yet.
+ * */
+uint8_t mpu925x_shm_read_latest(mpu925x_shm_reader *reader, mpu925x_shm_sample *sample)
+{
+	uint64_t published = atomic_load_explicit((atomic_ullong *)&reader->ring->published, memory_order_acquire);
+
+	if (published == 0) {
+		return 1;
+	}
+
+	read_slot(&reader->ring->slots[(published - 1) % reader->ring->capacity], sample);
+
+	return 0;
+}
+
+/**
+ * @brief Read next sample in order.
+ * 
+ * If reader fell behind more than ring capacity, oldest available sample is
+ * returned and missed samples are reported.
+ * @param reader Reader struct pointer.
+ * @param sample Destination sample.
+ * @returns 0 on success, 1 if there is no new sample, 2 if samples are lost
+ * before returned sample.
+ * */
+uint8_t mpu925x_shm_read_next(mpu925x_shm_reader *reader, mpu925x_shm_sample *sample)
+{
+	uint64_t published = atomic_load_explicit((atomic_ullong *)&reader->ring->published, memory_order_acquire);
+	uint32_t capacity = reader->ring->capacity;
+	uint8_t lost = 0;
+
+	if (reader->next >= published) {
+		return 1;
+	}
+	if (published - reader->next > capacity) {
+		reader->next = published - capacity;
+		lost = 1;
+	}
+
+	read_slot(&reader->ring->slots[reader->next % capacity], sample);
+
+	// Writer overwrote slot while it was being reached.
+	if (sample->sequence != reader->next) {
+		lost = 1;
+	}
+	reader->next = sample->sequence + 1;
+
+	return lost ? 2 : 0;
+}
+
+/**
+ * @brief Unmap shared memory ring.
+ * @param reader Reader struct pointer.
+ * */
+void mpu925x_shm_close(mpu925x_shm_reader *reader)
+{
+	if (reader->ring != NULL) {
+		munmap((void *)reader->ring, reader->size);
+		reader->ring = NULL;
+	}
+}
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Shared memory sample ring header file for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_SHM_H
+#define __MPU925X_SHM_H
+
+#include "mpu925x.h"
+#include <stdatomic.h>
+
+/*
+ * Shared memory layout:
+ * 
+ * Ring header followed by ``capacity`` slots. Single writer (daemon)
+ * publishes samples, any number of readers map the object read only and read
+ * slots without system calls or locks.
+ * 
+ * Every slot is protected by its own sequence counter (seqlock): writer makes
+ * it odd before writing the slot and even after it. Reader copies the slot
+ * and accepts the copy only if sequence was even and unchanged, otherwise it
+ * retries. ``published`` is total number of published samples, newest sample
+ * is in slot ``(published - 1) % capacity``.
+ */
+
+/**
+ * @brief Shared memory layout version.
+ * */
+#define MPU925X_SHM_VERSION 1
+
+/**
+ * @brief Published sample.
+ * 
+ * ``timestamp`` is acquisition time from ``get_time_us`` (us),
+ * ``publish_time`` is CLOCK_MONOTONIC time of publishing (ns) and
+ * ``sequence`` is sample number since daemon start.
+ * */
+typedef struct mpu925x_shm_sample {
+	uint64_t timestamp;
+	uint64_t publish_time;
+	uint64_t sequence;
+	int16_t acceleration_raw[3], rotation_raw[3], magnet_raw[3], temperature_raw;
+	float acceleration[3], rotation[3], magnetic_field[3], temperature;
+	uint8_t refreshed;
+	uint8_t magnetometer_status;
+} mpu925x_shm_sample;
+
+/**
+ * @brief Ring slot, aligned to cache line so writer and readers of different
+ * slots don't share lines.
+ * */
+typedef struct mpu925x_shm_slot {
+	_Alignas(64) atomic_uint sequence;
+	mpu925x_shm_sample sample;
+} mpu925x_shm_slot;
+
+/**
+ * @brief Shared memory ring header.
+ * */
+typedef struct mpu925x_shm_ring {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t slot_size;
+	uint32_t capacity;
+	uint32_t sample_rate;
+	_Alignas(64) atomic_ullong published;
+	mpu925x_shm_slot slots[];
+} mpu925x_shm_ring;
+
+/**
+ * @brief Writer (daemon) side handle.
+ * */
+typedef struct mpu925x_shm_writer {
+	mpu925x_shm_ring *ring;
+	char name[64];
+	uint64_t size;
+	uint64_t published;
+} mpu925x_shm_writer;
+
+/**
+ * @brief Reader (client) side handle.
+ * 
+ * ``next`` is sequence of next sample ``mpu925x_shm_read_next`` returns.
+ * */
+typedef struct mpu925x_shm_reader {
+	const mpu925x_shm_ring *ring;
+	uint64_t size;
+	uint64_t next;
+} mpu925x_shm_reader;
+
+// Writer
+uint8_t mpu925x_shm_create(mpu925x_shm_writer *writer, const char *name, uint32_t capacity, uint32_t sample_rate);
+void mpu925x_shm_publish(mpu925x_shm_writer *writer, mpu925x_t *mpu925x);
+void mpu925x_shm_destroy(mpu925x_shm_writer *writer);
+
+// Reader
+uint8_t mpu925x_shm_open(mpu925x_shm_reader *reader, const char *name);
+uint8_t mpu925x_shm_read_latest(mpu925x_shm_reader *reader, mpu925x_shm_sample *sample);
+uint8_t mpu925x_shm_read_next(mpu925x_shm_reader *reader, mpu925x_shm_sample *sample);
+void mpu925x_shm_close(mpu925x_shm_reader *reader);
+
+// Time
+uint64_t mpu925x_shm_now(void);
+
+#endif // __MPU925X_SHM_H
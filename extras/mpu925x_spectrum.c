@@ -0,0 +1,254 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Spectrum analysis source file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_spectrum.h"
+#include <math.h>
+#include <string.h>
+
+#define PI 3.14159265358979f
+
+/*******************************************************************************
+ * FFT
+ ******************************************************************************/
+
+// In place radix-2 complex FFT of interleaved real and imaginary parts.
+static void fft_complex(float *data, uint16_t size)
+{
+	// Bit reversal permutation.
+	for (uint16_t i = 1, j = 0; i < size; i++) {
+		uint16_t bit = size >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j |= bit;
+		if (i < j) {
+			float re = data[2 * i], im = data[2 * i + 1];
+			data[2 * i] = data[2 * j];
+			data[2 * i + 1] = data[2 * j + 1];
+			data[2 * j] = re;
+			data[2 * j + 1] = im;
+		}
+	}
+
+	// Twiddle factors are rotated with a recurrence, so no table is needed.
+	for (uint16_t length = 2; length <= size; length <<= 1) {
+		float theta = -2 * PI / length;
+		float half = sinf(theta / 2);
+		float wpr = -2 * half * half, wpi = sinf(theta);
+		float wr = 1, wi = 0;
+
+		for (uint16_t j = 0; j < length / 2; j++) {
+			for (uint16_t i = j; i < size; i += length) {
+				uint16_t k = i + length / 2;
+				float tr = wr * data[2 * k] - wi * data[2 * k + 1];
+				float ti = wr * data[2 * k + 1] + wi * data[2 * k];
+				data[2 * k] = data[2 * i] - tr;
+				data[2 * k + 1] = data[2 * i + 1] - ti;
+				data[2 * i] += tr;
+				data[2 * i + 1] += ti;
+			}
+			float temporary = wr;
+			wr += wr * wpr - wi * wpi;
+			wi += wi * wpr + temporary * wpi;
+		}
+	}
+}
+
+/**
+ * @brief In place FFT of real data.
+ * 
+ * Data is transformed as a half size complex FFT and then split, so no extra
+ * memory is used. Output is packed: ``data[0]`` is DC, ``data[1]`` is Nyquist
+ * bin, ``data[2k]`` and ``data[2k + 1]`` are real and imaginary parts of bin
+ * k for k from 1 to size / 2 - 1.
+ * @param data Real samples, replaced with spectrum.
+ * @param size Sample count, power of 2 and at least 4.
+ * @returns 0 on success, 1 if size is invalid.
+ * */
+uint8_t mpu925x_fft_real(float *data, uint16_t size)
+{
+	uint16_t half = size / 2;
+
+	if (size < 4 || (size & (size - 1)))
+		return 1;
+
+	fft_complex(data, half);
+
+	// Even and odd sample spectra are separated and combined.
+	float dc = data[0], nyquist = data[1];
+	data[0] = dc + nyquist;
+	data[1] = dc - nyquist;
+
+	float theta = -2 * PI / size;
+	float sine = sinf(theta / 2);
+	float wpr = -2 * sine * sine, wpi = sinf(theta);
+	float wr = 1 + wpr, wi = wpi;
+
+	for (uint16_t k = 1; k <= half / 2; k++) {
+		uint16_t m = half - k;
+		float zr = data[2 * k], zi = data[2 * k + 1];
+		float yr = data[2 * m], yi = data[2 * m + 1];
+
+		// Even part (z + conj(y)) / 2 and odd part (z - conj(y)) / 2i.
+		float er = (zr + yr) / 2, ei = (zi - yi) / 2;
+		float or = (zi + yi) / 2, oi = -(zr - yr) / 2;
+
+		// X[k] = E + W * O and X[m] = conj(E - W * O).
+		float tr = wr * or - wi * oi, ti = wr * oi + wi * or;
+		data[2 * k] = er + tr;
+		data[2 * k + 1] = ei + ti;
+		data[2 * m] = er - tr;
+		data[2 * m + 1] = -(ei - ti);
+
+		float temporary = wr;
+		wr += wr * wpr - wi * wpi;
+		wi += wi * wpr + temporary * wpi;
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ * Welch
+ ******************************************************************************/
+
+/**
+ * @brief Initialize Welch estimator.
+ * @param welch Welch struct pointer.
+ * @param buffer Segment buffer, ``segment_size * 3 / 2`` floats.
+ * @param psd Power spectral density, ``segment_size / 2 + 1`` floats.
+ * @param segment_size Segment size, power of 2 and at least 4.
+ * @param sample_rate Sample rate in Hz.
+ * @returns 0 on success, 1 if segment size is invalid.
+ * */
+uint8_t mpu925x_welch_init(mpu925x_welch *welch, float *buffer, float *psd, uint16_t segment_size, float sample_rate)
+{
+	if (segment_size < 4 || (segment_size & (segment_size - 1)))
+		return 1;
+
+	welch->buffer = buffer;
+	welch->psd = psd;
+	welch->segment_size = segment_size;
+	welch->sample_rate = sample_rate;
+	mpu925x_welch_reset(welch);
+
+	return 0;
+}
+
+/**
+ * @brief Clear collected samples and averaged spectrum.
+ * @param welch Welch struct pointer.
+ * */
+void mpu925x_welch_reset(mpu925x_welch *welch)
+{
+	welch->fill = 0;
+	welch->segments = 0;
+	memset(welch->psd, 0, (welch->segment_size / 2 + 1) * sizeof(float));
+}
+
+// Window, transform and average a full segment.
+static void process_segment(mpu925x_welch *welch)
+{
+	const uint16_t size = welch->segment_size;
+	float *segment = welch->buffer;
+	float *overlap = &welch->buffer[size];
+	float window_power = 0;
+
+	// Second half is the first half of next segment.
+	memcpy(overlap, &segment[size / 2], size / 2 * sizeof(float));
+
+	for (uint16_t n = 0; n < size; n++) {
+		float window = 0.5f - 0.5f * cosf(2 * PI * n / size);
+		segment[n] *= window;
+		window_power += window * window;
+	}
+
+	mpu925x_fft_real(segment, size);
+
+	// One-sided density, DC and Nyquist bins aren't doubled.
+	float scale = 1 / (welch->sample_rate * window_power);
+	float weight = 1.0f / ++welch->segments;
+	for (uint16_t k = 0; k <= size / 2; k++) {
+		float power;
+		if (k == 0)
+			power = segment[0] * segment[0] * scale;
+		else if (k == size / 2)
+			power = segment[1] * segment[1] * scale;
+		else
+			power = 2 * (segment[2 * k] * segment[2 * k] + segment[2 * k + 1] * segment[2 * k + 1]) * scale;
+		welch->psd[k] += (power - welch->psd[k]) * weight;
+	}
+
+	memcpy(segment, overlap, size / 2 * sizeof(float));
+	welch->fill = size / 2;
+}
+
+/**
+ * @brief Add samples to estimator.
+ * 
+ * ``stride`` selects a channel of interleaved data, e.g. z axis of
+ * ``float samples[n][3]`` is ``&samples[0][2]`` with stride 3.
+ * @param welch Welch struct pointer.
+ * @param samples Samples.
+ * @param count Sample count.
+ * @param stride Distance between samples in floats.
+ * @returns Count of segments completed by these samples.
+ * */
+uint16_t mpu925x_welch_push(mpu925x_welch *welch, const float *samples, uint16_t count, uint8_t stride)
+{
+	uint16_t completed = 0;
+
+	for (uint16_t n = 0; n < count; n++) {
+		welch->buffer[welch->fill++] = samples[n * stride];
+		if (welch->fill == welch->segment_size) {
+			process_segment(welch);
+			completed++;
+		}
+	}
+
+	return completed;
+}
+
+/**
+ * @brief Integrate averaged spectrum over a frequency band.
+ * @param welch Welch struct pointer.
+ * @param low Lower band edge in Hz.
+ * @param high Upper band edge in Hz.
+ * @returns Power in band (units^2), its square root is RMS of band.
+ * */
+float mpu925x_welch_band_power(const mpu925x_welch *welch, float low, float high)
+{
+	float resolution = welch->sample_rate / welch->segment_size;
+	float power = 0;
+
+	for (uint16_t k = 0; k <= welch->segment_size / 2; k++) {
+		float frequency = k * resolution;
+		if (frequency >= low && frequency <= high)
+			power += welch->psd[k];
+	}
+
+	return power * resolution;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Spectrum analysis header file for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#ifndef __MPU925X_SPECTRUM_H
+#define __MPU925X_SPECTRUM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Welch power spectral density estimator.
+ * 
+ * Samples are collected in Hann windowed segments with 50% overlap, each
+ * segment is transformed in place and its one-sided power spectral density
+ * (units^2/Hz) is averaged into ``psd``. Buffers are owned by user:
+ * - ``buffer``: ``segment_size * 3 / 2`` floats, segment and overlap.
+ * - ``psd``: ``segment_size / 2 + 1`` floats, bin k is at
+ *   ``k * sample_rate / segment_size`` Hz.
+ * */
+typedef struct mpu925x_welch {
+	// Configuration
+	float *buffer;
+	float *psd;
+	uint16_t segment_size;
+	float sample_rate;
+
+	// State
+	uint16_t fill;
+	uint32_t segments;
+} mpu925x_welch;
+
+uint8_t mpu925x_fft_real(float *data, uint16_t size);
+uint8_t mpu925x_welch_init(mpu925x_welch *welch, float *buffer, float *psd, uint16_t segment_size, float sample_rate);
+void mpu925x_welch_reset(mpu925x_welch *welch);
+uint16_t mpu925x_welch_push(mpu925x_welch *welch, const float *samples, uint16_t count, uint8_t stride);
+float mpu925x_welch_band_power(const mpu925x_welch *welch, float low, float high);
+
+#endif // __MPU925X_SPECTRUM_H
@@ -77,6 +77,48 @@ typedef enum mpu925x_gyroscope_scale {
 	mpu925x_2000dps
 } mpu925x_gyroscope_scale;
 
+/**
+ * @enum mpu925x_wake_on_motion_rate
+ * @brief Accelerometer wake-up rates in wake-on-motion mode.
+ * */
+typedef enum mpu925x_wake_on_motion_rate {
+	mpu925x_wake_on_motion_0_24_hz = 0,
+	mpu925x_wake_on_motion_0_49_hz,
+	mpu925x_wake_on_motion_0_98_hz,
+	mpu925x_wake_on_motion_1_95_hz,
+	mpu925x_wake_on_motion_3_91_hz,
+	mpu925x_wake_on_motion_7_81_hz,
+	mpu925x_wake_on_motion_15_63_hz,
+	mpu925x_wake_on_motion_31_25_hz,
+	mpu925x_wake_on_motion_62_5_hz,
+	mpu925x_wake_on_motion_125_hz,
+	mpu925x_wake_on_motion_250_hz,
+	mpu925x_wake_on_motion_500_hz
+} mpu925x_wake_on_motion_rate;
+
+/**
+ * @enum mpu925x_fsync
+ * @brief Output whose least significant bit latches FSYNC pin.
+ * */
+typedef enum mpu925x_fsync {
+	mpu925x_fsync_disabled = 0,
+	mpu925x_fsync_temperature,
+	mpu925x_fsync_gyroscope_x,
+	mpu925x_fsync_gyroscope_y,
+	mpu925x_fsync_gyroscope_z,
+	mpu925x_fsync_accelerometer_x,
+	mpu925x_fsync_accelerometer_y,
+	mpu925x_fsync_accelerometer_z
+} mpu925x_fsync;
+
+/**
+ * @brief Interrupt flags returned by ``mpu925x_get_interrupt_status``.
+ * */
+#define MPU925X_INTERRUPT_WAKE_ON_MOTION 0x40
+#define MPU925X_INTERRUPT_FIFO_OVERFLOW  0x10
+#define MPU925X_INTERRUPT_FSYNC          0x08
+#define MPU925X_INTERRUPT_RAW_DATA_READY 0x01
+
 /**
  * @enum mpu925x_magnetometer_measurement_mode
  * Measurement modes for AK8963.
@@ -88,9 +130,83 @@ typedef enum mpu925x_magnetometer_measurement_mode {
 	mpu925x_continuous_measurement_mode_2,
 	mpu925x_external_trigger_measurement_mode,
 	mpu925x_self_test_mode,
-	mpu925x_fuse_rom_access_mode
+	mpu925x_fuse_rom_access_mode,
+	mpu925x_pipelined_measurement_mode
 } mpu925x_magnetometer_measurement_mode;
 
+/**
+ * @brief Magnetometer status flags in ``sensor_data.magnetometer_status``.
+ * 
+ * ``MPU925X_MAGNETOMETER_READY``: New data was read.
+ * ``MPU925X_MAGNETOMETER_OVERRUN``: At least one measurement was skipped
+ * before this read (continuous modes).
+ * ``MPU925X_MAGNETOMETER_OVERFLOW``: Magnetic sensor overflowed, data is
+ * discarded.
+ * */
+#define MPU925X_MAGNETOMETER_READY    0x01
+#define MPU925X_MAGNETOMETER_OVERRUN  0x02
+#define MPU925X_MAGNETOMETER_OVERFLOW 0x08
+
+/**
+ * @brief Refreshed channel flags in ``sensor_data.refreshed``.
+ * 
+ * Set flags show which channels got new data in last ``mpu925x_get_all``,
+ * ``mpu925x_get_all_raw`` or ``mpu925x_scheduler_get_all`` call, other
+ * channels hold their previous values.
+ * */
+#define MPU925X_REFRESHED_ACCELEROMETER 0x01
+#define MPU925X_REFRESHED_GYROSCOPE     0x02
+#define MPU925X_REFRESHED_MAGNETOMETER  0x04
+#define MPU925X_REFRESHED_TEMPERATURE   0x08
+
+/**
+ * @brief Maximum bus transactions of hot-path functions.
+ * 
+ * Sensor data functions (``mpu925x_get_*`` and ``mpu925x_scheduler_get_all``)
+ * never call ``delay_ms`` and never make more bus transactions than these,
+ * whatever sensor state and settings are. Raw and converted variants have
+ * the same bound. In real-time profile (``settings.real_time``) magnetometer
+ * setters don't call ``delay_ms`` either. Health monitoring has no bus
+ * transactions, automatic range control adds up to
+ * ``MPU925X_TRANSACTIONS_AUTO_RANGE`` to the sample where range changes (and
+ * one FIFO count read per change while FIFO capture runs).
+ * */
+#define MPU925X_TRANSACTIONS_ACCELERATION   1
+#define MPU925X_TRANSACTIONS_ROTATION       1
+#define MPU925X_TRANSACTIONS_TEMPERATURE    1
+#define MPU925X_TRANSACTIONS_MAGNETIC_FIELD 2
+#define MPU925X_TRANSACTIONS_GET_ALL        5
+#define MPU925X_TRANSACTIONS_SCHEDULER      3
+#define MPU925X_TRANSACTIONS_MAGNETOMETER_SETTER 2
+#define MPU925X_TRANSACTIONS_AUTO_RANGE     2
+
+/**
+ * @brief Maximum pending full-scale range changes in FIFO.
+ * */
+#define MPU925X_FIFO_SPLITS 4
+
+/**
+ * @brief Health flags in ``health.flags`` and ``health.latched``.
+ * 
+ * ``MPU925X_HEALTH_ACCELEROMETER_SATURATED``: An acceleration axis is at the
+ * limit of current full-scale range.
+ * ``MPU925X_HEALTH_GYROSCOPE_SATURATED``: A rotation axis is at the limit of
+ * current full-scale range.
+ * ``MPU925X_HEALTH_STUCK``: Accelerometer, temperature and gyroscope frame
+ * didn't change for ``stuck_limit`` samples.
+ * ``MPU925X_HEALTH_MAGNETOMETER_OVERFLOW``: Magnetometer reported sensor
+ * overflow (ST2 HOFL).
+ * ``MPU925X_HEALTH_IDENTITY``: Every output byte reads 0xFF (sensor is
+ * disconnected), or WHO_AM_I / WIA changed since initialization.
+ * ``MPU925X_HEALTH_TEMPERATURE``: Die temperature is out of configured range.
+ * */
+#define MPU925X_HEALTH_ACCELEROMETER_SATURATED 0x01
+#define MPU925X_HEALTH_GYROSCOPE_SATURATED     0x02
+#define MPU925X_HEALTH_STUCK                   0x04
+#define MPU925X_HEALTH_MAGNETOMETER_OVERFLOW   0x08
+#define MPU925X_HEALTH_IDENTITY                0x10
+#define MPU925X_HEALTH_TEMPERATURE             0x20
+
 /**
  * @enum mpu925x_magnetometer_bit_mode
  * Bit modes for AK8963.
@@ -100,6 +216,11 @@ typedef enum mpu925x_magnetometer_bit_mode {
 	mpu925x_16_bit
 } mpu925x_magnetometer_bit_mode;
 
+/**
+ * @brief Size of EXT_SENS_DATA registers.
+ * */
+#define MPU925X_EXTERNAL_DATA_SIZE 24
+
 /**
  * @struct mpu925x_t mpu925x.h mpu925x.h
  * @brief Main struct for MPU-925X driver.
@@ -111,10 +232,25 @@ typedef struct mpu925x_t {
 	/**
 	 * @struct sensor_data
 	 * @brief Holds sensor data.
+	 * 
+	 * ``accelerometer_scale`` and ``gyroscope_scale`` tag raw data with the
+	 * full-scale range it was read under, conversion uses tags instead of
+	 * current settings. ``external_data`` is a copy of EXT_SENS_DATA
+	 * registers, it is read while auxiliary I2C master is enabled. ``fsync``
+	 * is latched FSYNC pin state of last sample read with ``mpu925x_get_all``,
+	 * ``mpu925x_get_all_raw`` or ``mpu925x_scheduler_get_all``, see
+	 * ``mpu925x_set_fsync``.
 	 * */
 	struct sensor_data {
 		int16_t acceleration_raw[3], rotation_raw[3], magnet_raw[3], temperature_raw;
 		float acceleration[3], rotation[3], magnetic_field[3], temperature;
+		uint64_t timestamp;
+		uint8_t magnetometer_status;
+		uint8_t refreshed;
+		mpu925x_accelerometer_scale accelerometer_scale;
+		mpu925x_gyroscope_scale gyroscope_scale;
+		uint8_t external_data[MPU925X_EXTERNAL_DATA_SIZE];
+		uint8_t fsync;
 	} sensor_data;
 
 	/**
@@ -129,23 +265,445 @@ typedef struct mpu925x_t {
 		mpu925x_magnetometer_bit_mode bit_mode;
 		float acceleration_lsb, gyroscope_lsb, magnetometer_lsb;
 		float magnetometer_coefficient[3];
+		float gyroscope_bias[3];
+		float accelerometer_bias[3];
+		float accelerometer_matrix[3][3];
+		uint8_t accelerometer_matrix_enabled;
+		float mounting_matrix[3][3];
+		uint8_t body_frame;
+		uint8_t gyroscope_config;
+		uint8_t accelerometer_config_2;
+		mpu925x_fsync fsync;
+		uint8_t real_time;
 		uint8_t address;
 	} settings;
 
+	/**
+	 * @struct conversion
+	 * @brief Holds published raw to output conversion parameters.
+	 * 
+	 * Matrices combine calibration, magnetometer sensitivity adjustment,
+	 * magnetometer axis alignment and mounting rotation, magnetometer scale
+	 * and bias values are copied from settings. Accelerometer and gyroscope
+	 * scales come from sample tags instead. There are two snapshots: setters
+	 * fill the inactive one and then increment ``version``, so conversion
+	 * functions never wait for a setter and never mix old and new values.
+	 * They are updated by setters and ``mpu925x_publish_settings``, don't
+	 * modify them directly.
+	 * */
+	struct conversion {
+		struct conversion_snapshot {
+			float accelerometer[3][3], gyroscope[3][3], magnetometer[3][3];
+			float magnetometer_lsb;
+			float accelerometer_bias[3], gyroscope_bias[3];
+		} snapshot[2];
+		volatile uint32_t version;
+	} conversion;
+
+	/**
+	 * @struct health
+	 * @brief Holds sensor health monitoring configuration and state.
+	 * 
+	 * If ``enabled`` is set, every ``mpu925x_get_all``,
+	 * ``mpu925x_get_all_raw`` and ``mpu925x_scheduler_get_all`` call checks
+	 * the new sample without extra bus transactions. ``flags`` holds flags of
+	 * last sample, ``latched`` accumulates them until user clears it, and each
+	 * flag has a counter of flagged samples. Zero ``stuck_limit`` selects
+	 * default (16 samples), equal temperature limits select -40 to 85 celsius
+	 * degree.
+	 * */
+	struct health {
+		// Configuration
+		uint8_t enabled;
+		uint16_t stuck_limit;
+		float temperature_minimum, temperature_maximum;
+
+		// State
+		uint8_t flags;
+		uint8_t latched;
+		uint32_t accelerometer_saturations, gyroscope_saturations;
+		uint32_t stuck_samples, magnetometer_overflows;
+		uint32_t identity_errors, temperature_errors;
+		uint16_t stuck_run;
+		int16_t previous[7];
+		uint8_t who_am_i;
+	} health;
+
+	/**
+	 * @struct auto_range
+	 * @brief Holds automatic full-scale range control configuration and state.
+	 * 
+	 * Controller runs after every ``mpu925x_get_all``, ``mpu925x_get_all_raw``
+	 * and ``mpu925x_scheduler_get_all`` call for enabled sensors. Range is
+	 * increased as soon as an axis exceeds ``up_threshold`` of full scale, and
+	 * decreased after ``hold`` consecutive samples which would stay below
+	 * ``down_threshold`` of the lower range's full scale. Zero configuration
+	 * values select defaults (0.9, 0.4 and 100 samples), ``down_threshold``
+	 * must be less than ``up_threshold``. A transition is a single register
+	 * write and only affects following samples.
+	 * */
+	struct auto_range {
+		// Configuration
+		uint8_t accelerometer, gyroscope;
+		float up_threshold, down_threshold;
+		uint16_t hold;
+
+		// State
+		uint16_t accelerometer_quiet, gyroscope_quiet;
+		uint32_t transitions;
+	} auto_range;
+
+	/**
+	 * @struct aux
+	 * @brief Holds auxiliary I2C master state.
+	 * 
+	 * Set by ``mpu925x_aux_enable`` and ``mpu925x_aux_slave_read``, don't
+	 * modify it directly. ``length`` is read length of each slave (slave 0 is
+	 * AK8963), ``position`` is position of its data in EXT_SENS_DATA
+	 * registers and ``sensor_data.external_data``, ``size`` is total length.
+	 * */
+	struct aux {
+		uint8_t enabled;
+		uint8_t divider;
+		uint8_t length[4];
+		uint8_t position[4];
+		uint8_t size;
+	} aux;
+
+	/**
+	 * @struct fifo
+	 * @brief Holds FIFO range split points.
+	 * 
+	 * Set by ``mpu925x_fifo_start`` and scale setters, don't modify it
+	 * directly. While FIFO capture runs, a scale change records FIFO count as
+	 * a split point: ``split[i]`` bytes at the head of FIFO were captured
+	 * under ``accelerometer_scale[i]`` and ``gyroscope_scale[i]``.
+	 * ``mpu925x_fifo_read_raw`` ends blocks at split points, so a block
+	 * never spans a range change. If more than ``MPU925X_FIFO_SPLITS``
+	 * changes are pending, ``dropped`` is set and next read discards FIFO as
+	 * after an overflow.
+	 * */
+	struct fifo {
+		uint8_t enabled;
+		uint8_t splits;
+		uint8_t dropped;
+		uint16_t split[MPU925X_FIFO_SPLITS];
+		mpu925x_accelerometer_scale accelerometer_scale[MPU925X_FIFO_SPLITS];
+		mpu925x_gyroscope_scale gyroscope_scale[MPU925X_FIFO_SPLITS];
+	} fifo;
+
 	/**
 	 * @struct master_specific
 	 * @brief Holds master specific pointers.
+	 * 
+	 * ``lock`` and ``unlock`` are optional, they are called around every bus
+	 * transaction, read-modify-write sequence and settings publication, so a
+	 * bus can be shared with other drivers and threads. They must allow
+	 * nested locking by the same thread (e.g. a recursive mutex).
 	 * */
 	struct master_specific {
 		uint8_t (*bus_read)(struct mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size);
 		uint8_t (*bus_write)(struct mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size);
 		void (*delay_ms)(struct mpu925x_t *mpu925x, uint32_t delay);
+		uint64_t (*get_time_us)(struct mpu925x_t *mpu925x);
+		void (*lock)(struct mpu925x_t *mpu925x);
+		void (*unlock)(struct mpu925x_t *mpu925x);
 		void *bus_handle;
 	} master_specific;
 } mpu925x_t;
 
+/**
+ * @struct mpu925x_gyroscope_bias_estimator mpu925x.h mpu925x.h
+ * @brief Streaming gyroscope bias estimator.
+ * 
+ * Estimator is fed with samples that are already read by the application, so
+ * it doesn't cause any extra bus traffic. Samples are grouped in windows of
+ * ``window`` samples. If sensor is still during whole window (low gyroscope
+ * variance and acceleration norm close to 1 g), window's mean rotation is
+ * blended into ``settings.gyroscope_bias``.
+ * 
+ * Configuration fields must be set by user, state fields must be zero
+ * initialized.
+ * */
+typedef struct mpu925x_gyroscope_bias_estimator {
+	// Configuration
+	uint16_t window;
+	float variance_threshold;
+	float acceleration_tolerance;
+	float gain;
+
+	// State
+	int16_t reference[3];
+	int32_t sum[3];
+	int64_t square_sum[3];
+	float gyroscope_lsb;
+	float mean[3];
+	uint16_t count;
+	uint8_t moving;
+	uint8_t still;
+	uint8_t converged;
+} mpu925x_gyroscope_bias_estimator;
+
+/**
+ * @struct mpu925x_accelerometer_calibration mpu925x.h mpu925x.h
+ * @brief Six-position accelerometer calibration data collector.
+ * 
+ * Samples are collected in six static poses, one for each
+ * ``mpu925x_orientation`` value. Pose names point to the axis which looks up,
+ * so ``mpu925x_x_plus`` pose measures +1 g on x axis.
+ * 
+ * ``sampling_amount`` must be set by user, state fields must be zero
+ * initialized.
+ * */
+typedef struct mpu925x_accelerometer_calibration {
+	// Configuration
+	uint16_t sampling_amount;
+
+	// State
+	int32_t sum[6][3];
+	uint16_t count[6];
+	float acceleration_lsb;
+} mpu925x_accelerometer_calibration;
+
+/**
+ * @struct mpu925x_temperature_compensation mpu925x.h mpu925x.h
+ * @brief Temperature dependent gyroscope bias model.
+ * 
+ * Bias of each axis is modeled as a polynomial of temperature (up to second
+ * order). Model is learned online from still periods with least squares, only
+ * running sums are stored so each update has constant cost. Polynomial order
+ * grows with covered temperature span, ``terms`` is the number of coefficients
+ * in use (0 until first observation, 3 for quadratic). ``bias`` is the model
+ * output last written to settings. ``forgetting`` (0 to 1) can be set to let
+ * old observations fade, other fields must be zero initialized.
+ * */
+typedef struct mpu925x_temperature_compensation {
+	// Configuration
+	float forgetting;
+
+	// State
+	float sum[5];
+	float bias_sum[3][3];
+	float minimum_temperature, maximum_temperature;
+	float coefficient[3][3];
+	float bias[3];
+	uint8_t terms;
+	uint8_t applied;
+} mpu925x_temperature_compensation;
+
+/**
+ * @struct mpu925x_scheduler mpu925x.h mpu925x.h
+ * @brief Multi-rate acquisition scheduler.
+ * 
+ * Accelerometer, temperature and gyroscope share output data rate and they
+ * are read in one burst on every call. Magnetometer is only read when a new
+ * measurement can exist, rate is derived from measurement mode. Fields are
+ * set by ``mpu925x_scheduler_init``.
+ * */
+typedef struct mpu925x_scheduler {
+	uint16_t magnetometer_divider;
+	uint16_t magnetometer_countdown;
+} mpu925x_scheduler;
+
+/**
+ * @struct mpu925x_self_test_result mpu925x.h mpu925x.h
+ * @brief Self-test result.
+ * 
+ * Responses are differences between self-test enabled and disabled outputs
+ * (dps, g and adjusted magnetometer LSB). Deviations are relative
+ * differences of gyroscope and accelerometer responses from factory
+ * self-test responses (0 means same as factory, -0.5 means half of it), they
+ * are 0 if factory value isn't programmed. Failed fields have a bit for each
+ * failed axis (bit 0 is x axis).
+ * */
+typedef struct mpu925x_self_test_result {
+	float gyroscope_offset[3];
+	float gyroscope_response[3];
+	float gyroscope_deviation[3];
+	float accelerometer_response[3];
+	float accelerometer_deviation[3];
+	int16_t magnetometer_response[3];
+	uint8_t gyroscope_failed;
+	uint8_t accelerometer_failed;
+	uint8_t magnetometer_failed;
+} mpu925x_self_test_result;
+
+/**
+ * @brief Sensors captured by ``mpu925x_fifo_start``, same as FIFO_EN bits
+ * and SLV_3_FIFO_EN bit of I2C_MST_CTRL.
+ * 
+ * Gyroscope axes can also be selected one by one (0x40 x, 0x20 y, 0x10 z).
+ * Auxiliary I2C slaves write their EXT_SENS_DATA bytes to FIFO if they are
+ * enabled in I2C_SLVx_CTRL.
+ * */
+#define MPU925X_FIFO_TEMPERATURE   0x80
+#define MPU925X_FIFO_GYROSCOPE     0x70
+#define MPU925X_FIFO_ACCELEROMETER 0x08
+#define MPU925X_FIFO_SLAVE_0       0x01
+#define MPU925X_FIFO_SLAVE_1       0x02
+#define MPU925X_FIFO_SLAVE_2       0x04
+#define MPU925X_FIFO_SLAVE_3       0x100
+
+/**
+ * @struct mpu925x_fifo_frame mpu925x.h mpu925x.h
+ * @brief Raw sample read from FIFO, fields of sensors not captured are 0.
+ * 
+ * ``external_data`` is a copy of EXT_SENS_DATA registers, bytes of each
+ * captured slave are at the same position as in registers.
+ * */
+typedef struct mpu925x_fifo_frame {
+	int16_t acceleration_raw[3];
+	int16_t temperature_raw;
+	int16_t rotation_raw[3];
+	uint8_t external_data[MPU925X_EXTERNAL_DATA_SIZE];
+} mpu925x_fifo_frame;
+
+/**
+ * @brief Offset of a value which is not in frame.
+ * */
+#define MPU925X_LAYOUT_ABSENT 0xFF
+
+/**
+ * @struct mpu925x_frame_layout mpu925x.h mpu925x.h
+ * @brief Byte layout of a raw frame.
+ * 
+ * Offsets are byte offsets of big endian values in frame, or
+ * ``MPU925X_LAYOUT_ABSENT``. Acceleration axes are contiguous. ``external``
+ * is offset of each slave's bytes in frame, ``external_size`` its length and
+ * ``external_position`` its position in EXT_SENS_DATA registers. Layout of
+ * register burst from ACCEL_XOUT_H to GYRO_ZOUT_L is
+ * ``mpu925x_register_layout``, FIFO layout is set by ``mpu925x_fifo_start``
+ * or ``mpu925x_frame_layout_init``.
+ * 
+ * Rest of fields are decoder table and fast path selection, they are set
+ * with layout.
+ * */
+typedef struct mpu925x_frame_layout {
+	uint8_t size;
+	uint8_t acceleration;
+	uint8_t temperature;
+	uint8_t rotation[3];
+	uint8_t external[4];
+	uint8_t external_size[4];
+	uint8_t external_position[4];
+
+	// Decoder
+	uint8_t path;
+	uint8_t word_count;
+	uint8_t word_offset[7];
+	uint8_t word_field[7];
+} mpu925x_frame_layout;
+
+extern const mpu925x_frame_layout mpu925x_register_layout;
+
+/**
+ * @brief Read a value of a raw frame in place.
+ * @param frame Raw frame bytes.
+ * @param offset Offset of value from frame layout.
+ * @returns Raw value.
+ * */
+static inline int16_t mpu925x_frame_value(const uint8_t *frame, uint8_t offset)
+{
+	return (int16_t)((frame[offset] << 8) | frame[offset + 1]);
+}
+
+/**
+ * @struct mpu925x_clock_sync mpu925x.h mpu925x.h
+ * @brief Maps sensor sample counts to host clock.
+ * 
+ * Set by ``mpu925x_clock_sync_init`` and ``mpu925x_clock_sync_update``, don't
+ * modify it directly. Time of ``reference_sample`` is ``reference_time``
+ * plus ``reference_fraction`` microseconds and ``period`` is estimated
+ * sample period in microseconds, both are fixed point with 24 fraction
+ * bits. ``jitter`` is mean absolute prediction error of updates in
+ * microseconds.
+ * */
+typedef struct mpu925x_clock_sync {
+	float nominal_period;
+	int64_t period;
+	uint64_t reference_time;
+	uint32_t reference_fraction;
+	uint32_t reference_sample;
+	float jitter;
+	uint32_t updates;
+} mpu925x_clock_sync;
+
+/**
+ * @struct mpu925x_fifo_block mpu925x.h mpu925x.h
+ * @brief Contiguous block of frames returned by ``mpu925x_fifo_read``.
+ * 
+ * ``sequence`` is index of first frame in captured stream and ``sample`` is
+ * its sample count, which also counts estimated lost samples. ``timestamp``
+ * is its estimated time in microseconds and ``period`` is estimated sample
+ * period in microseconds, following frames are one sample period apart (see
+ * ``mpu925x_fifo_timestamp``). If ``overflow`` is set, frames were lost
+ * between previous block and this one. Frames are tagged with full-scale
+ * ranges they were captured under, a block never spans a range change.
+ * */
+typedef struct mpu925x_fifo_block {
+	uint64_t timestamp;
+	float period;
+	uint32_t sequence;
+	uint32_t sample;
+	uint16_t count;
+	uint8_t overflow;
+	mpu925x_accelerometer_scale accelerometer_scale;
+	mpu925x_gyroscope_scale gyroscope_scale;
+} mpu925x_fifo_block;
+
+/**
+ * @brief Get estimated time of a frame in a block.
+ * @param block Block information.
+ * @param index Index of frame in block.
+ * @returns Time in microseconds.
+ * */
+static inline uint64_t mpu925x_fifo_timestamp(const mpu925x_fifo_block *block, uint16_t index)
+{
+	return block->timestamp + (uint64_t)(index * block->period + 0.5f);
+}
+
+/**
+ * @struct mpu925x_fifo_capture mpu925x.h mpu925x.h
+ * @brief FIFO capture state, set by ``mpu925x_fifo_start``.
+ * 
+ * ``clock`` maps sample counts to host clock, it is updated at every read.
+ * */
+typedef struct mpu925x_fifo_capture {
+	mpu925x_clock_sync clock;
+	uint32_t sequence;
+	uint32_t sample;
+	uint32_t overflows;
+	uint16_t sensors;
+	mpu925x_frame_layout layout;
+	uint8_t lost;
+} mpu925x_fifo_capture;
+
+/**
+ * @brief Failed sensor flags returned by ``mpu925x_self_test``.
+ * */
+#define MPU925X_SELF_TEST_GYROSCOPE     0x01
+#define MPU925X_SELF_TEST_ACCELEROMETER 0x02
+#define MPU925X_SELF_TEST_MAGNETOMETER  0x04
+
+/**
+ * @brief Returned by ``mpu925x_self_test`` if it isn't run because FIFO
+ * capture is running.
+ * */
+#define MPU925X_SELF_TEST_BUSY          0x08
+
+/**
+ * @brief Size of serialized temperature compensation model in bytes.
+ * */
+#define MPU925X_TEMPERATURE_COMPENSATION_SIZE 68
+
+/**
+ * @brief Size of serialized calibration in bytes.
+ * */
+#define MPU925X_CALIBRATION_SIZE 118
+
 // Core
 uint8_t mpu925x_init(mpu925x_t *mpu925x, uint8_t ad0);
+uint8_t mpu925x_warm_init(mpu925x_t *mpu925x, uint8_t ad0, const uint8_t *calibration, uint16_t size);
 
 // Sensor data
 void mpu925x_get_all_raw(mpu925x_t *mpu925x);
@@ -158,10 +716,20 @@ void mpu925x_get_magnetic_field_raw(mpu925x_t *mpu925x);
 void mpu925x_get_magnetic_field(mpu925x_t *mpu925x);
 void mpu925x_get_temperature_raw(mpu925x_t *mpu925x);
 void mpu925x_get_temperature(mpu925x_t *mpu925x);
+void mpu925x_scheduler_init(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler, uint16_t sample_rate);
+void mpu925x_scheduler_get_all(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler);
+uint8_t mpu925x_health_check_identity(mpu925x_t *mpu925x);
 
 // General settings
 void mpu925x_set_sample_rate_divider(mpu925x_t *mpu925x, uint8_t sample_rate_divider);
 void mpu925x_set_clock_source(mpu925x_t *mpu925x, mpu925x_clock clock);
+void mpu925x_set_mounting_matrix(mpu925x_t *mpu925x, float matrix[3][3]);
+void mpu925x_publish_settings(mpu925x_t *mpu925x);
+void mpu925x_wake_on_motion_enable(mpu925x_t *mpu925x, float threshold, mpu925x_wake_on_motion_rate rate);
+void mpu925x_wake_on_motion_disable(mpu925x_t *mpu925x);
+uint8_t mpu925x_get_interrupt_status(mpu925x_t *mpu925x);
+void mpu925x_set_fsync(mpu925x_t *mpu925x, mpu925x_fsync fsync, uint8_t active_low, uint8_t interrupt);
+uint8_t mpu925x_fsync_flag(mpu925x_fsync fsync, const int16_t *acceleration_raw, int16_t temperature_raw, const int16_t *rotation_raw);
 
 // Accelerometer settings
 void mpu925x_set_accelerometer_scale(mpu925x_t *mpu925x, mpu925x_accelerometer_scale scale);
@@ -169,6 +737,7 @@ void mpu925x_set_accelerometer_dlpf(mpu925x_t *mpu925x, uint8_t a_fchoice, uint8
 void mpu925x_accelerometer_offset_cancellation(mpu925x_t *mpu925x, uint16_t sampling_amount);
 void mpu925x_get_accelerometer_offset(mpu925x_t *mpu925x, uint16_t sampling_amount, int16_t *offset);
 void mpu925x_set_accelerometer_offset(mpu925x_t *mpu925x, int16_t *offset);
+void mpu925x_set_accelerometer_matrix(mpu925x_t *mpu925x, float matrix[3][3]);
 
 // Gyroscope settings
 void mpu925x_set_gyroscope_scale(mpu925x_t *mpu925x, mpu925x_gyroscope_scale scale);
@@ -178,9 +747,48 @@ void mpu925x_get_gyroscope_offset(mpu925x_t *mpu925x, uint16_t sampling_amount,
 void mpu925x_set_gyroscope_offset(mpu925x_t *mpu925x, int16_t *offset);
 
 // Magnetometer settings
-void mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_measurement_mode measurement_mode);
+uint8_t mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_measurement_mode measurement_mode);
 void mpu925x_set_magnetometer_bit_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_bit_mode bit_mode);
 
+// Auxiliary I2C master
+uint8_t mpu925x_aux_enable(mpu925x_t *mpu925x, uint8_t rate_divider);
+void mpu925x_aux_disable(mpu925x_t *mpu925x);
+uint8_t mpu925x_aux_slave_read(mpu925x_t *mpu925x, uint8_t slave, uint8_t address, uint8_t reg, uint8_t length, uint8_t divided);
+uint8_t mpu925x_aux_read(mpu925x_t *mpu925x, uint8_t address, uint8_t reg, uint8_t *value);
+uint8_t mpu925x_aux_write(mpu925x_t *mpu925x, uint8_t address, uint8_t reg, uint8_t value);
+
+// Calibration
+uint8_t mpu925x_gyroscope_bias_update(mpu925x_t *mpu925x, mpu925x_gyroscope_bias_estimator *estimator);
+void mpu925x_gyroscope_bias_commit(mpu925x_t *mpu925x);
+uint8_t mpu925x_accelerometer_calibration_update(mpu925x_t *mpu925x, mpu925x_accelerometer_calibration *calibration, mpu925x_orientation pose);
+uint8_t mpu925x_accelerometer_calibration_solve(mpu925x_t *mpu925x, mpu925x_accelerometer_calibration *calibration);
+void mpu925x_accelerometer_bias_commit(mpu925x_t *mpu925x);
+void mpu925x_temperature_compensation_learn(mpu925x_temperature_compensation *compensation, float temperature, float *bias);
+void mpu925x_temperature_compensation_apply(mpu925x_t *mpu925x, mpu925x_temperature_compensation *compensation);
+uint16_t mpu925x_temperature_compensation_export(mpu925x_temperature_compensation *compensation, uint8_t *buffer, uint16_t size);
+uint8_t mpu925x_temperature_compensation_import(mpu925x_temperature_compensation *compensation, const uint8_t *buffer, uint16_t size);
+uint16_t mpu925x_calibration_export(mpu925x_t *mpu925x, uint8_t *buffer, uint16_t size);
+uint8_t mpu925x_calibration_import(mpu925x_t *mpu925x, const uint8_t *buffer, uint16_t size);
+
+// Self-test
+uint8_t mpu925x_self_test(mpu925x_t *mpu925x, mpu925x_self_test_result *result);
+
+// FIFO capture
+uint8_t mpu925x_fifo_start(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, uint16_t sensors, float sample_rate);
+uint16_t mpu925x_fifo_read(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, mpu925x_fifo_frame *frames, uint16_t size, mpu925x_fifo_block *block);
+uint16_t mpu925x_fifo_read_raw(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, uint8_t *buffer, uint16_t size, mpu925x_fifo_block *block);
+void mpu925x_frame_layout_init(mpu925x_frame_layout *layout, uint16_t sensors, const uint8_t *slave_control);
+void mpu925x_frame_decode(const mpu925x_frame_layout *layout, const uint8_t *data, uint16_t count, mpu925x_fifo_frame *frames);
+void mpu925x_fifo_stop(mpu925x_t *mpu925x);
+
+// Host clock synchronization
+void mpu925x_clock_sync_init(mpu925x_clock_sync *sync, float sample_rate);
+void mpu925x_clock_sync_update(mpu925x_clock_sync *sync, uint32_t sample, uint64_t time);
+uint64_t mpu925x_clock_sync_time(const mpu925x_clock_sync *sync, uint32_t sample);
+uint32_t mpu925x_clock_sync_sample(const mpu925x_clock_sync *sync, uint64_t time);
+float mpu925x_clock_sync_period(const mpu925x_clock_sync *sync);
+float mpu925x_clock_sync_drift(const mpu925x_clock_sync *sync);
+
 // C++ compatibility.
 #ifdef __cplusplus
 }
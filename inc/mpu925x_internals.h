@@ -35,18 +35,47 @@ extern "C" {
 
 // Internal functions
 uint8_t __mpu925x_init(mpu925x_t *mpu925x);
-uint8_t __ak8963_init(mpu925x_t *mpu925x);
+uint8_t __ak8963_init(mpu925x_t *mpu925x, uint8_t warm);
 
 void mpu925x_reset(mpu925x_t *mpu925x);
 void ak8963_reset(mpu925x_t *mpu925x);
 
 void mpu925x_get_accelerometer_bias(mpu925x_t *mpu925x, int16_t *bias);
+void mpu925x_update_conversion(mpu925x_t *mpu925x);
+const struct conversion_snapshot *mpu925x_conversion_acquire(mpu925x_t *mpu925x, uint32_t *version);
+uint8_t mpu925x_conversion_changed(mpu925x_t *mpu925x, uint32_t version);
 
+void mpu925x_lock(mpu925x_t *mpu925x);
+void mpu925x_unlock(mpu925x_t *mpu925x);
+uint8_t mpu925x_bus_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size);
+uint8_t mpu925x_bus_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size);
 void mpu925x_bus_write_preserve(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size, uint8_t and_sentence);
+uint8_t mpu925x_aux_ak8963_read(mpu925x_t *mpu925x, uint8_t reg, uint8_t *buffer, uint8_t size);
+uint8_t mpu925x_aux_ak8963_write(mpu925x_t *mpu925x, uint8_t reg, uint8_t *buffer, uint8_t size);
+uint8_t mpu925x_aux_measurement_mode_allowed(mpu925x_magnetometer_measurement_mode measurement_mode);
+
+void mpu925x_health_update(mpu925x_t *mpu925x, uint8_t magnetometer);
+void mpu925x_auto_range_update(mpu925x_t *mpu925x);
+void mpu925x_fifo_split(mpu925x_t *mpu925x);
+
+extern const float mpu925x_acceleration_lsb[4];
+extern const float mpu925x_gyroscope_lsb[4];
+
+uint16_t mpu925x_crc16(const uint8_t *data, uint16_t size);
+void mpu925x_pack_float(uint8_t *buffer, float value);
+float mpu925x_unpack_float(const uint8_t *buffer);
 
 #define convert8bitto16bit(x, y)   (((x) << 8) | (y))
 #define powerof2(x)                (1 << (x))
 
+// Full memory barrier for conversion snapshot publication. Compilers other
+// than GCC and Clang must provide an equivalent on multi-core targets.
+#if defined(__GNUC__)
+#define memory_barrier()           __sync_synchronize()
+#else
+#define memory_barrier()
+#endif
+
 // Slave addresses
 #define MPU925X_ADDRESS            0b1101000
 #define AK8963_ADDRESS             0x0C
@@ -63,13 +92,128 @@ void mpu925x_bus_write_preserve(mpu925x_t *mpu925x, uint8_t slave_address, uint8
 #define GYROSCOPE_SCALE_1000_DPS   32.8
 #define GYROSCOPE_SCALE_2000_DPS   16.4
 
+// Offset register lsb values (independent of full-scale range)
+#define ACCELEROMETER_OFFSET_SCALE ACCELEROMETER_SCALE_16G
+#define GYROSCOPE_OFFSET_SCALE     (GYROSCOPE_SCALE_250_DPS / 4)
+
 // Magnetometer lsb values
 #define MAGNETOMETER_SCALE_14_BIT  (4800.0 / 16383.0)
 #define MAGNETOMETER_SCALE_16_BIT  (4800.0 / INT16_MAX)
 
+// Magnetometer mode transition time (datasheet requires at least 100 us)
+#define MAGNETOMETER_MODE_DELAY_MS 1
+
+// Magnetometer output data rates in Hz (single measurement takes at most 9 ms)
+#define MAGNETOMETER_RATE_CONTINUOUS_1 8
+#define MAGNETOMETER_RATE_CONTINUOUS_2 100
+#define MAGNETOMETER_RATE_SINGLE   100
+
+// Magnetometer control register (CNTL1) values
+#define MAGNETOMETER_SINGLE_MEASUREMENT 0b0001
+#define MAGNETOMETER_16_BIT_OUTPUT (1 << 4)
+
 // Temperature lsb values
 #define TEMPERATURE_SCALE          333.87
 
+// Temperature compensation model normalization (t = (T - center) / span)
+#define TEMPERATURE_MODEL_CENTER   25.0
+#define TEMPERATURE_MODEL_SPAN     25.0
+#define TEMPERATURE_MODEL_LINEAR   2.0
+#define TEMPERATURE_MODEL_QUADRATIC 10.0
+#define TEMPERATURE_MODEL_EPSILON  0.001
+#define TEMPERATURE_MODEL_MAGIC    0x54
+#define TEMPERATURE_MODEL_VERSION  1
+
+// Health monitoring defaults (samples and celsius degree)
+#define HEALTH_STUCK_LIMIT         16
+#define HEALTH_TEMPERATURE_MINIMUM -40.0
+#define HEALTH_TEMPERATURE_MAXIMUM 85.0
+
+// Automatic range control defaults (fractions of full scale and samples)
+#define AUTO_RANGE_UP_THRESHOLD    0.9
+#define AUTO_RANGE_DOWN_THRESHOLD  0.4
+#define AUTO_RANGE_HOLD            100
+
+// GYRO_CONFIG fields
+#define GYRO_CONFIG_FS_SEL         (0b11 << 3)
+#define GYRO_CONFIG_FCHOICE_B      0b11
+
+// Wake-on-motion
+#define PWR_MGMT_1_CYCLE           (1 << 5)
+#define PWR_MGMT_2_DISABLE_GYRO    0b111
+#define WOM_ACCEL_CONFIG_2         1
+#define WOM_INT_ENABLE             (1 << 6)
+#define WOM_MOT_DETECT_CTRL        0xC0
+#define WOM_THRESHOLD_LSB          0.004
+
+// Calibration blob
+#define CALIBRATION_MAGIC          0x43
+#define CALIBRATION_VERSION        1
+#define CALIBRATION_MATRIX_ENABLED (1 << 0)
+#define CALIBRATION_BODY_FRAME     (1 << 1)
+
+// FIFO_EN and USER_CTRL bits
+#define FIFO_TEMP                  (1 << 7)
+#define FIFO_GYRO                  (0b111 << 4)
+#define FIFO_ACCEL                 (1 << 3)
+#define FIFO_SLAVES                0b111
+#define FIFO_SLAVE_3               (1 << 8)
+#define USER_CTRL_FIFO_EN          (1 << 6)
+#define USER_CTRL_I2C_MST_EN       (1 << 5)
+#define USER_CTRL_FIFO_RST         (1 << 2)
+#define FIFO_SIZE                  512
+
+// I2C_MST_CTRL and I2C_SLVx_CTRL bits
+#define I2C_MST_SLV_3_FIFO_EN      (1 << 5)
+#define I2C_SLV_EN                 (1 << 7)
+#define I2C_SLV_LENG               0x0F
+
+// Auxiliary I2C master
+#define I2C_MST_WAIT_FOR_ES        (1 << 6)
+#define I2C_MST_CLK_400_KHZ        13
+#define I2C_MST_DLY                0x1F
+#define I2C_MST_DELAY_ES_SHADOW    (1 << 7)
+#define I2C_SLV_READ               (1 << 7)
+#define I2C_SLV4_DONE              (1 << 6)
+#define I2C_SLV4_NACK              (1 << 4)
+#define INT_PIN_CFG_BYPASS_EN      (1 << 1)
+#define AUX_MAGNETOMETER_SIZE      8
+#define AUX_TRIES                  20
+
+// Frame synchronization
+#define CONFIG_EXT_SYNC_SET        (0b111 << 3)
+#define INT_PIN_CFG_ACTL_FSYNC     (1 << 3)
+#define INT_PIN_CFG_FSYNC_INT_MODE_EN (1 << 2)
+#define FSYNC_INT_EN               (1 << 3)
+
+// Host clock synchronization (fixed point fraction bits of a microsecond,
+// steady state phase gain and period limit as fraction of nominal period)
+#define CLOCK_SYNC_FRACTION_BITS   24
+#define CLOCK_SYNC_PHASE_GAIN      (1.0f / 32)
+#define CLOCK_SYNC_MAX_DRIFT       0.05f
+
+// Self-test procedure
+#define SELF_TEST_SAMPLES          200
+#define SELF_TEST_SETTLE_MS        20
+#define SELF_TEST_FIFO_FILL_MS     20
+#define SELF_TEST_FIFO_TRIES       20
+#define SELF_TEST_ENABLE           0xE0
+#define SELF_TEST_DLPF             2
+#define SELF_TEST_OTP_BASE         2620
+#define SELF_TEST_MAGNETOMETER_TRIES 20
+#define ASTC_SELF                  (1 << 6)
+
+// Self-test limits (gyroscope in dps, accelerometer in g, magnetometer in LSB)
+#define SELF_TEST_GYROSCOPE_RATIO  0.5
+#define SELF_TEST_GYROSCOPE_MINIMUM 60.0
+#define SELF_TEST_GYROSCOPE_OFFSET 20.0
+#define SELF_TEST_ACCELEROMETER_RATIO 0.5
+#define SELF_TEST_ACCELEROMETER_MINIMUM 0.225
+#define SELF_TEST_ACCELEROMETER_MAXIMUM 0.675
+#define SELF_TEST_MAGNETOMETER_XY_16_BIT 200
+#define SELF_TEST_MAGNETOMETER_Z_MINIMUM_16_BIT -3200
+#define SELF_TEST_MAGNETOMETER_Z_MAXIMUM_16_BIT -800
+
 // MPU-925X registers
 #define SELF_TEST_X_GYRO           0x00
 #define SELF_TEST_Y_GYRO           0x01
@@ -0,0 +1,306 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Auxiliary I2C master functions for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_internals.h"
+#include <stdint.h>
+
+/**
+ * @brief Update EXT_SENS_DATA positions of slaves.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void update_positions(mpu925x_t *mpu925x)
+{
+	mpu925x->aux.size = 0;
+	for (uint8_t i = 0; i < 4; i++) {
+		mpu925x->aux.position[i] = mpu925x->aux.size;
+		mpu925x->aux.size += mpu925x->aux.length[i];
+	}
+}
+
+/**
+ * @brief Run a single byte transfer with slave 4.
+ * 
+ * Transfer is done at next sample, I2C_MST_STATUS is polled every
+ * millisecond.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param address 7 bit slave address.
+ * @param reg Register of slave.
+ * @param value Byte to write, or read byte.
+ * @param read Read if not 0.
+ * @returns 0 on success, 1 on NACK or timeout.
+ * */
+static uint8_t aux_transfer(mpu925x_t *mpu925x, uint8_t address, uint8_t reg, uint8_t *value, uint8_t read)
+{
+	uint8_t buffer[4], status = 0;
+
+	// I2C_SLV4_ADDR, I2C_SLV4_REG, I2C_SLV4_DO and I2C_SLV4_CTRL.
+	buffer[0] = address | (read ? I2C_SLV_READ : 0);
+	buffer[1] = reg;
+	buffer[2] = *value;
+	buffer[3] = I2C_SLV_EN | mpu925x->aux.divider;
+
+	mpu925x_lock(mpu925x);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_SLV4_ADDR, buffer, 4);
+	for (uint8_t i = 0; i < AUX_TRIES; i++) {
+		mpu925x_bus_read(mpu925x, mpu925x->settings.address, I2C_MST_STATUS, &status, 1);
+		if (status & (I2C_SLV4_DONE | I2C_SLV4_NACK))
+			break;
+		mpu925x->master_specific.delay_ms(mpu925x, 1);
+	}
+	if (read && (status & I2C_SLV4_DONE))
+		mpu925x_bus_read(mpu925x, mpu925x->settings.address, I2C_SLV4_DI, value, 1);
+	mpu925x_unlock(mpu925x);
+
+	return (status & I2C_SLV4_DONE) && !(status & I2C_SLV4_NACK) ? 0 : 1;
+}
+
+/**
+ * @brief Read a register of an auxiliary I2C slave with slave 4.
+ * 
+ * Transfer takes a sample period, it is not for hot path.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param address 7 bit slave address.
+ * @param reg Register of slave.
+ * @param value Read byte.
+ * @returns 0 on success, 1 on NACK or timeout.
+ * */
+uint8_t mpu925x_aux_read(mpu925x_t *mpu925x, uint8_t address, uint8_t reg, uint8_t *value)
+{
+	*value = 0;
+
+	return aux_transfer(mpu925x, address, reg, value, 1);
+}
+
+/**
+ * @brief Write a register of an auxiliary I2C slave with slave 4.
+ * 
+ * Transfer takes a sample period, it is not for hot path.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param address 7 bit slave address.
+ * @param reg Register of slave.
+ * @param value Byte to write.
+ * @returns 0 on success, 1 on NACK or timeout.
+ * */
+uint8_t mpu925x_aux_write(mpu925x_t *mpu925x, uint8_t address, uint8_t reg, uint8_t value)
+{
+	return aux_transfer(mpu925x, address, reg, &value, 0);
+}
+
+/**
+ * @brief Read AK8963 registers while auxiliary I2C master is enabled.
+ * 
+ * Registers from ST1 to ST2 are read by slave 0 at every sample, they are
+ * served from EXT_SENS_DATA in one transaction. Other registers are read one
+ * by one with slave 4.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param reg Start register.
+ * @param buffer Data buffer.
+ * @param size Data buffer size.
+ * @returns 0 on success, 1 on failure.
+ * */
+uint8_t mpu925x_aux_ak8963_read(mpu925x_t *mpu925x, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	uint8_t return_value = 0;
+
+	if (reg >= ST1 && reg + size <= ST1 + AUX_MAGNETOMETER_SIZE)
+		return mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, EXT_SENS_DATA_00 + reg - ST1, buffer, size);
+
+	for (uint8_t i = 0; i < size; i++) {
+		return_value |= mpu925x_aux_read(mpu925x, AK8963_ADDRESS, reg + i, &buffer[i]);
+	}
+
+	return return_value;
+}
+
+/**
+ * @brief Write AK8963 registers with slave 4.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param reg Start register.
+ * @param buffer Data buffer.
+ * @param size Data buffer size.
+ * @returns 0 on success, 1 on failure.
+ * */
+uint8_t mpu925x_aux_ak8963_write(mpu925x_t *mpu925x, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	uint8_t return_value = 0;
+
+	for (uint8_t i = 0; i < size; i++) {
+		return_value |= mpu925x_aux_write(mpu925x, AK8963_ADDRESS, reg + i, buffer[i]);
+	}
+
+	return return_value;
+}
+
+/**
+ * @brief Check if a magnetometer measurement mode can be used with auxiliary
+ * I2C master.
+ * 
+ * Slave 0 reads ST1 to ST2 at every sample, which clears data ready, and
+ * AK8963 is only writable through slave 4, which waits for a sample. Modes
+ * which need a trigger for every measurement can't work in read path, so
+ * only continuous modes (and power down, self-test and fuse ROM access modes
+ * of driver procedures) are allowed.
+ * @param measurement_mode Magnetometer measurement mode.
+ * @returns 1 if mode is allowed, 0 if not.
+ * */
+uint8_t mpu925x_aux_measurement_mode_allowed(mpu925x_magnetometer_measurement_mode measurement_mode)
+{
+	switch (measurement_mode) {
+		case mpu925x_single_measurement_mode:
+		case mpu925x_pipelined_measurement_mode:
+		case mpu925x_external_trigger_measurement_mode:
+			return 0;
+		default:
+			return 1;
+	}
+}
+
+/**
+ * @brief Enable auxiliary I2C master.
+ * 
+ * Bypass is disabled, so AK8963 is only reachable through the master: slave
+ * 0 reads AK8963 data at every sample and other AK8963 accesses of the
+ * driver go through slave 4. ``mpu925x_get_all``, ``mpu925x_get_all_raw``
+ * and ``mpu925x_scheduler_get_all`` read sensors, magnetometer and slave data
+ * in one burst. Slaves with ``divided`` set are read every
+ * ``rate_divider + 1`` samples. Must be called after ``mpu925x_init``,
+ * with a continuous magnetometer measurement mode.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param rate_divider Rate divider of divided slaves, 0 to 31.
+ * @returns 0 on success, 1 if magnetometer measurement mode needs a trigger
+ * (nothing is changed) or AK8963 doesn't respond through master (master is
+ * disabled again).
+ * */
+uint8_t mpu925x_aux_enable(mpu925x_t *mpu925x, uint8_t rate_divider)
+{
+	uint8_t buffer[12] = {0}, wia;
+
+	if (!mpu925x_aux_measurement_mode_allowed(mpu925x->settings.measurement_mode))
+		return 1;
+
+	mpu925x_lock(mpu925x);
+
+	mpu925x->aux.divider = rate_divider & I2C_MST_DLY;
+	mpu925x->aux.length[0] = AUX_MAGNETOMETER_SIZE;
+	for (uint8_t i = 1; i < 4; i++) {
+		mpu925x->aux.length[i] = 0;
+	}
+	update_positions(mpu925x);
+
+	// Disable bypass, AK8963 is on auxiliary bus now.
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, INT_PIN_CFG, buffer, 1, (uint8_t)~INT_PIN_CFG_BYPASS_EN);
+
+	// 400 kHz, data ready interrupt waits for slave data.
+	buffer[0] = I2C_MST_WAIT_FOR_ES | I2C_MST_CLK_400_KHZ;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, I2C_MST_CTRL, buffer, 1, I2C_MST_SLV_3_FIFO_EN);
+
+	// Slave 0 reads ST1 to ST2 of AK8963, slaves 1 to 3 are disabled.
+	buffer[0] = AK8963_ADDRESS | I2C_SLV_READ;
+	buffer[1] = ST1;
+	buffer[2] = I2C_SLV_EN | AUX_MAGNETOMETER_SIZE;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_SLV0_ADDR, buffer, sizeof(buffer));
+	buffer[0] = mpu925x->aux.divider;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_SLV4_CTRL, buffer, 1);
+
+	// Slave data is shadowed after all slaves are read.
+	buffer[0] = I2C_MST_DELAY_ES_SHADOW;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_MST_DELAY_CTRL, buffer, 1);
+
+	buffer[0] = USER_CTRL_I2C_MST_EN;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1, 0xFF);
+	mpu925x->aux.enabled = 1;
+
+	if (mpu925x_aux_read(mpu925x, AK8963_ADDRESS, WIA, &wia) != 0 || wia != 0x48) {
+		mpu925x_aux_disable(mpu925x);
+		mpu925x_unlock(mpu925x);
+		return 1;
+	}
+
+	mpu925x_unlock(mpu925x);
+
+	return 0;
+}
+
+/**
+ * @brief Disable auxiliary I2C master, AK8963 is accessed in bypass mode
+ * again.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_aux_disable(mpu925x_t *mpu925x)
+{
+	uint8_t buffer[12] = {0};
+
+	mpu925x_lock(mpu925x);
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1, (uint8_t)~USER_CTRL_I2C_MST_EN);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_SLV0_ADDR, buffer, sizeof(buffer));
+	buffer[0] = INT_PIN_CFG_BYPASS_EN;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, INT_PIN_CFG, buffer, 1, 0xFF);
+	mpu925x->aux.enabled = 0;
+	mpu925x->aux.size = 0;
+	mpu925x_unlock(mpu925x);
+}
+
+/**
+ * @brief Register a periodic read of an auxiliary I2C slave.
+ * 
+ * Auxiliary I2C master reads ``length`` bytes from ``reg`` of slave at every
+ * sample (or every ``rate_divider + 1`` samples if ``divided`` is set) into
+ * EXT_SENS_DATA registers. Data is in ``sensor_data.external_data`` at
+ * ``aux.position[slave]`` after every burst read, and it can be captured to
+ * FIFO with ``MPU925X_FIFO_SLAVE_*`` flags. Registering a read moves data of
+ * higher slaves. Slave 4 can't read periodically, use ``mpu925x_aux_read``.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param slave Slave number, 1 to 3 (slave 0 reads AK8963).
+ * @param address 7 bit slave address.
+ * @param reg Start register.
+ * @param length Read length, up to 15 bytes, 0 disables slave.
+ * @param divided Read at divided rate if not 0.
+ * @returns 0 on success, 1 if auxiliary I2C master is not enabled, slave or
+ * length is invalid or EXT_SENS_DATA registers are full.
+ * */
+uint8_t mpu925x_aux_slave_read(mpu925x_t *mpu925x, uint8_t slave, uint8_t address, uint8_t reg, uint8_t length, uint8_t divided)
+{
+	uint8_t buffer[3];
+
+	if (!mpu925x->aux.enabled || slave < 1 || slave > 3 || length > I2C_SLV_LENG)
+		return 1;
+	if (mpu925x->aux.size - mpu925x->aux.length[slave] + length > MPU925X_EXTERNAL_DATA_SIZE)
+		return 1;
+
+	mpu925x_lock(mpu925x);
+	buffer[0] = address | I2C_SLV_READ;
+	buffer[1] = reg;
+	buffer[2] = length > 0 ? I2C_SLV_EN | length : 0;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, I2C_SLV0_ADDR + slave * 3, buffer, 3);
+	buffer[0] = divided ? 1 << slave : 0;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, I2C_MST_DELAY_CTRL, buffer, 1, (uint8_t)~(1 << slave));
+
+	mpu925x->aux.length[slave] = length;
+	update_positions(mpu925x);
+	mpu925x_unlock(mpu925x);
+
+	return 0;
+}
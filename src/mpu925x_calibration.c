@@ -0,0 +1,694 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Calibration functions for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_internals.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Gyroscope bias estimation
+ ******************************************************************************/
+
+/**
+ * @brief Start a new stillness window.
+ * @param estimator Gyroscope bias estimator struct pointer.
+ * */
+static void gyroscope_bias_restart(mpu925x_gyroscope_bias_estimator *estimator)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		estimator->sum[i] = 0;
+		estimator->square_sum[i] = 0;
+	}
+	estimator->count = 0;
+	estimator->moving = 0;
+}
+
+/**
+ * @brief Feed last read sample to streaming gyroscope bias estimator.
+ * 
+ * This function doesn't do any bus transaction. It uses raw acceleration and
+ * rotation values already stored in ``sensor_data``, so it should be called
+ * after every ``mpu925x_get_all`` (or acceleration and rotation) call. Samples
+ * are scaled with their range tags, window is restarted when gyroscope range
+ * changes. When a still window is completed, window's mean rotation is stored
+ * in ``mean`` and blended into ``settings.gyroscope_bias`` with ``gain``
+ * (first estimate is taken as is).
+ * @param mpu925x MPU-925X struct pointer.
+ * @param estimator Gyroscope bias estimator struct pointer.
+ * @returns 1 if gyroscope bias is updated, 0 otherwise.
+ * @see mpu925x_gyroscope_bias_commit
+ * */
+uint8_t mpu925x_gyroscope_bias_update(mpu925x_t *mpu925x, mpu925x_gyroscope_bias_estimator *estimator)
+{
+	int16_t *rotation_raw = mpu925x->sensor_data.rotation_raw;
+	int16_t *acceleration_raw = mpu925x->sensor_data.acceleration_raw;
+	float gyroscope_lsb = mpu925x_gyroscope_lsb[mpu925x->sensor_data.gyroscope_scale & 0b11];
+	float acceleration_lsb = mpu925x_acceleration_lsb[mpu925x->sensor_data.accelerometer_scale & 0b11];
+
+	// Window is restarted if range of samples changes in the middle of it.
+	if (estimator->gyroscope_lsb != gyroscope_lsb) {
+		estimator->gyroscope_lsb = gyroscope_lsb;
+		gyroscope_bias_restart(estimator);
+	}
+
+	// First sample of the window is used as reference to keep sums small.
+	if (estimator->count == 0) {
+		for (uint8_t i = 0; i < 3; i++) {
+			estimator->reference[i] = rotation_raw[i];
+		}
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		int32_t difference = (int32_t)rotation_raw[i] - estimator->reference[i];
+		estimator->sum[i] += difference;
+		estimator->square_sum[i] += (int64_t)difference * difference;
+	}
+
+	// Check acceleration norm without square root.
+	float norm = 0.0;
+	for (uint8_t i = 0; i < 3; i++) {
+		float acceleration = acceleration_raw[i] / acceleration_lsb;
+		norm += acceleration * acceleration;
+	}
+	float lower = 1.0 - estimator->acceleration_tolerance;
+	float upper = 1.0 + estimator->acceleration_tolerance;
+	if (norm < lower * lower || norm > upper * upper) {
+		estimator->moving = 1;
+	}
+
+	estimator->count++;
+	if (estimator->count < estimator->window) {
+		return 0;
+	}
+
+	// Window is complete, check gyroscope variance.
+	float mean[3];
+	uint8_t still = !estimator->moving;
+	for (uint8_t i = 0; i < 3; i++) {
+		float mean_lsb = (float)estimator->sum[i] / estimator->count;
+		float variance = (float)estimator->square_sum[i] / estimator->count - mean_lsb * mean_lsb;
+
+		variance /= estimator->gyroscope_lsb * estimator->gyroscope_lsb;
+		if (variance > estimator->variance_threshold) {
+			still = 0;
+		}
+
+		mean[i] = (estimator->reference[i] + mean_lsb) / estimator->gyroscope_lsb;
+	}
+
+	estimator->still = still;
+	gyroscope_bias_restart(estimator);
+
+	if (!still) {
+		return 0;
+	}
+
+	// Blend new estimate into software bias.
+	for (uint8_t i = 0; i < 3; i++) {
+		estimator->mean[i] = mean[i];
+	}
+	float gain = estimator->converged ? estimator->gain : 1.0;
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->settings.gyroscope_bias[i] += gain * (mean[i] - mpu925x->settings.gyroscope_bias[i]);
+	}
+	mpu925x_update_conversion(mpu925x);
+	estimator->converged = 1;
+
+	return 1;
+}
+
+/**
+ * @brief Move software gyroscope bias to hardware offset registers.
+ * 
+ * Current ``XG_OFFSET`` registers are read, software bias is subtracted from
+ * them and they are written back in a single transaction. Software bias is
+ * cleared afterwards.
+ * 
+ * @note Bias estimator measures raw rotation, which includes hardware offset.
+ * After committing, estimator's next result is residual bias, so estimator
+ * state should be reset (``converged`` cleared) before continuing.
+ * @param mpu925x MPU-925X struct pointer.
+ * @see mpu925x_gyroscope_bias_update
+ * */
+void mpu925x_gyroscope_bias_commit(mpu925x_t *mpu925x)
+{
+	uint8_t buffer[6];
+
+	// Offsets and software bias are changed together.
+	mpu925x_lock(mpu925x);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, XG_OFFSET_H, buffer, 6);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		int32_t offset = (int16_t)convert8bitto16bit(buffer[i * 2], buffer[i * 2 + 1]);
+		float bias = mpu925x->settings.gyroscope_bias[i] * GYROSCOPE_OFFSET_SCALE;
+
+		// Round to nearest and saturate.
+		offset -= (int32_t)(bias < 0 ? bias - 0.5 : bias + 0.5);
+		if (offset > INT16_MAX)
+			offset = INT16_MAX;
+		if (offset < INT16_MIN)
+			offset = INT16_MIN;
+
+		buffer[i * 2] = (uint8_t)((offset >> 8) & 0xFF);
+		buffer[i * 2 + 1] = (uint8_t)(offset & 0xFF);
+		mpu925x->settings.gyroscope_bias[i] = 0.0;
+	}
+
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, XG_OFFSET_H, buffer, 6);
+	mpu925x_update_conversion(mpu925x);
+	mpu925x_unlock(mpu925x);
+}
+
+/*******************************************************************************
+ * Accelerometer calibration
+ ******************************************************************************/
+
+/**
+ * @brief Feed last read sample to six-position accelerometer calibration.
+ * 
+ * This function doesn't do any bus transaction and doesn't block, it uses raw
+ * acceleration already stored in ``sensor_data``. Call it after every
+ * acceleration read while sensor stands still in given pose. If range tag of
+ * samples changes, collected data is discarded.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param calibration Accelerometer calibration struct pointer.
+ * @param pose Current pose of the sensor (axis which looks up).
+ * @returns 1 if given pose has enough samples, 0 otherwise.
+ * @see mpu925x_accelerometer_calibration_solve
+ * */
+uint8_t mpu925x_accelerometer_calibration_update(mpu925x_t *mpu925x, mpu925x_accelerometer_calibration *calibration, mpu925x_orientation pose)
+{
+	float acceleration_lsb = mpu925x_acceleration_lsb[mpu925x->sensor_data.accelerometer_scale & 0b11];
+
+	// Samples from different scales can't be mixed.
+	if (calibration->acceleration_lsb != acceleration_lsb) {
+		for (uint8_t i = 0; i < 6; i++) {
+			for (uint8_t j = 0; j < 3; j++) {
+				calibration->sum[i][j] = 0;
+			}
+			calibration->count[i] = 0;
+		}
+		calibration->acceleration_lsb = acceleration_lsb;
+	}
+
+	if (calibration->count[pose] >= calibration->sampling_amount) {
+		return 1;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		calibration->sum[pose][i] += mpu925x->sensor_data.acceleration_raw[i];
+	}
+	calibration->count[pose]++;
+
+	return calibration->count[pose] >= calibration->sampling_amount;
+}
+
+/**
+ * @brief Solve six-position accelerometer calibration.
+ * 
+ * Sensor model is ``raw / lsb = K * g + b`` where ``K`` holds per-axis scale and
+ * cross-axis misalignment. Column ``j`` of ``K`` is half of the difference of
+ * plus and minus poses of axis ``j``, bias ``b`` is the mean of all poses. On
+ * success, ``settings.accelerometer_bias`` is set to ``b`` and accelerometer
+ * matrix is set to inverse of ``K``.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param calibration Accelerometer calibration struct pointer.
+ * @returns 0 on success, 1 if any pose is incomplete, 2 if poses are degenerate.
+ * @see mpu925x_accelerometer_calibration_update
+ * */
+uint8_t mpu925x_accelerometer_calibration_solve(mpu925x_t *mpu925x, mpu925x_accelerometer_calibration *calibration)
+{
+	float mean[6][3];
+
+	for (uint8_t i = 0; i < 6; i++) {
+		if (calibration->count[i] == 0 || calibration->count[i] < calibration->sampling_amount) {
+			return 1;
+		}
+
+		for (uint8_t j = 0; j < 3; j++) {
+			mean[i][j] = (float)calibration->sum[i][j] / calibration->count[i] / calibration->acceleration_lsb;
+		}
+	}
+
+	// Poses are ordered as x+, x-, y+, y-, z+, z-.
+	float k[3][3], bias[3] = {0.0, 0.0, 0.0};
+	for (uint8_t j = 0; j < 3; j++) {
+		for (uint8_t i = 0; i < 3; i++) {
+			k[i][j] = (mean[j * 2][i] - mean[j * 2 + 1][i]) / 2;
+			bias[i] += (mean[j * 2][i] + mean[j * 2 + 1][i]) / 6;
+		}
+	}
+
+	// Invert K with its adjugate.
+	float cofactor[3][3];
+	for (uint8_t i = 0; i < 3; i++) {
+		uint8_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for (uint8_t j = 0; j < 3; j++) {
+			uint8_t j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			cofactor[i][j] = k[i1][j1] * k[i2][j2] - k[i1][j2] * k[i2][j1];
+		}
+	}
+	float determinant = k[0][0] * cofactor[0][0] + k[0][1] * cofactor[0][1] + k[0][2] * cofactor[0][2];
+
+	// Scale should be close to 1, so determinant shouldn't be close to 0.
+	if (determinant < 0.25 && determinant > -0.25) {
+		return 2;
+	}
+
+	float matrix[3][3];
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->settings.accelerometer_bias[i] = bias[i];
+		for (uint8_t j = 0; j < 3; j++) {
+			matrix[i][j] = cofactor[j][i] / determinant;
+		}
+	}
+	mpu925x_set_accelerometer_matrix(mpu925x, matrix);
+
+	return 0;
+}
+
+/**
+ * @brief Move software accelerometer bias to hardware offset registers.
+ * 
+ * Current ``XA_OFFSET`` registers are read, software bias is subtracted from
+ * them and they are written back. Reserved temperature compensation bit (bit 0)
+ * of each register is preserved. Software bias is decreased by the amount that
+ * hardware can represent, so only the residual stays in software.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_accelerometer_bias_commit(mpu925x_t *mpu925x)
+{
+	int16_t offset[3];
+
+	// Offsets and software bias are changed together.
+	mpu925x_lock(mpu925x);
+	mpu925x_get_accelerometer_bias(mpu925x, offset);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		float bias = mpu925x->settings.accelerometer_bias[i] * ACCELEROMETER_OFFSET_SCALE;
+
+		// Offset register has 2 lsb resolution, bit 0 is reserved.
+		int32_t step = 2 * (int32_t)(bias < 0 ? bias / 2 - 0.5 : bias / 2 + 0.5);
+		int32_t value = (int32_t)offset[i] - step;
+		if (value > INT16_MAX)
+			value = INT16_MAX;
+		if (value < INT16_MIN)
+			value = INT16_MIN;
+		value = (value & ~1) | (offset[i] & 1);
+
+		mpu925x->settings.accelerometer_bias[i] -= (float)((offset[i] & ~1) - (value & ~1)) / ACCELEROMETER_OFFSET_SCALE;
+		offset[i] = (int16_t)value;
+	}
+
+	mpu925x_set_accelerometer_offset(mpu925x, offset);
+	mpu925x_update_conversion(mpu925x);
+	mpu925x_unlock(mpu925x);
+}
+
+/*******************************************************************************
+ * Temperature compensation
+ ******************************************************************************/
+
+/**
+ * @brief Solve polynomial coefficients from running sums.
+ * 
+ * Order is chosen from covered temperature span: constant model under
+ * ``TEMPERATURE_MODEL_LINEAR`` degrees, linear model under
+ * ``TEMPERATURE_MODEL_QUADRATIC`` degrees and quadratic model above. New model
+ * is written to settings as a whole by next apply.
+ * @param compensation Temperature compensation struct pointer.
+ * */
+static void temperature_compensation_solve(mpu925x_temperature_compensation *compensation)
+{
+	float *s = compensation->sum;
+	float span = compensation->maximum_temperature - compensation->minimum_temperature;
+
+	compensation->terms = 0;
+	compensation->applied = 0;
+	if (s[0] <= 0.0) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			compensation->coefficient[i][j] = 0.0;
+		}
+	}
+
+	if (span >= TEMPERATURE_MODEL_QUADRATIC) {
+		// Normal equations of quadratic fit, solved with Cramer's rule.
+		float c00 = s[2] * s[4] - s[3] * s[3];
+		float c01 = s[2] * s[3] - s[1] * s[4];
+		float c02 = s[1] * s[3] - s[2] * s[2];
+		float c11 = s[0] * s[4] - s[2] * s[2];
+		float c12 = s[1] * s[2] - s[0] * s[3];
+		float c22 = s[0] * s[2] - s[1] * s[1];
+		float determinant = s[0] * c00 + s[1] * c01 + s[2] * c02;
+
+		if (determinant != 0.0) {
+			for (uint8_t i = 0; i < 3; i++) {
+				float *b = compensation->bias_sum[i];
+				compensation->coefficient[i][0] = (c00 * b[0] + c01 * b[1] + c02 * b[2]) / determinant;
+				compensation->coefficient[i][1] = (c01 * b[0] + c11 * b[1] + c12 * b[2]) / determinant;
+				compensation->coefficient[i][2] = (c02 * b[0] + c12 * b[1] + c22 * b[2]) / determinant;
+			}
+			compensation->terms = 3;
+			return;
+		}
+	}
+
+	if (span >= TEMPERATURE_MODEL_LINEAR) {
+		float determinant = s[0] * s[2] - s[1] * s[1];
+
+		if (determinant != 0.0) {
+			for (uint8_t i = 0; i < 3; i++) {
+				float *b = compensation->bias_sum[i];
+				compensation->coefficient[i][0] = (s[2] * b[0] - s[1] * b[1]) / determinant;
+				compensation->coefficient[i][1] = (s[0] * b[1] - s[1] * b[0]) / determinant;
+			}
+			compensation->terms = 2;
+			return;
+		}
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		compensation->coefficient[i][0] = compensation->bias_sum[i][0] / s[0];
+	}
+	compensation->terms = 1;
+}
+
+/**
+ * @brief Add a still period observation to temperature compensation model.
+ * 
+ * Typically called with ``mean`` of gyroscope bias estimator whenever
+ * ``mpu925x_gyroscope_bias_update`` returns 1. Cost is constant.
+ * @param compensation Temperature compensation struct pointer.
+ * @param temperature Temperature of observation in celsius.
+ * @param bias 3d array which holds observed gyroscope bias in dps.
+ * @see mpu925x_temperature_compensation_apply
+ * */
+void mpu925x_temperature_compensation_learn(mpu925x_temperature_compensation *compensation, float temperature, float *bias)
+{
+	float t = (temperature - TEMPERATURE_MODEL_CENTER) / TEMPERATURE_MODEL_SPAN;
+	float keep = 1.0 - compensation->forgetting;
+	float power = 1.0;
+
+	if (compensation->sum[0] <= 0.0) {
+		compensation->minimum_temperature = temperature;
+		compensation->maximum_temperature = temperature;
+	}
+	if (temperature < compensation->minimum_temperature)
+		compensation->minimum_temperature = temperature;
+	if (temperature > compensation->maximum_temperature)
+		compensation->maximum_temperature = temperature;
+
+	for (uint8_t k = 0; k < 5; k++) {
+		compensation->sum[k] = keep * compensation->sum[k] + power;
+		if (k < 3) {
+			for (uint8_t i = 0; i < 3; i++) {
+				compensation->bias_sum[i][k] = keep * compensation->bias_sum[i][k] + power * bias[i];
+			}
+		}
+		power *= t;
+	}
+
+	temperature_compensation_solve(compensation);
+}
+
+/**
+ * @brief Set software gyroscope bias from temperature compensation model.
+ * 
+ * Uses temperature already stored in ``sensor_data``, so call it after
+ * ``mpu925x_get_temperature`` (or ``mpu925x_get_all``). Bias is written to
+ * ``settings.gyroscope_bias`` and removed by ``mpu925x_get_rotation``. Nothing
+ * is done until model has at least one observation. Cost is constant.
+ * 
+ * After model is (re)learned, bias is set to model output. Afterwards only the
+ * change of model output is added to bias, and only when it exceeds
+ * ``TEMPERATURE_MODEL_EPSILON`` dps, so conversion isn't republished on every
+ * sample. A bias blended in by ``mpu925x_gyroscope_bias_update`` is kept on
+ * top of model until next ``mpu925x_temperature_compensation_learn``, which
+ * takes it into model.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param compensation Temperature compensation struct pointer.
+ * @see mpu925x_temperature_compensation_learn
+ * */
+void mpu925x_temperature_compensation_apply(mpu925x_t *mpu925x, mpu925x_temperature_compensation *compensation)
+{
+	float bias[3];
+	uint8_t moved = !compensation->applied;
+
+	if (compensation->terms == 0) {
+		return;
+	}
+
+	float t = (mpu925x->sensor_data.temperature - TEMPERATURE_MODEL_CENTER) / TEMPERATURE_MODEL_SPAN;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		float *c = compensation->coefficient[i];
+		bias[i] = c[0] + t * (c[1] + t * c[2]);
+		float change = bias[i] - compensation->bias[i];
+		if (change > TEMPERATURE_MODEL_EPSILON || change < -TEMPERATURE_MODEL_EPSILON)
+			moved = 1;
+	}
+
+	if (!moved) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		if (compensation->applied)
+			mpu925x->settings.gyroscope_bias[i] += bias[i] - compensation->bias[i];
+		else
+			mpu925x->settings.gyroscope_bias[i] = bias[i];
+		compensation->bias[i] = bias[i];
+	}
+	compensation->applied = 1;
+	mpu925x_update_conversion(mpu925x);
+}
+
+/**
+ * @brief Serialize temperature compensation model.
+ * 
+ * Running sums are stored, so learning continues after import. Format is
+ * magic byte, version byte, little endian floats and CRC-16 of previous bytes.
+ * @param compensation Temperature compensation struct pointer.
+ * @param buffer Destination buffer.
+ * @param size Size of destination buffer.
+ * @returns Amount of written bytes, 0 if buffer is too small.
+ * @see MPU925X_TEMPERATURE_COMPENSATION_SIZE
+ * */
+uint16_t mpu925x_temperature_compensation_export(mpu925x_temperature_compensation *compensation, uint8_t *buffer, uint16_t size)
+{
+	uint16_t index = 0;
+
+	if (size < MPU925X_TEMPERATURE_COMPENSATION_SIZE) {
+		return 0;
+	}
+
+	buffer[index++] = TEMPERATURE_MODEL_MAGIC;
+	buffer[index++] = TEMPERATURE_MODEL_VERSION;
+	for (uint8_t k = 0; k < 5; k++, index += 4) {
+		mpu925x_pack_float(&buffer[index], compensation->sum[k]);
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t k = 0; k < 3; k++, index += 4) {
+			mpu925x_pack_float(&buffer[index], compensation->bias_sum[i][k]);
+		}
+	}
+	mpu925x_pack_float(&buffer[index], compensation->minimum_temperature);
+	index += 4;
+	mpu925x_pack_float(&buffer[index], compensation->maximum_temperature);
+	index += 4;
+
+	uint16_t crc = mpu925x_crc16(buffer, index);
+	buffer[index++] = crc & 0xFF;
+	buffer[index++] = crc >> 8;
+
+	return index;
+}
+
+/**
+ * @brief Deserialize temperature compensation model.
+ * 
+ * Model is left untouched if buffer is invalid. ``forgetting`` is not a part
+ * of serialized data.
+ * @param compensation Temperature compensation struct pointer.
+ * @param buffer Source buffer.
+ * @param size Size of source buffer.
+ * @returns 0 on success, 1 on wrong size, magic or version, 2 on CRC mismatch.
+ * @see mpu925x_temperature_compensation_export
+ * */
+uint8_t mpu925x_temperature_compensation_import(mpu925x_temperature_compensation *compensation, const uint8_t *buffer, uint16_t size)
+{
+	uint16_t index = 2;
+
+	if (size < MPU925X_TEMPERATURE_COMPENSATION_SIZE || buffer[0] != TEMPERATURE_MODEL_MAGIC || buffer[1] != TEMPERATURE_MODEL_VERSION) {
+		return 1;
+	}
+
+	uint16_t crc = buffer[MPU925X_TEMPERATURE_COMPENSATION_SIZE - 2] | (buffer[MPU925X_TEMPERATURE_COMPENSATION_SIZE - 1] << 8);
+	if (crc != mpu925x_crc16(buffer, MPU925X_TEMPERATURE_COMPENSATION_SIZE - 2)) {
+		return 2;
+	}
+
+	for (uint8_t k = 0; k < 5; k++, index += 4) {
+		compensation->sum[k] = mpu925x_unpack_float(&buffer[index]);
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t k = 0; k < 3; k++, index += 4) {
+			compensation->bias_sum[i][k] = mpu925x_unpack_float(&buffer[index]);
+		}
+	}
+	compensation->minimum_temperature = mpu925x_unpack_float(&buffer[index]);
+	index += 4;
+	compensation->maximum_temperature = mpu925x_unpack_float(&buffer[index]);
+
+	temperature_compensation_solve(compensation);
+
+	return 0;
+}
+
+/*******************************************************************************
+ * Calibration storage
+ ******************************************************************************/
+
+/**
+ * @brief Serialize calibration.
+ * 
+ * Blob holds magnetometer sensitivity adjustment values, accelerometer and
+ * gyroscope offset registers, software biases, accelerometer calibration
+ * matrix and mounting matrix. Format is magic byte, version byte, flags,
+ * sensitivity adjustment values, gyroscope offset registers (6 bytes),
+ * accelerometer offset registers (8 bytes, ``XA_OFFSET_H`` to
+ * ``ZA_OFFSET_L``), little endian floats and CRC-16 of previous bytes.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param buffer Destination buffer.
+ * @param size Size of destination buffer.
+ * @returns Amount of written bytes, 0 if buffer is too small.
+ * @see MPU925X_CALIBRATION_SIZE
+ * */
+uint16_t mpu925x_calibration_export(mpu925x_t *mpu925x, uint8_t *buffer, uint16_t size)
+{
+	uint16_t index = 0;
+
+	if (size < MPU925X_CALIBRATION_SIZE) {
+		return 0;
+	}
+
+	buffer[index++] = CALIBRATION_MAGIC;
+	buffer[index++] = CALIBRATION_VERSION;
+	buffer[index++] = (mpu925x->settings.accelerometer_matrix_enabled ? CALIBRATION_MATRIX_ENABLED : 0) |
+	                  (mpu925x->settings.body_frame ? CALIBRATION_BODY_FRAME : 0);
+	for (uint8_t i = 0; i < 3; i++) {
+		buffer[index++] = (uint8_t)((mpu925x->settings.magnetometer_coefficient[i] - 1) * 256 + 128.5);
+	}
+
+	// Hardware offset registers.
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, XG_OFFSET_H, &buffer[index], 6);
+	index += 6;
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, XA_OFFSET_H, &buffer[index], 8);
+	index += 8;
+
+	// Software calibration.
+	for (uint8_t i = 0; i < 3; i++, index += 8) {
+		mpu925x_pack_float(&buffer[index], mpu925x->settings.gyroscope_bias[i]);
+		mpu925x_pack_float(&buffer[index + 4], mpu925x->settings.accelerometer_bias[i]);
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++, index += 8) {
+			mpu925x_pack_float(&buffer[index], mpu925x->settings.accelerometer_matrix[i][j]);
+			mpu925x_pack_float(&buffer[index + 4], mpu925x->settings.mounting_matrix[i][j]);
+		}
+	}
+
+	uint16_t crc = mpu925x_crc16(buffer, index);
+	buffer[index++] = crc & 0xFF;
+	buffer[index++] = crc >> 8;
+
+	return index;
+}
+
+/**
+ * @brief Restore calibration.
+ * 
+ * Offset registers are written in two transactions and conversion matrices
+ * are recomputed. Nothing is changed if buffer is invalid.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param buffer Source buffer.
+ * @param size Size of source buffer.
+ * @returns 0 on success, 1 on wrong size, magic or version, 2 on CRC mismatch.
+ * @see mpu925x_calibration_export
+ * @see mpu925x_warm_init
+ * */
+uint8_t mpu925x_calibration_import(mpu925x_t *mpu925x, const uint8_t *buffer, uint16_t size)
+{
+	uint8_t offset[8];
+	uint16_t index = 3;
+
+	if (buffer == NULL || size < MPU925X_CALIBRATION_SIZE || buffer[0] != CALIBRATION_MAGIC || buffer[1] != CALIBRATION_VERSION) {
+		return 1;
+	}
+
+	uint16_t crc = buffer[MPU925X_CALIBRATION_SIZE - 2] | (buffer[MPU925X_CALIBRATION_SIZE - 1] << 8);
+	if (crc != mpu925x_crc16(buffer, MPU925X_CALIBRATION_SIZE - 2)) {
+		return 2;
+	}
+
+	// Offsets and software calibration are changed together.
+	mpu925x_lock(mpu925x);
+	mpu925x->settings.accelerometer_matrix_enabled = (buffer[2] & CALIBRATION_MATRIX_ENABLED) != 0;
+	mpu925x->settings.body_frame = (buffer[2] & CALIBRATION_BODY_FRAME) != 0;
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->settings.magnetometer_coefficient[i] = (buffer[index++] - 128) * 0.5 / 128 + 1;
+	}
+
+	// Hardware offset registers, bus functions take non-const buffers.
+	for (uint8_t i = 0; i < 6; i++) {
+		offset[i] = buffer[index++];
+	}
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, XG_OFFSET_H, offset, 6);
+	for (uint8_t i = 0; i < 8; i++) {
+		offset[i] = buffer[index++];
+	}
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, XA_OFFSET_H, offset, 8);
+
+	// Software calibration.
+	for (uint8_t i = 0; i < 3; i++, index += 8) {
+		mpu925x->settings.gyroscope_bias[i] = mpu925x_unpack_float(&buffer[index]);
+		mpu925x->settings.accelerometer_bias[i] = mpu925x_unpack_float(&buffer[index + 4]);
+	}
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++, index += 8) {
+			mpu925x->settings.accelerometer_matrix[i][j] = mpu925x_unpack_float(&buffer[index]);
+			mpu925x->settings.mounting_matrix[i][j] = mpu925x_unpack_float(&buffer[index + 4]);
+		}
+	}
+
+	mpu925x_update_conversion(mpu925x);
+	mpu925x_unlock(mpu925x);
+
+	return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Host clock synchronization functions for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_internals.h"
+#include <math.h>
+#include <stdint.h>
+
+#define ONE ((int64_t)1 << CLOCK_SYNC_FRACTION_BITS)
+
+/**
+ * @brief Time of a sample relative to reference time.
+ * @param sync Clock synchronization struct pointer.
+ * @param sample Sample count.
+ * @returns Time in microseconds, fixed point.
+ * */
+static int64_t elapsed(const mpu925x_clock_sync *sync, uint32_t sample)
+{
+	int32_t samples = (int32_t)(sample - sync->reference_sample);
+
+	return samples * sync->period + sync->reference_fraction;
+}
+
+/**
+ * @brief Initialize host clock synchronization.
+ * 
+ * Sensor samples at its own oscillator, which can be off by a percent or
+ * more, so sample times on host clock are estimated from observations of
+ * sample counts and host times instead of counting nominal periods.
+ * @param sync Clock synchronization struct pointer.
+ * @param sample_rate Nominal sample rate in Hz.
+ * */
+void mpu925x_clock_sync_init(mpu925x_clock_sync *sync, float sample_rate)
+{
+	sync->nominal_period = 1000000 / sample_rate;
+	sync->period = (int64_t)(sync->nominal_period * ONE);
+	sync->reference_time = 0;
+	sync->reference_fraction = 0;
+	sync->reference_sample = 0;
+	sync->jitter = 0;
+	sync->updates = 0;
+}
+
+/**
+ * @brief Add an observation of a sample count on host clock.
+ * 
+ * Observation can be any event whose sample count is known: a FIFO drain,
+ * an FSYNC edge found in data or a data ready interrupt. Interrupt per
+ * sample is not needed, sparse observations are enough. Phase and period
+ * are tracked with an alpha-beta filter, which is a least squares line fit
+ * for first observations and then keeps a fixed bandwidth, so host latency
+ * jitter is averaged out and oscillator drift is followed. Mean host latency
+ * is not observable and stays in timestamps. Observations of same or older
+ * samples are ignored.
+ * @param sync Clock synchronization struct pointer.
+ * @param sample Sample count of observed sample, it can wrap around.
+ * @param time Host time of observed sample in microseconds.
+ * */
+void mpu925x_clock_sync_update(mpu925x_clock_sync *sync, uint32_t sample, uint64_t time)
+{
+	int32_t samples = (int32_t)(sample - sync->reference_sample);
+	int64_t predicted, error, reference, minimum, maximum;
+	float alpha, beta, k;
+
+	if (sync->updates == 0) {
+		sync->reference_time = time;
+		sync->reference_sample = sample;
+		sync->updates = 1;
+		return;
+	}
+	if (samples <= 0)
+		return;
+
+	// Prediction error, positive if sample is observed later than expected.
+	predicted = elapsed(sync, sample);
+	error = (int64_t)(time - sync->reference_time) * ONE - predicted;
+
+	// Least squares gains for growing memory, then fixed gains.
+	k = sync->updates + 1;
+	alpha = 2 * (2 * k - 1) / (k * (k + 1));
+	if (alpha < CLOCK_SYNC_PHASE_GAIN)
+		alpha = CLOCK_SYNC_PHASE_GAIN;
+	beta = 6 / (k * (k + 1));
+	if (beta < alpha * alpha / (2 - alpha))
+		beta = alpha * alpha / (2 - alpha);
+
+	// Move reference to observed sample and correct period.
+	reference = predicted + (int64_t)(alpha * error);
+	reference = reference > 0 ? reference : 0;
+	sync->period += (int64_t)(beta * error) / samples;
+	minimum = (int64_t)(sync->nominal_period * (1 - CLOCK_SYNC_MAX_DRIFT) * ONE);
+	maximum = (int64_t)(sync->nominal_period * (1 + CLOCK_SYNC_MAX_DRIFT) * ONE);
+	sync->period = sync->period < minimum ? minimum : (sync->period > maximum ? maximum : sync->period);
+	sync->reference_time += reference >> CLOCK_SYNC_FRACTION_BITS;
+	sync->reference_fraction = reference & (ONE - 1);
+	sync->reference_sample = sample;
+
+	sync->jitter += (fabsf((float)error / ONE) - sync->jitter) / 16;
+	sync->updates++;
+}
+
+/**
+ * @brief Get host time of a sample.
+ * 
+ * Samples before and after last observation can be mapped, as long as they
+ * are within 2^31 samples of it.
+ * @param sync Clock synchronization struct pointer.
+ * @param sample Sample count.
+ * @returns Host time of sample in microseconds.
+ * */
+uint64_t mpu925x_clock_sync_time(const mpu925x_clock_sync *sync, uint32_t sample)
+{
+	int64_t time = elapsed(sync, sample);
+
+	// Round towards negative infinity for samples before reference.
+	if (time < 0)
+		return sync->reference_time - (uint64_t)((-time + ONE - 1) >> CLOCK_SYNC_FRACTION_BITS);
+
+	return sync->reference_time + (uint64_t)(time >> CLOCK_SYNC_FRACTION_BITS);
+}
+
+/**
+ * @brief Get sample count of last sample at or before a host time.
+ * 
+ * Inverse of ``mpu925x_clock_sync_time``, e.g. to find how many samples
+ * were lost.
+ * @param sync Clock synchronization struct pointer.
+ * @param time Host time in microseconds.
+ * @returns Sample count.
+ * */
+uint32_t mpu925x_clock_sync_sample(const mpu925x_clock_sync *sync, uint64_t time)
+{
+	int64_t delta = (int64_t)(time - sync->reference_time) * ONE - sync->reference_fraction;
+
+	// Round towards negative infinity for times before reference.
+	if (delta < 0)
+		return sync->reference_sample - (uint32_t)((-delta + sync->period - 1) / sync->period);
+
+	return sync->reference_sample + (uint32_t)(delta / sync->period);
+}
+
+/**
+ * @brief Get estimated sample period.
+ * @param sync Clock synchronization struct pointer.
+ * @returns Sample period in microseconds.
+ * */
+float mpu925x_clock_sync_period(const mpu925x_clock_sync *sync)
+{
+	return (float)sync->period / ONE;
+}
+
+/**
+ * @brief Get sensor clock drift.
+ * @param sync Clock synchronization struct pointer.
+ * @returns Estimated sample period deviation from nominal in ppm, positive
+ * if sensor is slower than nominal.
+ * */
+float mpu925x_clock_sync_drift(const mpu925x_clock_sync *sync)
+{
+	return ((float)sync->period / ONE / sync->nominal_period - 1) * 1000000;
+}
@@ -24,6 +24,207 @@
  * */
 
 #include "mpu925x_internals.h"
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Convert raw acceleration to G's with the range it is tagged with.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void convert_acceleration(mpu925x_t *mpu925x)
+{
+	const struct conversion_snapshot *conversion;
+	uint32_t version;
+	float acceleration[3], result[3];
+	float lsb = mpu925x_acceleration_lsb[mpu925x->sensor_data.accelerometer_scale & 0b11];
+
+	// Calculate again if settings are published meanwhile.
+	do {
+		conversion = mpu925x_conversion_acquire(mpu925x, &version);
+
+		for (uint8_t i = 0; i < 3; i++) {
+			acceleration[i] = mpu925x->sensor_data.acceleration_raw[i] / lsb - conversion->accelerometer_bias[i];
+		}
+
+		for (uint8_t i = 0; i < 3; i++) {
+			result[i] = conversion->accelerometer[i][0] * acceleration[0] +
+			            conversion->accelerometer[i][1] * acceleration[1] +
+			            conversion->accelerometer[i][2] * acceleration[2];
+		}
+	} while (mpu925x_conversion_changed(mpu925x, version));
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->sensor_data.acceleration[i] = result[i];
+	}
+}
+
+/**
+ * @brief Convert raw rotation to degrees per second with the range it is
+ * tagged with.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void convert_rotation(mpu925x_t *mpu925x)
+{
+	const struct conversion_snapshot *conversion;
+	uint32_t version;
+	float rotation[3], result[3];
+	float lsb = mpu925x_gyroscope_lsb[mpu925x->sensor_data.gyroscope_scale & 0b11];
+
+	// Calculate again if settings are published meanwhile.
+	do {
+		conversion = mpu925x_conversion_acquire(mpu925x, &version);
+
+		for (uint8_t i = 0; i < 3; i++) {
+			rotation[i] = mpu925x->sensor_data.rotation_raw[i] / lsb - conversion->gyroscope_bias[i];
+		}
+
+		for (uint8_t i = 0; i < 3; i++) {
+			result[i] = conversion->gyroscope[i][0] * rotation[0] +
+			            conversion->gyroscope[i][1] * rotation[1] +
+			            conversion->gyroscope[i][2] * rotation[2];
+		}
+	} while (mpu925x_conversion_changed(mpu925x, version));
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->sensor_data.rotation[i] = result[i];
+	}
+}
+
+/**
+ * @brief Convert raw magnetic field to micro Gauss.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void convert_magnetic_field(mpu925x_t *mpu925x)
+{
+	const struct conversion_snapshot *conversion;
+	uint32_t version;
+	int16_t *raw = mpu925x->sensor_data.magnet_raw;
+	float result[3];
+
+	// Calculate again if settings are published meanwhile.
+	do {
+		conversion = mpu925x_conversion_acquire(mpu925x, &version);
+
+		for (uint8_t i = 0; i < 3; i++) {
+			result[i] = (conversion->magnetometer[i][0] * raw[0] +
+			             conversion->magnetometer[i][1] * raw[1] +
+			             conversion->magnetometer[i][2] * raw[2]) * conversion->magnetometer_lsb;
+		}
+	} while (mpu925x_conversion_changed(mpu925x, version));
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->sensor_data.magnetic_field[i] = result[i];
+	}
+}
+
+/**
+ * @brief Convert raw temperature to celsius degree.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void convert_temperature(mpu925x_t *mpu925x)
+{
+	mpu925x->sensor_data.temperature = ((mpu925x->sensor_data.temperature_raw - 0) / TEMPERATURE_SCALE) + 21;
+}
+
+/**
+ * @brief Check if last magnetometer read has new valid data.
+ * @param mpu925x MPU-925X struct pointer.
+ * @returns Refreshed flag of magnetometer, or 0.
+ * */
+static uint8_t magnetometer_refreshed(mpu925x_t *mpu925x)
+{
+	uint8_t status = mpu925x->sensor_data.magnetometer_status;
+
+	if ((status & MPU925X_MAGNETOMETER_READY) && !(status & MPU925X_MAGNETOMETER_OVERFLOW))
+		return MPU925X_REFRESHED_MAGNETOMETER;
+
+	return 0;
+}
+
+/**
+ * @brief Decode FSYNC state, check health of a batched sample and update
+ * automatic ranges.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param magnetometer Magnetometer is read with this sample.
+ * */
+static void check_sample(mpu925x_t *mpu925x, uint8_t magnetometer)
+{
+	mpu925x->sensor_data.fsync = mpu925x_fsync_flag(mpu925x->settings.fsync, mpu925x->sensor_data.acceleration_raw,
+	                                                mpu925x->sensor_data.temperature_raw, mpu925x->sensor_data.rotation_raw);
+	mpu925x_health_update(mpu925x, magnetometer);
+	mpu925x_auto_range_update(mpu925x);
+}
+
+/**
+ * @brief Decode ST1, raw data and ST2 of magnetometer.
+ * 
+ * Result is stored in ``sensor_data.magnetometer_status``, raw data is only
+ * updated if it is valid.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param buffer ST1 to ST2 registers, 8 bytes.
+ * */
+static void decode_magnetic_field(mpu925x_t *mpu925x, const uint8_t *buffer)
+{
+	uint8_t ready, valid;
+
+	mpu925x->sensor_data.magnetometer_status = (buffer[0] & (MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERRUN)) |
+	                                           (buffer[7] & MPU925X_MAGNETOMETER_OVERFLOW);
+
+	// Check if data is ready in single measurent modes or self test mode.
+	switch (mpu925x->settings.measurement_mode) {
+		case mpu925x_single_measurement_mode:
+		case mpu925x_pipelined_measurement_mode:
+		case mpu925x_self_test_mode:
+			ready = buffer[0] & 1;
+			break;
+		default:
+			ready = 1;
+			break;
+	}
+
+	// Trigger next measurement, AK8963 is in power down mode after a single
+	// measurement so no mode transition delay is needed.
+	if (ready && mpu925x->settings.measurement_mode == mpu925x_pipelined_measurement_mode) {
+		uint8_t control = MAGNETOMETER_SINGLE_MEASUREMENT;
+		if (mpu925x->settings.bit_mode == mpu925x_16_bit) {
+			control |= MAGNETOMETER_16_BIT_OUTPUT;
+		}
+		mpu925x_bus_write(mpu925x, AK8963_ADDRESS, CNTL1, &control, 1);
+	}
+
+	// Keep previous data if not ready or overflowed. There is no early return,
+	// so cost doesn't depend on data.
+	valid = ready && (buffer[7] & 0x08) != 0x08;
+	for (uint8_t i = 0; i < 3; i++) {
+		int16_t raw = convert8bitto16bit(buffer[i * 2 + 2], buffer[i * 2 + 1]);
+		mpu925x->sensor_data.magnet_raw[i] = valid ? raw : mpu925x->sensor_data.magnet_raw[i];
+	}
+}
+
+/**
+ * @brief Read acceleration, temperature, rotation and auxiliary I2C slave
+ * data in one burst and tag them with ranges.
+ * 
+ * EXT_SENS_DATA registers follow gyroscope registers, so slave data of
+ * auxiliary I2C master (``aux.size`` bytes) is read in same transaction.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+static void read_burst(mpu925x_t *mpu925x)
+{
+	uint8_t buffer[14 + MPU925X_EXTERNAL_DATA_SIZE];
+
+	mpu925x_lock(mpu925x);
+	mpu925x->sensor_data.accelerometer_scale = mpu925x->settings.accelerometer_scale;
+	mpu925x->sensor_data.gyroscope_scale = mpu925x->settings.gyroscope_scale;
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, ACCEL_XOUT_H, buffer, 14 + mpu925x->aux.size);
+	mpu925x_unlock(mpu925x);
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x->sensor_data.acceleration_raw[i] = convert8bitto16bit(buffer[i * 2], buffer[i * 2 + 1]);
+		mpu925x->sensor_data.rotation_raw[i] = convert8bitto16bit(buffer[i * 2 + 8], buffer[i * 2 + 9]);
+	}
+	mpu925x->sensor_data.temperature_raw = convert8bitto16bit(buffer[6], buffer[7]);
+	memcpy(mpu925x->sensor_data.external_data, &buffer[14], mpu925x->aux.size);
+}
 
 /**
  * @brief Initialize MPU-925X sensor.
@@ -47,49 +248,133 @@ uint8_t mpu925x_init(mpu925x_t *mpu925x, uint8_t ad0)
 		return 1;
 
 	// Configure AK8963.
-	return_value = __ak8963_init(mpu925x);
+	return_value = __ak8963_init(mpu925x, 0);
 	if (return_value != 0)
 		return 2;
 
 	return 0;
 }
 
+/**
+ * @brief Initialize MPU-925X sensor with stored calibration.
+ * 
+ * Hardware offsets and software calibration are restored from calibration
+ * blob, and AK8963 reset and fuse ROM read are skipped since sensitivity
+ * adjustment coefficients are in blob. If blob is invalid, sensor is
+ * initialized normally.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param ad0 Last bit of the slave address (depends on ad0 pin connection).
+ * @param calibration Calibration blob.
+ * @param size Size of calibration blob.
+ * @returns 0 on success, 1 on failure on mpu925x, 2 on failure on AK8963, 3
+ * if calibration is invalid (sensor is initialized without it).
+ * @see mpu925x_calibration_export
+ * */
+uint8_t mpu925x_warm_init(mpu925x_t *mpu925x, uint8_t ad0, const uint8_t *calibration, uint16_t size)
+{
+	uint8_t warm;
+
+	// Set address.
+	mpu925x->settings.address = MPU925X_ADDRESS | (ad0 & 1);
+
+	// Reset sensor.
+	mpu925x_reset(mpu925x);
+
+	// Configure MPU-925X.
+	if (__mpu925x_init(mpu925x) != 0)
+		return 1;
+
+	// Restore calibration.
+	warm = mpu925x_calibration_import(mpu925x, calibration, size) == 0;
+
+	// Configure AK8963.
+	if (__ak8963_init(mpu925x, warm) != 0)
+		return 2;
+
+	return warm ? 0 : 3;
+}
+
 /**
  * @brief Get all sensor data at once.
+ * 
+ * If ``master_specific.get_time_us`` is provided, ``sensor_data.timestamp`` is
+ * set before reading.
+ * While auxiliary I2C master is enabled, sensors, magnetometer and slave data
+ * are read in one transaction.
  * @param mpu925x MPU-925X struct pointer.
  * */
 void mpu925x_get_all(mpu925x_t *mpu925x)
 {
-	mpu925x_get_acceleration(mpu925x);
-	mpu925x_get_rotation(mpu925x);
-	mpu925x_get_magnetic_field(mpu925x);
-	mpu925x_get_temperature(mpu925x);
+	if (mpu925x->master_specific.get_time_us != NULL)
+		mpu925x->sensor_data.timestamp = mpu925x->master_specific.get_time_us(mpu925x);
+
+	if (mpu925x->aux.enabled) {
+		// Magnetometer data is in EXT_SENS_DATA registers.
+		read_burst(mpu925x);
+		decode_magnetic_field(mpu925x, mpu925x->sensor_data.external_data);
+		convert_acceleration(mpu925x);
+		convert_rotation(mpu925x);
+		convert_magnetic_field(mpu925x);
+		convert_temperature(mpu925x);
+	}
+	else {
+		mpu925x_get_acceleration(mpu925x);
+		mpu925x_get_rotation(mpu925x);
+		mpu925x_get_magnetic_field(mpu925x);
+		mpu925x_get_temperature(mpu925x);
+	}
+
+	mpu925x->sensor_data.refreshed = MPU925X_REFRESHED_ACCELEROMETER | MPU925X_REFRESHED_GYROSCOPE |
+	                                 MPU925X_REFRESHED_TEMPERATURE | magnetometer_refreshed(mpu925x);
+	check_sample(mpu925x, 1);
 }
 
 /**
  * @brief Get all raw sensor data at once.
+ * 
+ * If ``master_specific.get_time_us`` is provided, ``sensor_data.timestamp`` is
+ * set before reading.
+ * While auxiliary I2C master is enabled, sensors, magnetometer and slave data
+ * are read in one transaction.
  * @param mpu925x MPU-925X struct pointer.
  * */
 void mpu925x_get_all_raw(mpu925x_t *mpu925x)
 {
-	mpu925x_get_acceleration_raw(mpu925x);
-	mpu925x_get_rotation_raw(mpu925x);
-	mpu925x_get_magnetic_field_raw(mpu925x);
-	mpu925x_get_temperature_raw(mpu925x);
+	if (mpu925x->master_specific.get_time_us != NULL)
+		mpu925x->sensor_data.timestamp = mpu925x->master_specific.get_time_us(mpu925x);
+
+	if (mpu925x->aux.enabled) {
+		// Magnetometer data is in EXT_SENS_DATA registers.
+		read_burst(mpu925x);
+		decode_magnetic_field(mpu925x, mpu925x->sensor_data.external_data);
+	}
+	else {
+		mpu925x_get_acceleration_raw(mpu925x);
+		mpu925x_get_rotation_raw(mpu925x);
+		mpu925x_get_magnetic_field_raw(mpu925x);
+		mpu925x_get_temperature_raw(mpu925x);
+	}
+
+	mpu925x->sensor_data.refreshed = MPU925X_REFRESHED_ACCELEROMETER | MPU925X_REFRESHED_GYROSCOPE |
+	                                 MPU925X_REFRESHED_TEMPERATURE | magnetometer_refreshed(mpu925x);
+	check_sample(mpu925x, 1);
 }
 
 /**
  * @brief Get acceleration in G's.
+ * 
+ * Software accelerometer bias (``settings.accelerometer_bias``, as last
+ * published) is subtracted and result is multiplied with precomputed
+ * conversion matrix, which holds calibration matrix and mounting rotation.
  * @param mpu925x MPU-925X struct pointer.
  * @see mpu925x_get_acceleration_raw
+ * @see mpu925x_set_accelerometer_matrix
+ * @see mpu925x_set_mounting_matrix
  * */
 void mpu925x_get_acceleration(mpu925x_t *mpu925x)
 {
 	mpu925x_get_acceleration_raw(mpu925x);
-
-	for (uint8_t i = 0; i < 3; i++) {
-		mpu925x->sensor_data.acceleration[i] = mpu925x->sensor_data.acceleration_raw[i] / mpu925x->settings.acceleration_lsb;
-	}
+	convert_acceleration(mpu925x);
 }
 
 /**
@@ -101,8 +386,11 @@ void mpu925x_get_acceleration_raw(mpu925x_t *mpu925x)
 {
 	uint8_t buffer[6];
 
-	// Read raw acceleration data.
-	mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, ACCEL_XOUT_H, buffer, 6);
+	// Read raw acceleration data and tag it with its range.
+	mpu925x_lock(mpu925x);
+	mpu925x->sensor_data.accelerometer_scale = mpu925x->settings.accelerometer_scale;
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, ACCEL_XOUT_H, buffer, 6);
+	mpu925x_unlock(mpu925x);
 	for (uint8_t i = 0; i < 3; i++) {
 		mpu925x->sensor_data.acceleration_raw[i] = convert8bitto16bit(buffer[i * 2], buffer[i * 2 + 1]);
 	}
@@ -110,16 +398,18 @@ void mpu925x_get_acceleration_raw(mpu925x_t *mpu925x)
 
 /**
  * @brief Get rotation in degrees per second.
+ * 
+ * Software gyroscope bias (``settings.gyroscope_bias``, as last published) is
+ * subtracted and result is multiplied with precomputed conversion matrix,
+ * which holds mounting rotation.
  * @param mpu925x MPU-925X struct pointer.
  * @see mpu925x_get_rotation_raw
+ * @see mpu925x_set_mounting_matrix
  * */
 void mpu925x_get_rotation(mpu925x_t *mpu925x)
 {
 	mpu925x_get_rotation_raw(mpu925x);
-
-	for (uint8_t i = 0; i < 3; i++) {
-		mpu925x->sensor_data.rotation[i] = mpu925x->sensor_data.rotation_raw[i] / mpu925x->settings.gyroscope_lsb;
-	}
+	convert_rotation(mpu925x);
 }
 
 /**
@@ -131,7 +421,11 @@ void mpu925x_get_rotation_raw(mpu925x_t *mpu925x)
 {
 	uint8_t buffer[6];
 
-	mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, GYRO_XOUT_H, buffer, 6);
+	// Read raw rotation data and tag it with its range.
+	mpu925x_lock(mpu925x);
+	mpu925x->sensor_data.gyroscope_scale = mpu925x->settings.gyroscope_scale;
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, GYRO_XOUT_H, buffer, 6);
+	mpu925x_unlock(mpu925x);
 	for (uint8_t i = 0; i < 3; i++) {
 		mpu925x->sensor_data.rotation_raw[i] = convert8bitto16bit(buffer[i * 2], buffer[i * 2 + 1]);
 	}
@@ -139,50 +433,35 @@ void mpu925x_get_rotation_raw(mpu925x_t *mpu925x)
 
 /**
  * @brief Get magnetic field in micro Gauss.
+ * 
+ * Raw data is multiplied with precomputed conversion matrix, which holds
+ * sensitivity adjustment coefficients and, in body frame, AK8963 to
+ * accelerometer axis alignment and mounting rotation.
  * @param mpu925x MPU-925X struct pointer.
+ * @see mpu925x_set_mounting_matrix
  * */
 void mpu925x_get_magnetic_field(mpu925x_t *mpu925x)
 {
 	mpu925x_get_magnetic_field_raw(mpu925x);
-
-	// Calculate magnetic_field data in micro Gauss.
-	for (uint8_t i = 0; i < 3; i++) {
-		mpu925x->sensor_data.magnetic_field[i] = mpu925x->sensor_data.magnet_raw[i] * mpu925x->settings.magnetometer_lsb * mpu925x->settings.magnetometer_coefficient[i];
-	}
+	convert_magnetic_field(mpu925x);
 }
 
 /**
  * @brief Get raw magnetic field data.
+ * 
+ * ST1, data and ST2 registers are read in one transaction. Result of read is
+ * stored in ``sensor_data.magnetometer_status``, raw data is only updated if
+ * it is valid.
  * @param mpu925x MPU-925X struct pointer.
+ * @see MPU925X_MAGNETOMETER_READY
  * */
 void mpu925x_get_magnetic_field_raw(mpu925x_t *mpu925x)
 {
-	uint8_t buffer[7];
-
-	// Check if data is ready in single measurent mode or self test mode.
-	switch (mpu925x->settings.measurement_mode) {
-		case mpu925x_single_measurement_mode:
-		case mpu925x_self_test_mode:
-			mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, ST1, buffer, 1);
-			if ((buffer[0] & 1) != 1) {
-				return;
-			}
-			break;
-		default:
-			break;
-	}
+	uint8_t buffer[8];
 
-	// Read raw data and ST2 overflow register.
-	mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, HXL, buffer, 7);
-
-	// Check overflow.
-	if ((buffer[6] & 0x08) == 0x08) {
-		return;
-	}
-
-	for (uint8_t i = 0; i < 3; i++) {
-		mpu925x->sensor_data.magnet_raw[i] = convert8bitto16bit(buffer[i * 2 + 1], buffer[i * 2]);
-	}
+	// Read ST1, raw data and ST2 overflow register. Reading ST2 releases data.
+	mpu925x_bus_read(mpu925x, AK8963_ADDRESS, ST1, buffer, 8);
+	decode_magnetic_field(mpu925x, buffer);
 }
 
 /**
@@ -192,9 +471,7 @@ void mpu925x_get_magnetic_field_raw(mpu925x_t *mpu925x)
 void mpu925x_get_temperature(mpu925x_t *mpu925x)
 {
 	mpu925x_get_temperature_raw(mpu925x);
-
-	// Calculate temperature in celsius.
-	mpu925x->sensor_data.temperature = ((mpu925x->sensor_data.temperature_raw - 0) / TEMPERATURE_SCALE) + 21;
+	convert_temperature(mpu925x);
 }
 
 /**
@@ -206,6 +483,123 @@ void mpu925x_get_temperature_raw(mpu925x_t *mpu925x)
 	uint8_t buffer[2];
 
 	// Read raw temperature data.
-	mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, TEMP_OUT_H, buffer, 2);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, TEMP_OUT_H, buffer, 2);
 	mpu925x->sensor_data.temperature_raw = convert8bitto16bit(buffer[0], buffer[1]);
 }
+
+/**
+ * @brief Initialize multi-rate acquisition scheduler.
+ * 
+ * Magnetometer rate is derived from current measurement mode (8 Hz or 100 Hz
+ * in continuous modes, 100 Hz in single measurement modes), so it must be
+ * called again after measurement mode changes.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param scheduler Scheduler struct pointer.
+ * @param sample_rate Rate of ``mpu925x_scheduler_get_all`` calls in Hz,
+ * normally accelerometer and gyroscope output data rate.
+ * */
+void mpu925x_scheduler_init(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler, uint16_t sample_rate)
+{
+	uint16_t rate;
+
+	switch (mpu925x->settings.measurement_mode) {
+		case mpu925x_power_down_mode:
+		case mpu925x_fuse_rom_access_mode:
+			scheduler->magnetometer_divider = 0;
+			scheduler->magnetometer_countdown = 0;
+			return;
+		case mpu925x_continuous_measurement_mode_1:
+			rate = MAGNETOMETER_RATE_CONTINUOUS_1;
+			break;
+		case mpu925x_continuous_measurement_mode_2:
+			rate = MAGNETOMETER_RATE_CONTINUOUS_2;
+			break;
+		case mpu925x_single_measurement_mode:
+		case mpu925x_pipelined_measurement_mode:
+			rate = MAGNETOMETER_RATE_SINGLE;
+			break;
+		default:
+			rate = sample_rate;
+			break;
+	}
+
+	// Poll 1/16 period early, so reads lock to magnetometer's own clock
+	// instead of drifting behind it.
+	uint32_t divider = ((uint32_t)sample_rate * 15) / ((uint32_t)rate * 16);
+	scheduler->magnetometer_divider = divider > 0 ? divider : 1;
+	scheduler->magnetometer_countdown = 0;
+}
+
+/**
+ * @brief Get sensor data which can have new values.
+ * 
+ * Accelerometer, temperature and gyroscope are read in one burst, with slave
+ * data of auxiliary I2C master if it is enabled. Magnetometer is read when a
+ * new measurement is due; if it isn't ready yet, it is polled again on next
+ * call. ``sensor_data.refreshed`` tells which
+ * channels are updated.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param scheduler Scheduler struct pointer.
+ * @see MPU925X_REFRESHED_ACCELEROMETER
+ * */
+void mpu925x_scheduler_get_all(mpu925x_t *mpu925x, mpu925x_scheduler *scheduler)
+{
+	if (mpu925x->master_specific.get_time_us != NULL)
+		mpu925x->sensor_data.timestamp = mpu925x->master_specific.get_time_us(mpu925x);
+
+	// Read acceleration, temperature, rotation and slave data.
+	read_burst(mpu925x);
+	convert_acceleration(mpu925x);
+	convert_rotation(mpu925x);
+	convert_temperature(mpu925x);
+	mpu925x->sensor_data.refreshed = MPU925X_REFRESHED_ACCELEROMETER | MPU925X_REFRESHED_GYROSCOPE | MPU925X_REFRESHED_TEMPERATURE;
+
+	// Magnetometer is polled if a new measurement is due.
+	if (scheduler->magnetometer_divider == 0) {
+		check_sample(mpu925x, 0);
+		return;
+	}
+
+	if (scheduler->magnetometer_countdown > 0) {
+		scheduler->magnetometer_countdown--;
+		check_sample(mpu925x, 0);
+		return;
+	}
+
+	if (mpu925x->aux.enabled)
+		decode_magnetic_field(mpu925x, mpu925x->sensor_data.external_data);
+	else
+		mpu925x_get_magnetic_field_raw(mpu925x);
+	if (mpu925x->sensor_data.magnetometer_status & MPU925X_MAGNETOMETER_READY) {
+		scheduler->magnetometer_countdown = scheduler->magnetometer_divider - 1;
+	}
+	if (magnetometer_refreshed(mpu925x)) {
+		convert_magnetic_field(mpu925x);
+		mpu925x->sensor_data.refreshed |= MPU925X_REFRESHED_MAGNETOMETER;
+	}
+	check_sample(mpu925x, 1);
+}
+
+/**
+ * @brief Check that WHO_AM_I and WIA registers didn't change.
+ * 
+ * Takes two bus transactions, so it is meant to be called at a low rate
+ * (e.g. once per second) alongside sample health checks. Sets
+ * ``MPU925X_HEALTH_IDENTITY`` in ``health.latched`` on mismatch.
+ * @param mpu925x MPU-925X struct pointer.
+ * @returns 0 if identity is unchanged, 1 otherwise.
+ * */
+uint8_t mpu925x_health_check_identity(mpu925x_t *mpu925x)
+{
+	uint8_t who_am_i = 0, wia = 0;
+
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, WHO_AM_I, &who_am_i, 1);
+	mpu925x_bus_read(mpu925x, AK8963_ADDRESS, WIA, &wia, 1);
+	if (who_am_i == mpu925x->health.who_am_i && wia == 0x48)
+		return 0;
+
+	mpu925x->health.latched |= MPU925X_HEALTH_IDENTITY;
+	mpu925x->health.identity_errors++;
+
+	return 1;
+}
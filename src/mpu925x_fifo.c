@@ -0,0 +1,468 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief FIFO capture functions for MPU-925X driver.
+ * */
+
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_internals.h"
+#include <stdint.h>
+#include <string.h>
+
+// Largest bus transaction.
+#define MAX_READ 255
+
+// Decoder paths
+#define PATH_GENERIC         0
+#define PATH_ACCEL_TEMP_GYRO 1
+#define PATH_ACCEL_GYRO      2
+#define PATH_ACCEL           3
+#define PATH_GYRO            4
+
+const mpu925x_frame_layout mpu925x_register_layout = {
+	.size = 14,
+	.acceleration = 0,
+	.temperature = 6,
+	.rotation = {8, 10, 12},
+	.external = {MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT},
+	.external_position = {MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT},
+	.path = PATH_ACCEL_TEMP_GYRO,
+	.word_count = 7,
+	.word_offset = {0, 2, 4, 6, 8, 10, 12},
+	.word_field = {0, 1, 2, 3, 4, 5, 6}
+};
+
+/**
+ * @brief Append a 16 bit value to layout.
+ * @param layout Frame layout.
+ * @param field Field index in decoded frame (acceleration, temperature,
+ * rotation).
+ * */
+static void layout_add_word(mpu925x_frame_layout *layout, uint8_t field)
+{
+	layout->word_offset[layout->word_count] = layout->size;
+	layout->word_field[layout->word_count] = field;
+	layout->word_count++;
+	layout->size += 2;
+}
+
+/**
+ * @brief Set FIFO frame layout from FIFO configuration.
+ * 
+ * Frames hold acceleration, temperature, rotation and slave data in this
+ * order. Enabled slaves take EXT_SENS_DATA registers in slave order, bytes
+ * of captured slaves follow sensor values in frame. Common layouts without
+ * slave data are decoded by fast paths.
+ * @param layout Frame layout.
+ * @param sensors ``MPU925X_FIFO_*`` flags.
+ * @param slave_control I2C_SLV0_CTRL to I2C_SLV3_CTRL register values.
+ * */
+void mpu925x_frame_layout_init(mpu925x_frame_layout *layout, uint16_t sensors, const uint8_t *slave_control)
+{
+	uint8_t position = 0;
+
+	memset(layout, MPU925X_LAYOUT_ABSENT, sizeof(*layout));
+	layout->size = 0;
+	layout->word_count = 0;
+
+	if (sensors & FIFO_ACCEL) {
+		layout->acceleration = layout->size;
+		for (uint8_t i = 0; i < 3; i++) {
+			layout_add_word(layout, i);
+		}
+	}
+
+	if (sensors & FIFO_TEMP) {
+		layout->temperature = layout->size;
+		layout_add_word(layout, 3);
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		if (sensors & (0x40 >> i)) {
+			layout->rotation[i] = layout->size;
+			layout_add_word(layout, 4 + i);
+		}
+	}
+
+	uint8_t words = layout->size;
+	for (uint8_t i = 0; i < 4; i++) {
+		uint8_t length = (slave_control[i] & I2C_SLV_EN) ? slave_control[i] & I2C_SLV_LENG : 0;
+		uint16_t flag = i < 3 ? 1 << i : FIFO_SLAVE_3;
+
+		// Registers end at EXT_SENS_DATA_23.
+		if (length > MPU925X_EXTERNAL_DATA_SIZE - position)
+			length = MPU925X_EXTERNAL_DATA_SIZE - position;
+
+		layout->external_size[i] = 0;
+		if (length == 0)
+			continue;
+
+		layout->external_position[i] = position;
+		if (sensors & flag) {
+			layout->external[i] = layout->size;
+			layout->external_size[i] = length;
+			layout->size += length;
+		}
+		position += length;
+	}
+
+	layout->path = PATH_GENERIC;
+	if (layout->size == words) {
+		switch (sensors & (FIFO_TEMP | FIFO_GYRO | FIFO_ACCEL)) {
+		case FIFO_ACCEL | FIFO_TEMP | FIFO_GYRO:
+			layout->path = PATH_ACCEL_TEMP_GYRO;
+			break;
+		case FIFO_ACCEL | FIFO_GYRO:
+			layout->path = PATH_ACCEL_GYRO;
+			break;
+		case FIFO_ACCEL:
+			layout->path = PATH_ACCEL;
+			break;
+		case FIFO_GYRO:
+			layout->path = PATH_GYRO;
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Decode a frame of fixed layout, constant offsets are folded by
+ * compiler.
+ * */
+static inline void decode_fixed(const uint8_t *data, mpu925x_fifo_frame *frame, uint8_t acceleration, uint8_t temperature, uint8_t rotation)
+{
+	if (acceleration != MPU925X_LAYOUT_ABSENT) {
+		for (uint8_t i = 0; i < 3; i++) {
+			frame->acceleration_raw[i] = mpu925x_frame_value(data, acceleration + i * 2);
+		}
+	}
+
+	if (temperature != MPU925X_LAYOUT_ABSENT) {
+		frame->temperature_raw = mpu925x_frame_value(data, temperature);
+	}
+
+	if (rotation != MPU925X_LAYOUT_ABSENT) {
+		for (uint8_t i = 0; i < 3; i++) {
+			frame->rotation_raw[i] = mpu925x_frame_value(data, rotation + i * 2);
+		}
+	}
+}
+
+/**
+ * @brief Decode a frame of any layout with its decoder table.
+ * */
+static void decode_generic(const mpu925x_frame_layout *layout, const uint8_t *data, mpu925x_fifo_frame *frame)
+{
+	int16_t values[7] = {0};
+
+	for (uint8_t i = 0; i < layout->word_count; i++) {
+		values[layout->word_field[i]] = mpu925x_frame_value(data, layout->word_offset[i]);
+	}
+
+	for (uint8_t i = 0; i < 3; i++) {
+		frame->acceleration_raw[i] = values[i];
+		frame->rotation_raw[i] = values[4 + i];
+	}
+	frame->temperature_raw = values[3];
+
+	for (uint8_t i = 0; i < 4; i++) {
+		if (layout->external_size[i] > 0) {
+			memcpy(&frame->external_data[layout->external_position[i]], &data[layout->external[i]], layout->external_size[i]);
+		}
+	}
+}
+
+/**
+ * @brief Decode raw frames.
+ * 
+ * ``data`` may be placed at the end of ``frames`` array (last
+ * ``count * layout->size`` bytes of it), frames are decoded in place then.
+ * Fields which are not in layout are 0.
+ * @param layout Frame layout.
+ * @param data Raw frames.
+ * @param count Frame count.
+ * @param frames Decoded frames.
+ * */
+void mpu925x_frame_decode(const mpu925x_frame_layout *layout, const uint8_t *data, uint16_t count, mpu925x_fifo_frame *frames)
+{
+	for (uint16_t n = 0; n < count; n++, data += layout->size) {
+		// Raw frame is read before it is overwritten.
+		mpu925x_fifo_frame frame = {0};
+
+		switch (layout->path) {
+		case PATH_ACCEL_TEMP_GYRO:
+			decode_fixed(data, &frame, 0, 6, 8);
+			break;
+		case PATH_ACCEL_GYRO:
+			decode_fixed(data, &frame, 0, MPU925X_LAYOUT_ABSENT, 6);
+			break;
+		case PATH_ACCEL:
+			decode_fixed(data, &frame, 0, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT);
+			break;
+		case PATH_GYRO:
+			decode_fixed(data, &frame, MPU925X_LAYOUT_ABSENT, MPU925X_LAYOUT_ABSENT, 0);
+			break;
+		default:
+			decode_generic(layout, data, &frame);
+			break;
+		}
+
+		frames[n] = frame;
+	}
+}
+
+/**
+ * @brief Start capturing samples to FIFO.
+ * 
+ * FIFO is reset and given sensors are written to it at sample rate. Sample
+ * rate is the output data rate set by sample rate divider and low pass
+ * filter settings, it sets the nominal sample period used to seed frame
+ * timestamp estimation. Auxiliary I2C slaves must be configured before,
+ * their data lengths are part of frame layout.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param capture FIFO capture struct pointer.
+ * @param sensors ``MPU925X_FIFO_*`` flags.
+ * @param sample_rate Output data rate in Hz.
+ * @returns 0 on success, 1 if no sensor is selected or sample rate isn't
+ * positive.
+ * */
+uint8_t mpu925x_fifo_start(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, uint16_t sensors, float sample_rate)
+{
+	uint8_t buffer, slaves[12], slave_control[4];
+
+	sensors &= FIFO_TEMP | FIFO_GYRO | FIFO_ACCEL | FIFO_SLAVES | FIFO_SLAVE_3;
+	if (sample_rate <= 0)
+		return 1;
+
+	mpu925x_lock(mpu925x);
+
+	// I2C_SLVx_ADDR, I2C_SLVx_REG and I2C_SLVx_CTRL of slaves 0 to 3.
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, I2C_SLV0_ADDR, slaves, sizeof(slaves));
+	for (uint8_t i = 0; i < 4; i++) {
+		slave_control[i] = slaves[i * 3 + 2];
+	}
+	mpu925x_frame_layout_init(&capture->layout, sensors, slave_control);
+	if (capture->layout.size == 0) {
+		mpu925x_unlock(mpu925x);
+		return 1;
+	}
+
+	capture->sensors = sensors;
+	mpu925x_clock_sync_init(&capture->clock, sample_rate);
+	capture->sequence = 0;
+	capture->sample = 0;
+	capture->overflows = 0;
+	capture->lost = 0;
+	mpu925x->fifo.enabled = 1;
+	mpu925x->fifo.splits = 0;
+	mpu925x->fifo.dropped = 0;
+
+	// Reset FIFO and enable sensors, auxiliary I2C master is kept.
+	buffer = USER_CTRL_FIFO_RST;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, &buffer, 1, USER_CTRL_I2C_MST_EN);
+	buffer = (uint8_t)sensors;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, FIFO_EN, &buffer, 1);
+	buffer = (sensors & FIFO_SLAVE_3) ? I2C_MST_SLV_3_FIFO_EN : 0;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, I2C_MST_CTRL, &buffer, 1, (uint8_t)~I2C_MST_SLV_3_FIFO_EN);
+	buffer = USER_CTRL_FIFO_EN;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, &buffer, 1, USER_CTRL_I2C_MST_EN);
+	mpu925x_unlock(mpu925x);
+
+	return 0;
+}
+
+/**
+ * @brief Set position and time of next block.
+ * @param capture FIFO capture struct pointer.
+ * @param block Block information.
+ * @param count Frame count.
+ * */
+static void fill_block(mpu925x_fifo_capture *capture, mpu925x_fifo_block *block, uint16_t count)
+{
+	block->timestamp = mpu925x_clock_sync_time(&capture->clock, capture->sample);
+	block->period = mpu925x_clock_sync_period(&capture->clock);
+	block->sequence = capture->sequence;
+	block->sample = capture->sample;
+	block->count = count;
+}
+
+/**
+ * @brief Remove first FIFO split point.
+ * @param fifo FIFO split points.
+ * */
+static void pop_split(struct fifo *fifo)
+{
+	fifo->splits--;
+	for (uint8_t i = 0; i < fifo->splits; i++) {
+		fifo->split[i] = fifo->split[i + 1];
+		fifo->accelerometer_scale[i] = fifo->accelerometer_scale[i + 1];
+		fifo->gyroscope_scale[i] = fifo->gyroscope_scale[i + 1];
+	}
+}
+
+/**
+ * @brief Read a contiguous block of raw frames from FIFO.
+ * 
+ * FIFO count is read first, then whole frames are drained straight into
+ * ``buffer`` in bursts of up to 255 bytes, so a DMA capable transport can
+ * fill it without intermediate copies. Frames are in ``capture->layout``
+ * and can be read in place with ``mpu925x_frame_value`` or decoded with
+ * ``mpu925x_frame_decode``. A full FIFO means samples were dropped and frame
+ * boundaries are lost, so FIFO is reset, no frames are returned and next
+ * block with frames is flagged with ``overflow``. FIFO must be read before
+ * it fills (512 bytes) to capture without gaps. Block ends at first pending
+ * full-scale range change, frames after it are returned by next read.
+ * 
+ * Frame times are reconstructed from read times. At every read newest frame
+ * in FIFO is observed as sampled at read time, ``capture->clock`` fits
+ * sample period and phase to these observations, so latency jitter of reads
+ * is averaged out and timestamps follow actual sample period of sensor
+ * oscillator instead of nominal one. After an overflow, lost samples are
+ * estimated from read time, so timestamps stay on the same line. Without
+ * ``master_specific.get_time_us`` timestamps count nominal sample periods
+ * from start.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param capture FIFO capture struct pointer.
+ * @param buffer Raw frame buffer.
+ * @param size Buffer size in bytes, remaining frames stay in FIFO.
+ * @param block Block information.
+ * @returns Frame count.
+ * */
+uint16_t mpu925x_fifo_read_raw(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, uint8_t *buffer, uint16_t size, mpu925x_fifo_block *block)
+{
+	struct fifo *fifo = &mpu925x->fifo;
+	uint8_t frame_size = capture->layout.size;
+	uint16_t available, count, total;
+	uint64_t now = 0;
+
+	mpu925x_lock(mpu925x);
+
+	// Split points without a whole frame before them are passed.
+	while (fifo->splits > 0 && fifo->split[0] < frame_size) {
+		pop_split(fifo);
+	}
+
+	// Frames before first split point were captured under its ranges.
+	block->accelerometer_scale = fifo->splits > 0 ? fifo->accelerometer_scale[0] : mpu925x->settings.accelerometer_scale;
+	block->gyroscope_scale = fifo->splits > 0 ? fifo->gyroscope_scale[0] : mpu925x->settings.gyroscope_scale;
+
+	uint8_t fifo_count[2];
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_COUNTH, fifo_count, 2);
+	available = convert8bitto16bit(fifo_count[0] & 0x1F, fifo_count[1]);
+	if (mpu925x->master_specific.get_time_us != NULL)
+		now = mpu925x->master_specific.get_time_us(mpu925x);
+
+	if (available >= FIFO_SIZE || fifo->dropped) {
+		fifo_count[0] = USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RST;
+		mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, fifo_count, 1, USER_CTRL_I2C_MST_EN);
+		fifo->splits = 0;
+		fifo->dropped = 0;
+		block->accelerometer_scale = mpu925x->settings.accelerometer_scale;
+		block->gyroscope_scale = mpu925x->settings.gyroscope_scale;
+		mpu925x_unlock(mpu925x);
+
+		// FIFO is empty at read time, next frame is sampled after it.
+		if (mpu925x->master_specific.get_time_us != NULL && capture->clock.updates > 0)
+			capture->sample = mpu925x_clock_sync_sample(&capture->clock, now) + 1;
+
+		capture->overflows++;
+		capture->lost = 1;
+		fill_block(capture, block, 0);
+		block->overflow = 1;
+		return 0;
+	}
+
+	available /= frame_size;
+	count = available < size / frame_size ? available : size / frame_size;
+	if (fifo->splits > 0 && count > fifo->split[0] / frame_size)
+		count = fifo->split[0] / frame_size;
+	total = count * frame_size;
+
+	for (uint16_t offset = 0; offset < total; offset += MAX_READ) {
+		uint8_t burst = total - offset < MAX_READ ? total - offset : MAX_READ;
+		mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_R_W, &buffer[offset], burst);
+	}
+
+	for (uint8_t i = 0; i < fifo->splits; i++) {
+		fifo->split[i] -= total;
+	}
+	while (fifo->splits > 0 && fifo->split[0] < frame_size) {
+		pop_split(fifo);
+	}
+
+	mpu925x_unlock(mpu925x);
+
+	// Newest frame in FIFO is sampled at read time.
+	if (mpu925x->master_specific.get_time_us != NULL && available > 0)
+		mpu925x_clock_sync_update(&capture->clock, capture->sample + available - 1, now);
+	fill_block(capture, block, count);
+	block->overflow = capture->lost;
+
+	capture->sequence += count;
+	capture->sample += count;
+	if (count > 0)
+		capture->lost = 0;
+
+	return count;
+}
+
+/**
+ * @brief Read a contiguous block of decoded frames from FIFO.
+ * 
+ * Same as ``mpu925x_fifo_read_raw``, raw frames are drained to the end of
+ * ``frames`` array and decoded in place.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param capture FIFO capture struct pointer.
+ * @param frames Frame array.
+ * @param size Frame array size, remaining frames stay in FIFO.
+ * @param block Block information.
+ * @returns Frame count.
+ * */
+uint16_t mpu925x_fifo_read(mpu925x_t *mpu925x, mpu925x_fifo_capture *capture, mpu925x_fifo_frame *frames, uint16_t size, mpu925x_fifo_block *block)
+{
+	// FIFO never holds more frames.
+	if (size > FIFO_SIZE / capture->layout.size)
+		size = FIFO_SIZE / capture->layout.size;
+
+	uint8_t *raw = (uint8_t *)frames + size * (sizeof(*frames) - capture->layout.size);
+	uint16_t count = mpu925x_fifo_read_raw(mpu925x, capture, raw, size * capture->layout.size, block);
+	mpu925x_frame_decode(&capture->layout, raw, count, frames);
+
+	return count;
+}
+
+/**
+ * @brief Stop capturing samples to FIFO.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_fifo_stop(mpu925x_t *mpu925x)
+{
+	uint8_t buffer = 0;
+
+	mpu925x_lock(mpu925x);
+	mpu925x->fifo.enabled = 0;
+	mpu925x->fifo.splits = 0;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, FIFO_EN, &buffer, 1);
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, I2C_MST_CTRL, &buffer, 1, (uint8_t)~I2C_MST_SLV_3_FIFO_EN);
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, USER_CTRL, &buffer, 1, USER_CTRL_I2C_MST_EN);
+	mpu925x_unlock(mpu925x);
+}
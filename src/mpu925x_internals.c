@@ -24,6 +24,7 @@
  * */
 
 #include "mpu925x_internals.h"
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -36,20 +37,27 @@ uint8_t __mpu925x_init(mpu925x_t *mpu925x)
 	uint8_t buffer;
 
 	// WHO_AM_I register should return 0x71 for MPU-9250 and 0x73 for MPU-9255.
-	mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, WHO_AM_I, &buffer, 1);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, WHO_AM_I, &buffer, 1);
 	if (buffer != 0x71 && buffer != 0x73)
 		return 1;
+	mpu925x->health.who_am_i = buffer;
 
 	// Enable PLL.
 	mpu925x_set_clock_source(mpu925x, mpu925x_auto_select_pll);
 
 	// Enable bypass.
 	buffer = 1 << 1;
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, INT_PIN_CFG, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, INT_PIN_CFG, &buffer, 1);
 
 	// Disable I2C master mode.
 	buffer = 0 << 5;
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, &buffer, 1);
+	mpu925x->aux.enabled = 0;
+	mpu925x->fifo.enabled = 0;
+
+	// GYRO_CONFIG and CONFIG are cleared by reset.
+	mpu925x->settings.gyroscope_config = 0;
+	mpu925x->settings.fsync = mpu925x_fsync_disabled;
 
 	// Set acceleration range.
 	mpu925x_set_accelerometer_scale(mpu925x, mpu925x->settings.accelerometer_scale);
@@ -57,6 +65,9 @@ uint8_t __mpu925x_init(mpu925x_t *mpu925x)
 	// Set gyro range.
 	mpu925x_set_gyroscope_scale(mpu925x, mpu925x->settings.gyroscope_scale);
 
+	// Prepare conversion matrices.
+	mpu925x_update_conversion(mpu925x);
+
 	// Set temperature lsb.
 	// mpu925x->settings.temperature_lsb = TEMPERATURE_SCALE;
 
@@ -66,38 +77,47 @@ uint8_t __mpu925x_init(mpu925x_t *mpu925x)
 /**
  * @brief Initialize magnetometer.
  * @param mpu925x MPU-925X struct pointer.
+ * @param warm If not 0, reset and fuse ROM read are skipped, sensitivity
+ * adjustment coefficients must already be in settings.
  * @returns 0 on success, 1 on failure.
  * */
-uint8_t __ak8963_init(mpu925x_t *mpu925x)
+uint8_t __ak8963_init(mpu925x_t *mpu925x, uint8_t warm)
 {
 	uint8_t buffer;
+	mpu925x_magnetometer_measurement_mode measurement_mode = mpu925x->settings.measurement_mode;
 
 	// Check WIA register. WIA register should return 0x48.
-	mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, WIA, &buffer, 1);
+	mpu925x_bus_read(mpu925x, AK8963_ADDRESS, WIA, &buffer, 1);
 	if (buffer != 0x48)
 		return 1;
 
-	// Reset AK8963.
-	ak8963_reset(mpu925x);
+	if (!warm) {
+		// Reset AK8963.
+		ak8963_reset(mpu925x);
 
-	// Set power down mode.
-	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_power_down_mode);
+		// Set power down mode.
+		mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_power_down_mode);
 
-	// Enable Fuse ROM access mode.
-	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_fuse_rom_access_mode);
+		// Enable Fuse ROM access mode.
+		mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_fuse_rom_access_mode);
 
-	// Read coefficient data and save it.
-	uint8_t coef_data[3];
-	mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, ASAX, coef_data, 3);
-	for (uint8_t i = 0; i < 3; i++) {
-		mpu925x->settings.magnetometer_coefficient[i] = (coef_data[i] - 128) * 0.5 / 128 + 1;
+		// Read coefficient data and save it.
+		uint8_t coef_data[3];
+		mpu925x_bus_read(mpu925x, AK8963_ADDRESS, ASAX, coef_data, 3);
+		for (uint8_t i = 0; i < 3; i++) {
+			mpu925x->settings.magnetometer_coefficient[i] = (coef_data[i] - 128) * 0.5 / 128 + 1;
+		}
+		mpu925x_update_conversion(mpu925x);
 	}
 
 	// Set power down mode.
 	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_power_down_mode);
 
-	// Set measurement and bit mode.
-	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_continuous_measurement_mode_2);
+	// Set measurement and bit mode. Measurement mode set before
+	// initialization is kept, continuous measurement mode 2 is default.
+	if (measurement_mode == mpu925x_power_down_mode || measurement_mode == mpu925x_fuse_rom_access_mode)
+		measurement_mode = mpu925x_continuous_measurement_mode_2;
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, measurement_mode);
 	mpu925x_set_magnetometer_bit_mode(mpu925x, mpu925x_16_bit);
 
 	return 0;
@@ -113,7 +133,7 @@ void mpu925x_get_accelerometer_bias(mpu925x_t *mpu925x, int16_t *bias)
 	uint8_t buffer[8];
 
 	// Read bias registers.
-	mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, XA_OFFSET_H, buffer, 8);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, XA_OFFSET_H, buffer, 8);
 
 	// Convert them to 16 bit.
 	for (uint8_t i = 0; i < 3; i++) {
@@ -122,19 +142,192 @@ void mpu925x_get_accelerometer_bias(mpu925x_t *mpu925x, int16_t *bias)
 }
 
 /**
- * @brief Write data to bus whilst preserving other bits (not ready for usage).
+ * @brief Multiply two 3x3 matrices.
+ * @param a Left matrix.
+ * @param b Right matrix.
+ * @param result Result matrix, must not be one of the operands.
+ * */
+static void multiply_matrix(float a[3][3], float b[3][3], float result[3][3])
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			result[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+		}
+	}
+}
+
+/**
+ * @brief Publish conversion snapshot from settings.
+ * 
+ * Conversion matrices are recalculated and magnetometer scale and bias
+ * values are copied from settings into the inactive snapshot, then version
+ * is incremented to make it active. Conversion functions never wait for this
+ * and never see a half updated snapshot. Must be called whenever calibration
+ * matrix, magnetometer coefficients, mounting matrix, magnetometer scale or
+ * biases change, so conversion functions only do one matrix multiplication
+ * per sample.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_update_conversion(mpu925x_t *mpu925x)
+{
+	float identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	// AK8963's x and y axes are swapped and z axis is inverted.
+	float magnetometer_alignment[3][3] = {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}};
+	float (*mounting)[3] = mpu925x->settings.body_frame ? mpu925x->settings.mounting_matrix : identity;
+	float (*calibration)[3] = mpu925x->settings.accelerometer_matrix_enabled ? mpu925x->settings.accelerometer_matrix : identity;
+	float (*alignment)[3] = mpu925x->settings.body_frame ? magnetometer_alignment : identity;
+	float sensitivity[3][3] = {{0}};
+	float magnetometer[3][3];
+	struct conversion_snapshot *snapshot;
+
+	// Publishers are serialized, readers don't take the lock.
+	mpu925x_lock(mpu925x);
+	snapshot = &mpu925x->conversion.snapshot[(mpu925x->conversion.version + 1) & 1];
+
+	for (uint8_t i = 0; i < 3; i++) {
+		sensitivity[i][i] = mpu925x->settings.magnetometer_coefficient[i];
+		snapshot->accelerometer_bias[i] = mpu925x->settings.accelerometer_bias[i];
+		snapshot->gyroscope_bias[i] = mpu925x->settings.gyroscope_bias[i];
+	}
+	snapshot->magnetometer_lsb = mpu925x->settings.magnetometer_lsb;
+
+	multiply_matrix(mounting, calibration, snapshot->accelerometer);
+	multiply_matrix(mounting, identity, snapshot->gyroscope);
+	multiply_matrix(alignment, sensitivity, magnetometer);
+	multiply_matrix(mounting, magnetometer, snapshot->magnetometer);
+
+	// Snapshot must be complete before it becomes visible.
+	memory_barrier();
+	mpu925x->conversion.version++;
+	mpu925x_unlock(mpu925x);
+}
+
+/**
+ * @brief Get active conversion snapshot.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param version Holds version of returned snapshot.
+ * @returns Active conversion snapshot.
+ * @see mpu925x_conversion_changed
+ * */
+const struct conversion_snapshot *mpu925x_conversion_acquire(mpu925x_t *mpu925x, uint32_t *version)
+{
+	*version = mpu925x->conversion.version;
+	memory_barrier();
+
+	return &mpu925x->conversion.snapshot[*version & 1];
+}
+
+/**
+ * @brief Check if conversion snapshot may have changed while being used.
+ * 
+ * Result calculated from an acquired snapshot is valid if this returns 0,
+ * otherwise it must be calculated again with a newly acquired snapshot.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param version Version from ``mpu925x_conversion_acquire``.
+ * @returns 1 if a setter published meanwhile, 0 otherwise.
+ * */
+uint8_t mpu925x_conversion_changed(mpu925x_t *mpu925x, uint32_t version)
+{
+	memory_barrier();
+
+	return mpu925x->conversion.version != version;
+}
+
+/**
+ * @brief Take bus lock, if lock hook is provided.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_lock(mpu925x_t *mpu925x)
+{
+	if (mpu925x->master_specific.lock != NULL)
+		mpu925x->master_specific.lock(mpu925x);
+}
+
+/**
+ * @brief Release bus lock, if unlock hook is provided.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_unlock(mpu925x_t *mpu925x)
+{
+	if (mpu925x->master_specific.unlock != NULL)
+		mpu925x->master_specific.unlock(mpu925x);
+}
+
+/**
+ * @brief Read from bus in a single locked transaction.
+ * 
+ * While auxiliary I2C master is enabled, AK8963 is not on the bus and its
+ * reads are served by auxiliary I2C master.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param slave_address Slave address of the sensor.
+ * @param reg Start register.
+ * @param buffer Data buffer.
+ * @param size Data buffer size.
+ * @returns Return value of ``master_specific.bus_read``.
+ * */
+uint8_t mpu925x_bus_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	uint8_t return_value;
+
+	mpu925x_lock(mpu925x);
+	if (slave_address == AK8963_ADDRESS && mpu925x->aux.enabled)
+		return_value = mpu925x_aux_ak8963_read(mpu925x, reg, buffer, size);
+	else
+		return_value = mpu925x->master_specific.bus_read(mpu925x, slave_address, reg, buffer, size);
+	mpu925x_unlock(mpu925x);
+
+	return return_value;
+}
+
+/**
+ * @brief Write to bus in a single locked transaction.
+ * 
+ * While auxiliary I2C master is enabled, AK8963 writes go through it.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param slave_address Slave address of the sensor.
+ * @param reg Start register.
+ * @param buffer Data buffer.
+ * @param size Data buffer size.
+ * @returns Return value of ``master_specific.bus_write``.
+ * */
+uint8_t mpu925x_bus_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	uint8_t return_value;
+
+	mpu925x_lock(mpu925x);
+	if (slave_address == AK8963_ADDRESS && mpu925x->aux.enabled)
+		return_value = mpu925x_aux_ak8963_write(mpu925x, reg, buffer, size);
+	else
+		return_value = mpu925x->master_specific.bus_write(mpu925x, slave_address, reg, buffer, size);
+	mpu925x_unlock(mpu925x);
+
+	return return_value;
+}
+
+/**
+ * @brief Write data to bus whilst preserving other bits.
+ * 
+ * Each register is read, masked, merged and written back while bus lock is
+ * held, so read-modify-write isn't interleaved with other transactions.
  * @param mpu925x MPU-925X struct pointer.
+ * @param slave_address Slave address of the sensor.
+ * @param reg Start register.
+ * @param buffer Bits to be set, one byte per register.
+ * @param size Number of registers.
+ * @param and_sentence Mask of bits to be preserved.
  * */
 void mpu925x_bus_write_preserve(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size, uint8_t and_sentence)
 {
 	uint8_t read_buffer;
 
+	mpu925x_lock(mpu925x);
 	for (uint16_t i = 0; i < size; i++) {
-		mpu925x->master_specific.bus_read(mpu925x, mpu925x->settings.address, reg, &read_buffer, size);
+		mpu925x->master_specific.bus_read(mpu925x, slave_address, reg + i, &read_buffer, 1);
 		read_buffer &= and_sentence;
 		read_buffer |= buffer[i];
-		mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, reg, &read_buffer, size);
+		mpu925x->master_specific.bus_write(mpu925x, slave_address, reg + i, &read_buffer, 1);
 	}
+	mpu925x_unlock(mpu925x);
 }
 
 /**
@@ -144,7 +337,7 @@ void mpu925x_bus_write_preserve(mpu925x_t *mpu925x, uint8_t slave_address, uint8
 void mpu925x_reset(mpu925x_t *mpu925x)
 {
 	uint8_t buffer = 1 << 7;
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, PWR_MGMT_1, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, PWR_MGMT_1, &buffer, 1);
 	mpu925x->master_specific.delay_ms(mpu925x, 100);
 }
 
@@ -155,6 +348,276 @@ void mpu925x_reset(mpu925x_t *mpu925x)
 void ak8963_reset(mpu925x_t *mpu925x)
 {
 	uint8_t buffer = 1;
-	mpu925x->master_specific.bus_write(mpu925x, AK8963_ADDRESS, CNTL2, &buffer, 1);
+	mpu925x_bus_write(mpu925x, AK8963_ADDRESS, CNTL2, &buffer, 1);
 	mpu925x->master_specific.delay_ms(mpu925x, 100);
 }
+
+// Accelerometer lsb values of each full-scale range.
+const float mpu925x_acceleration_lsb[4] = {
+	ACCELEROMETER_SCALE_2G, ACCELEROMETER_SCALE_4G, ACCELEROMETER_SCALE_8G, ACCELEROMETER_SCALE_16G
+};
+
+// Gyroscope lsb values of each full-scale range.
+const float mpu925x_gyroscope_lsb[4] = {
+	GYROSCOPE_SCALE_250_DPS, GYROSCOPE_SCALE_500_DPS, GYROSCOPE_SCALE_1000_DPS, GYROSCOPE_SCALE_2000_DPS
+};
+
+/**
+ * @brief Check if any axis is at the limit of full-scale range.
+ * @param raw 3d raw data array.
+ * @returns 1 if saturated, 0 otherwise.
+ * */
+static uint8_t saturated(const int16_t *raw)
+{
+	uint8_t result = 0;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		result |= raw[i] == INT16_MAX || raw[i] == INT16_MIN;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Count consecutive samples of a condition, saturating at 0xFFFF.
+ * @param run Run counter.
+ * @param condition Condition of current sample.
+ * @returns New run counter.
+ * */
+static uint16_t count_run(uint16_t run, uint8_t condition)
+{
+	if (!condition)
+		return 0;
+
+	return run < UINT16_MAX ? run + 1 : run;
+}
+
+/**
+ * @brief Check health of last sample.
+ * 
+ * Only data already in ``sensor_data`` is used, so there are no bus
+ * transactions.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param magnetometer Magnetometer is read with this sample.
+ * */
+void mpu925x_health_update(mpu925x_t *mpu925x, uint8_t magnetometer)
+{
+	struct health *health = &mpu925x->health;
+	int16_t frame[7];
+	uint8_t flags = 0, identical = 1, disconnected = 1;
+
+	if (!health->enabled)
+		return;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		frame[i] = mpu925x->sensor_data.acceleration_raw[i];
+		frame[i + 3] = mpu925x->sensor_data.rotation_raw[i];
+	}
+	frame[6] = mpu925x->sensor_data.temperature_raw;
+
+	// Disconnected bus reads 0xFF, which is -1 in every output.
+	for (uint8_t i = 0; i < 7; i++) {
+		identical &= frame[i] == health->previous[i];
+		disconnected &= frame[i] == -1;
+		health->previous[i] = frame[i];
+	}
+
+	if (saturated(mpu925x->sensor_data.acceleration_raw)) {
+		flags |= MPU925X_HEALTH_ACCELEROMETER_SATURATED;
+		health->accelerometer_saturations++;
+	}
+	if (saturated(mpu925x->sensor_data.rotation_raw)) {
+		flags |= MPU925X_HEALTH_GYROSCOPE_SATURATED;
+		health->gyroscope_saturations++;
+	}
+
+	health->stuck_run = count_run(health->stuck_run, identical);
+	if (health->stuck_run >= (health->stuck_limit ? health->stuck_limit : HEALTH_STUCK_LIMIT)) {
+		flags |= MPU925X_HEALTH_STUCK;
+		health->stuck_samples++;
+	}
+
+	if (magnetometer && (mpu925x->sensor_data.magnetometer_status & MPU925X_MAGNETOMETER_OVERFLOW)) {
+		flags |= MPU925X_HEALTH_MAGNETOMETER_OVERFLOW;
+		health->magnetometer_overflows++;
+	}
+
+	if (disconnected) {
+		flags |= MPU925X_HEALTH_IDENTITY;
+		health->identity_errors++;
+	}
+
+	float minimum = HEALTH_TEMPERATURE_MINIMUM, maximum = HEALTH_TEMPERATURE_MAXIMUM;
+	if (health->temperature_minimum != health->temperature_maximum) {
+		minimum = health->temperature_minimum;
+		maximum = health->temperature_maximum;
+	}
+	float temperature = frame[6] / TEMPERATURE_SCALE + 21;
+	if (temperature < minimum || temperature > maximum) {
+		flags |= MPU925X_HEALTH_TEMPERATURE;
+		health->temperature_errors++;
+	}
+
+	health->flags = flags;
+	health->latched |= flags;
+}
+
+/**
+ * @brief Get full-scale range for next samples of a sensor.
+ * @param raw 3d raw data of last sample.
+ * @param range Range of last sample.
+ * @param quiet Counter of consecutive samples which fit in lower range.
+ * @param up Up threshold in raw units.
+ * @param down Down threshold in raw units of current range.
+ * @param hold Quiet samples before range is decreased.
+ * @returns New range, from 0 to 3.
+ * */
+static uint8_t next_range(const int16_t *raw, uint8_t range, uint16_t *quiet, int32_t up, int32_t down, uint16_t hold)
+{
+	int32_t peak = 0;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		int32_t value = raw[i] < 0 ? -(int32_t)raw[i] : raw[i];
+		peak = value > peak ? value : peak;
+	}
+
+	if (peak >= up && range < 3) {
+		*quiet = 0;
+		return range + 1;
+	}
+
+	if (peak >= down || range == 0) {
+		*quiet = 0;
+		return range;
+	}
+
+	if (++*quiet < hold)
+		return range;
+
+	*quiet = 0;
+	return range - 1;
+}
+
+/**
+ * @brief Update automatic full-scale ranges from last sample.
+ * 
+ * Each transition is a single register write (and a FIFO count read while
+ * FIFO capture runs), last sample stays tagged with the range it was read
+ * under.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_auto_range_update(mpu925x_t *mpu925x)
+{
+	struct auto_range *auto_range = &mpu925x->auto_range;
+	float up_threshold = auto_range->up_threshold > 0 ? auto_range->up_threshold : AUTO_RANGE_UP_THRESHOLD;
+	float down_threshold = auto_range->down_threshold > 0 ? auto_range->down_threshold : AUTO_RANGE_DOWN_THRESHOLD;
+	uint16_t hold = auto_range->hold ? auto_range->hold : AUTO_RANGE_HOLD;
+	// Lower range has half of the span, so its limits are halved in raw units.
+	int32_t up = up_threshold * 32768, down = down_threshold * 16384;
+	uint8_t range;
+
+	if (auto_range->accelerometer) {
+		range = next_range(mpu925x->sensor_data.acceleration_raw, mpu925x->sensor_data.accelerometer_scale, &auto_range->accelerometer_quiet, up, down, hold);
+		if (range != mpu925x->settings.accelerometer_scale) {
+			mpu925x_set_accelerometer_scale(mpu925x, range);
+			auto_range->transitions++;
+		}
+	}
+
+	if (auto_range->gyroscope) {
+		range = next_range(mpu925x->sensor_data.rotation_raw, mpu925x->sensor_data.gyroscope_scale, &auto_range->gyroscope_quiet, up, down, hold);
+		if (range != mpu925x->settings.gyroscope_scale) {
+			mpu925x_set_gyroscope_scale(mpu925x, range);
+			auto_range->transitions++;
+		}
+	}
+}
+
+/**
+ * @brief Record a FIFO split point before a full-scale range change.
+ * 
+ * Frames in FIFO at this point were captured under current ranges. Must be
+ * called with bus lock held, before range register is written.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_fifo_split(mpu925x_t *mpu925x)
+{
+	struct fifo *fifo = &mpu925x->fifo;
+	uint8_t buffer[2];
+
+	if (!fifo->enabled || fifo->dropped)
+		return;
+
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_COUNTH, buffer, 2);
+	uint16_t count = convert8bitto16bit(buffer[0] & 0x1F, buffer[1]);
+
+	// No frame was captured since previous change.
+	if (fifo->splits > 0 && fifo->split[fifo->splits - 1] == count)
+		return;
+
+	if (fifo->splits == MPU925X_FIFO_SPLITS) {
+		fifo->dropped = 1;
+		return;
+	}
+
+	fifo->split[fifo->splits] = count;
+	fifo->accelerometer_scale[fifo->splits] = mpu925x->settings.accelerometer_scale;
+	fifo->gyroscope_scale[fifo->splits] = mpu925x->settings.gyroscope_scale;
+	fifo->splits++;
+}
+
+/**
+ * @brief Calculate CRC-16/CCITT-FALSE checksum.
+ * @param data Data array.
+ * @param size Size of data array.
+ * @returns Checksum.
+ * */
+uint16_t mpu925x_crc16(const uint8_t *data, uint16_t size)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (uint16_t i = 0; i < size; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (uint8_t j = 0; j < 8; j++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+
+	return crc;
+}
+
+/**
+ * @brief Store float in 4 bytes little endian IEEE-754 format.
+ * @param buffer Destination, at least 4 bytes.
+ * @param value Value to be stored.
+ * */
+void mpu925x_pack_float(uint8_t *buffer, float value)
+{
+	union {
+		float f;
+		uint32_t u;
+	} bits = {.f = value};
+
+	for (uint8_t i = 0; i < 4; i++) {
+		buffer[i] = (uint8_t)(bits.u >> (i * 8));
+	}
+}
+
+/**
+ * @brief Load float from 4 bytes little endian IEEE-754 format.
+ * @param buffer Source, at least 4 bytes.
+ * @returns Loaded value.
+ * */
+float mpu925x_unpack_float(const uint8_t *buffer)
+{
+	union {
+		float f;
+		uint32_t u;
+	} bits = {.u = 0};
+
+	for (uint8_t i = 0; i < 4; i++) {
+		bits.u |= (uint32_t)buffer[i] << (i * 8);
+	}
+
+	return bits.f;
+}
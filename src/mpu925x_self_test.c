@@ -0,0 +1,307 @@
+/**
+ * @file
+ * @author Ceyhun Şen
+ * @brief Self-test functions for MPU-925X driver.
+ * */
+
+/*
+ * MPU-925X Driver is a device driver for MPU-9250 and MPU-9255 sensors.
+ * Copyright (C) 2022  Ceyhun Şen
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see:
+ * <https://www.gnu.org/licenses/>.
+ * */
+
+#include "mpu925x_internals.h"
+#include <stdint.h>
+
+// Accelerometer and gyroscope frame size in FIFO.
+#define FRAME_SIZE 12
+
+// Whole frames which fit in one bus transaction.
+#define FRAMES_PER_READ (255 / FRAME_SIZE)
+
+/**
+ * @brief Average accelerometer and gyroscope samples through FIFO.
+ * 
+ * FIFO is filled at 1 kHz and drained in large bursts, so sample window is
+ * collected in about its own duration with few bus transactions. Each fill
+ * takes about half of FIFO, if it still overflows FIFO is restarted.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param average Averages of acceleration (first 3) and rotation (last 3) in
+ * LSB.
+ * @param master ``USER_CTRL_I2C_MST_EN`` if auxiliary I2C master is kept
+ * enabled, 0 otherwise.
+ * @returns 0 on success, 1 if FIFO doesn't fill or keeps overflowing.
+ * */
+static uint8_t fifo_average(mpu925x_t *mpu925x, float *average, uint8_t master)
+{
+	uint8_t buffer[FRAMES_PER_READ * FRAME_SIZE];
+	int32_t sum[6] = {0};
+	uint16_t count = 0;
+
+	// Reset FIFO and enable accelerometer and gyroscope.
+	buffer[0] = master | USER_CTRL_FIFO_RST;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1);
+	buffer[0] = FIFO_ACCEL | FIFO_GYRO;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, FIFO_EN, buffer, 1);
+	buffer[0] = master | USER_CTRL_FIFO_EN;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1);
+
+	// Clear stale overflow flag.
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, INT_STATUS, buffer, 1);
+
+	for (uint8_t tries = 0; count < SELF_TEST_SAMPLES; tries++) {
+		if (tries == SELF_TEST_FIFO_TRIES)
+			return 1;
+
+		mpu925x->master_specific.delay_ms(mpu925x, SELF_TEST_FIFO_FILL_MS);
+
+		// Frame boundaries are lost after an overflow, restart FIFO and
+		// keep samples averaged so far.
+		mpu925x_bus_read(mpu925x, mpu925x->settings.address, INT_STATUS, buffer, 1);
+		if (buffer[0] & MPU925X_INTERRUPT_FIFO_OVERFLOW) {
+			buffer[0] = master | USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RST;
+			mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1);
+			continue;
+		}
+
+		mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_COUNTH, buffer, 2);
+		uint16_t frames = (convert8bitto16bit(buffer[0] & 0x1F, buffer[1])) / FRAME_SIZE;
+		if (frames > SELF_TEST_SAMPLES - count)
+			frames = SELF_TEST_SAMPLES - count;
+
+		while (frames > 0) {
+			uint8_t size = frames > FRAMES_PER_READ ? FRAMES_PER_READ : frames;
+			mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_R_W, buffer, size * FRAME_SIZE);
+			for (uint8_t i = 0; i < size; i++) {
+				for (uint8_t j = 0; j < 6; j++) {
+					sum[j] += (int16_t)convert8bitto16bit(buffer[i * FRAME_SIZE + j * 2], buffer[i * FRAME_SIZE + j * 2 + 1]);
+				}
+			}
+			frames -= size;
+			count += size;
+		}
+	}
+
+	// Stop FIFO.
+	buffer[0] = 0;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, FIFO_EN, buffer, 1);
+	buffer[0] = master;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, buffer, 1);
+
+	for (uint8_t i = 0; i < 6; i++) {
+		average[i] = (float)sum[i] / count;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Calculate factory self-test response from self-test code.
+ * @param code Self-test code from SELF_TEST registers.
+ * @returns Factory self-test response in LSB, 0 if code isn't programmed.
+ * */
+static float factory_response(uint8_t code)
+{
+	float response = SELF_TEST_OTP_BASE;
+
+	if (code == 0)
+		return 0;
+
+	// 2620 * 1.01 ^ (code - 1)
+	for (uint8_t i = 1; i < code; i++) {
+		response *= 1.01f;
+	}
+
+	return response;
+}
+
+/**
+ * @brief Run accelerometer and gyroscope self-test.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param result Self-test result struct pointer.
+ * */
+static void gyroscope_accelerometer_self_test(mpu925x_t *mpu925x, mpu925x_self_test_result *result)
+{
+	uint8_t saved[5], saved_fifo[2], buffer[5], master;
+	float normal[6], self_test[6];
+	uint8_t gyroscope_code[3], accelerometer_code[3];
+
+	// Save SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG, ACCEL_CONFIG_2,
+	// FIFO_EN and USER_CTRL.
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, SMPLRT_DIV, saved, 5);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, FIFO_EN, &saved_fifo[0], 1);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, USER_CTRL, &saved_fifo[1], 1);
+	master = saved_fifo[1] & USER_CTRL_I2C_MST_EN;
+
+	// 1 kHz, 92 Hz DLPF, 250 dps and 2 g.
+	buffer[0] = 0;
+	buffer[1] = SELF_TEST_DLPF;
+	buffer[2] = 0;
+	buffer[3] = 0;
+	buffer[4] = SELF_TEST_DLPF;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, SMPLRT_DIV, buffer, 5);
+	mpu925x->master_specific.delay_ms(mpu925x, SELF_TEST_SETTLE_MS);
+	uint8_t timeout = fifo_average(mpu925x, normal, master);
+
+	// Enable self-test on all axes.
+	buffer[2] = SELF_TEST_ENABLE;
+	buffer[3] = SELF_TEST_ENABLE;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, SMPLRT_DIV, buffer, 5);
+	mpu925x->master_specific.delay_ms(mpu925x, SELF_TEST_SETTLE_MS);
+	timeout |= fifo_average(mpu925x, self_test, master);
+
+	// Restore settings, FIFO is reset so no self-test frame is left in it.
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, SMPLRT_DIV, saved, 5);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, FIFO_EN, &saved_fifo[0], 1);
+	saved_fifo[1] |= USER_CTRL_FIFO_RST;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, USER_CTRL, &saved_fifo[1], 1);
+	mpu925x->master_specific.delay_ms(mpu925x, SELF_TEST_SETTLE_MS);
+
+	if (timeout) {
+		result->accelerometer_failed = 0b111;
+		result->gyroscope_failed = 0b111;
+		return;
+	}
+
+	// Read factory self-test codes.
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, SELF_TEST_X_GYRO, gyroscope_code, 3);
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, SELF_TEST_X_ACCEL, accelerometer_code, 3);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		// Gyroscope.
+		float response = self_test[i + 3] - normal[i + 3];
+		float factory = factory_response(gyroscope_code[i]);
+		result->gyroscope_offset[i] = normal[i + 3] / GYROSCOPE_SCALE_250_DPS;
+		result->gyroscope_response[i] = response / GYROSCOPE_SCALE_250_DPS;
+		result->gyroscope_deviation[i] = 0;
+		if (factory != 0) {
+			result->gyroscope_deviation[i] = response / factory - 1;
+			if (response / factory <= SELF_TEST_GYROSCOPE_RATIO)
+				result->gyroscope_failed |= 1 << i;
+		}
+		else if (result->gyroscope_response[i] < SELF_TEST_GYROSCOPE_MINIMUM && result->gyroscope_response[i] > -SELF_TEST_GYROSCOPE_MINIMUM) {
+			result->gyroscope_failed |= 1 << i;
+		}
+		if (result->gyroscope_offset[i] > SELF_TEST_GYROSCOPE_OFFSET || result->gyroscope_offset[i] < -SELF_TEST_GYROSCOPE_OFFSET)
+			result->gyroscope_failed |= 1 << i;
+
+		// Accelerometer.
+		response = self_test[i] - normal[i];
+		factory = factory_response(accelerometer_code[i]);
+		result->accelerometer_response[i] = response / ACCELEROMETER_SCALE_2G;
+		result->accelerometer_deviation[i] = 0;
+		if (factory != 0) {
+			result->accelerometer_deviation[i] = response / factory - 1;
+			if (result->accelerometer_deviation[i] < -SELF_TEST_ACCELEROMETER_RATIO || result->accelerometer_deviation[i] > SELF_TEST_ACCELEROMETER_RATIO)
+				result->accelerometer_failed |= 1 << i;
+		}
+		else {
+			float magnitude = result->accelerometer_response[i] < 0 ? -result->accelerometer_response[i] : result->accelerometer_response[i];
+			if (magnitude < SELF_TEST_ACCELEROMETER_MINIMUM || magnitude > SELF_TEST_ACCELEROMETER_MAXIMUM)
+				result->accelerometer_failed |= 1 << i;
+		}
+	}
+}
+
+/**
+ * @brief Run AK8963 self-test.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param result Self-test result struct pointer.
+ * */
+static void magnetometer_self_test(mpu925x_t *mpu925x, mpu925x_self_test_result *result)
+{
+	mpu925x_magnetometer_measurement_mode measurement_mode = mpu925x->settings.measurement_mode;
+	uint8_t buffer[8];
+	uint8_t tries;
+
+	// Generate magnetic field for self-test and start measurement.
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_power_down_mode);
+	buffer[0] = ASTC_SELF;
+	mpu925x_bus_write(mpu925x, AK8963_ADDRESS, ASTC, buffer, 1);
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_self_test_mode);
+
+	// Wait for data ready and read ST1 to ST2.
+	for (tries = 0; tries < SELF_TEST_MAGNETOMETER_TRIES; tries++) {
+		mpu925x->master_specific.delay_ms(mpu925x, 1);
+		mpu925x_bus_read(mpu925x, AK8963_ADDRESS, ST1, buffer, 8);
+		if (buffer[0] & 1)
+			break;
+	}
+
+	// Stop self-test and restore measurement mode.
+	uint8_t astc = 0;
+	mpu925x_bus_write(mpu925x, AK8963_ADDRESS, ASTC, &astc, 1);
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, mpu925x_power_down_mode);
+	mpu925x_set_magnetometer_measurement_mode(mpu925x, measurement_mode);
+
+	if (tries == SELF_TEST_MAGNETOMETER_TRIES || (buffer[7] & 0x08)) {
+		result->magnetometer_failed = 0b111;
+		return;
+	}
+
+	// Adjust with sensitivity adjustment values, limits are 4 times smaller
+	// in 14 bit mode.
+	int16_t divider = mpu925x->settings.bit_mode == mpu925x_16_bit ? 1 : 4;
+	int16_t minimum[3] = {-SELF_TEST_MAGNETOMETER_XY_16_BIT / divider, -SELF_TEST_MAGNETOMETER_XY_16_BIT / divider, SELF_TEST_MAGNETOMETER_Z_MINIMUM_16_BIT / divider};
+	int16_t maximum[3] = {SELF_TEST_MAGNETOMETER_XY_16_BIT / divider, SELF_TEST_MAGNETOMETER_XY_16_BIT / divider, SELF_TEST_MAGNETOMETER_Z_MAXIMUM_16_BIT / divider};
+	for (uint8_t i = 0; i < 3; i++) {
+		int16_t raw = convert8bitto16bit(buffer[i * 2 + 2], buffer[i * 2 + 1]);
+		result->magnetometer_response[i] = raw * mpu925x->settings.magnetometer_coefficient[i];
+		if (result->magnetometer_response[i] < minimum[i] || result->magnetometer_response[i] > maximum[i])
+			result->magnetometer_failed |= 1 << i;
+	}
+}
+
+/**
+ * @brief Run self-test of gyroscope, accelerometer and magnetometer.
+ * 
+ * Follows datasheet procedure: gyroscope and accelerometer outputs are
+ * averaged over 200 samples at 1 kHz with self-test disabled and enabled,
+ * through FIFO, and their difference is compared against factory self-test
+ * responses. Magnetometer is measured with internal self-test field.
+ * Sensor must be stationary. Register settings and magnetometer mode are
+ * restored at the end and FIFO is reset, whole test takes about half a
+ * second. Test isn't run while ``mpu925x_fifo_start`` capture is running, its
+ * FIFO contents would be lost.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param result Self-test result struct pointer.
+ * @returns 0 if all sensors pass, otherwise failed sensor flags, or
+ * ``MPU925X_SELF_TEST_BUSY`` if FIFO capture is running.
+ * @see MPU925X_SELF_TEST_GYROSCOPE
+ * */
+uint8_t mpu925x_self_test(mpu925x_t *mpu925x, mpu925x_self_test_result *result)
+{
+	uint8_t return_value = 0;
+
+	result->gyroscope_failed = 0;
+	result->accelerometer_failed = 0;
+	result->magnetometer_failed = 0;
+
+	if (mpu925x->fifo.enabled)
+		return MPU925X_SELF_TEST_BUSY;
+
+	gyroscope_accelerometer_self_test(mpu925x, result);
+	magnetometer_self_test(mpu925x, result);
+
+	if (result->gyroscope_failed)
+		return_value |= MPU925X_SELF_TEST_GYROSCOPE;
+	if (result->accelerometer_failed)
+		return_value |= MPU925X_SELF_TEST_ACCELEROMETER;
+	if (result->magnetometer_failed)
+		return_value |= MPU925X_SELF_TEST_MAGNETOMETER;
+
+	return return_value;
+}
@@ -24,6 +24,7 @@
  * */
 
 #include "mpu925x_internals.h"
+#include <stddef.h>
 #include <stdint.h>
 
 /*******************************************************************************
@@ -37,7 +38,7 @@
  * */
 void mpu925x_set_sample_rate_divider(mpu925x_t *mpu925x, uint8_t sample_rate_divider)
 {
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, SMPLRT_DIV, &sample_rate_divider, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, SMPLRT_DIV, &sample_rate_divider, 1);
 }
 
 /**
@@ -63,25 +64,215 @@ void mpu925x_set_clock_source(mpu925x_t *mpu925x, mpu925x_clock clock)
 	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, PWR_MGMT_1, &buffer, 1, 0b11111000);
 }
 
+/**
+ * @brief Set mounting matrix and enable body frame output.
+ * 
+ * Mounting matrix rotates chip frame (accelerometer and gyroscope axes) to
+ * body frame. In body frame, magnetometer axes are also aligned to
+ * accelerometer axes, so all nine axes are in the same frame. Transform is
+ * fused into conversion matrices, so it has no extra per-sample cost.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param matrix Chip to body rotation (or signed permutation) matrix, NULL
+ * to disable body frame and use chip frame of each sensor.
+ * */
+void mpu925x_set_mounting_matrix(mpu925x_t *mpu925x, float matrix[3][3])
+{
+	if (matrix == NULL) {
+		mpu925x->settings.body_frame = 0;
+	}
+	else {
+		for (uint8_t i = 0; i < 3; i++) {
+			for (uint8_t j = 0; j < 3; j++) {
+				mpu925x->settings.mounting_matrix[i][j] = matrix[i][j];
+			}
+		}
+		mpu925x->settings.body_frame = 1;
+	}
+
+	mpu925x_update_conversion(mpu925x);
+}
+
+/**
+ * @brief Publish settings to conversion functions.
+ * 
+ * Setters publish by themselves, this is only needed after writing software
+ * biases in ``settings`` directly. Conversion functions running in other
+ * threads switch to new values at once and never wait for publication.
+ * @param mpu925x MPU-925X struct pointer.
+ * */
+void mpu925x_publish_settings(mpu925x_t *mpu925x)
+{
+	mpu925x_update_conversion(mpu925x);
+}
+
 /*******************************************************************************
  * Accelerometer settings
  ******************************************************************************/
 
+/**
+ * @brief Put sensor in wake-on-motion mode.
+ * 
+ * Gyroscope is disabled and accelerometer wakes up at given rate, compares
+ * each sample with the previous one and raises wake-on-motion interrupt if
+ * any axis changed more than threshold. Host can sleep until INT pin
+ * asserts. Magnetometer is not touched, it can be put in power-down mode to
+ * save more power.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param threshold Threshold in g's, from 0.004 to 1.02.
+ * @param rate Accelerometer wake-up rate.
+ * @see mpu925x_wake_on_motion_disable
+ * */
+void mpu925x_wake_on_motion_enable(mpu925x_t *mpu925x, float threshold, mpu925x_wake_on_motion_rate rate)
+{
+	uint8_t buffer;
+	float lsb = threshold / WOM_THRESHOLD_LSB + 0.5;
+
+	mpu925x_lock(mpu925x);
+
+	// Accelerometer only, with 184 Hz low pass filter.
+	buffer = PWR_MGMT_2_DISABLE_GYRO;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, PWR_MGMT_2, &buffer, 1);
+	buffer = WOM_ACCEL_CONFIG_2;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG_2, &buffer, 1);
+
+	// Enable interrupt and motion detection.
+	buffer = WOM_INT_ENABLE;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, INT_ENABLE, &buffer, 1);
+	buffer = WOM_MOT_DETECT_CTRL;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, MOT_DETECT_CTRL, &buffer, 1);
+	buffer = lsb > 255 ? 255 : (lsb < 1 ? 1 : lsb);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, WOM_THR, &buffer, 1);
+	buffer = rate;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, LP_ACCEL_ODR, &buffer, 1);
+
+	// Start cycling.
+	buffer = PWR_MGMT_1_CYCLE;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, PWR_MGMT_1, &buffer, 1, (uint8_t)~PWR_MGMT_1_CYCLE);
+
+	mpu925x_unlock(mpu925x);
+}
+
+/**
+ * @brief Leave wake-on-motion mode and restore normal measurement.
+ * @param mpu925x MPU-925X struct pointer.
+ * @see mpu925x_wake_on_motion_enable
+ * */
+void mpu925x_wake_on_motion_disable(mpu925x_t *mpu925x)
+{
+	uint8_t buffer = 0;
+
+	mpu925x_lock(mpu925x);
+
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, PWR_MGMT_1, &buffer, 1, (uint8_t)~PWR_MGMT_1_CYCLE);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, MOT_DETECT_CTRL, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, INT_ENABLE, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, PWR_MGMT_2, &buffer, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG_2, &mpu925x->settings.accelerometer_config_2, 1);
+
+	mpu925x_unlock(mpu925x);
+}
+
+/**
+ * @brief Read and clear interrupt status.
+ * @param mpu925x MPU-925X struct pointer.
+ * @returns ``MPU925X_INTERRUPT_*`` flags.
+ * */
+uint8_t mpu925x_get_interrupt_status(mpu925x_t *mpu925x)
+{
+	uint8_t buffer;
+
+	mpu925x_bus_read(mpu925x, mpu925x->settings.address, INT_STATUS, &buffer, 1);
+
+	return buffer;
+}
+
+/**
+ * @brief Configure FSYNC pin.
+ * 
+ * FSYNC pin (e.g. exposure strobe of a camera) is latched and its state
+ * replaces least significant bit of selected output at every sample, so it
+ * is aligned with sensor data in registers and in FIFO. Optionally FSYNC pin
+ * also raises ``MPU925X_INTERRUPT_FSYNC``.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param fsync Output which holds FSYNC state, or ``mpu925x_fsync_disabled``.
+ * @param active_low FSYNC pin is active low if not 0.
+ * @param interrupt FSYNC pin is used as interrupt if not 0.
+ * @see mpu925x_fsync_flag
+ * */
+void mpu925x_set_fsync(mpu925x_t *mpu925x, mpu925x_fsync fsync, uint8_t active_low, uint8_t interrupt)
+{
+	uint8_t buffer;
+
+	mpu925x_lock(mpu925x);
+
+	buffer = (fsync & 0b111) << 3;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, CONFIG, &buffer, 1, (uint8_t)~CONFIG_EXT_SYNC_SET);
+	buffer = (active_low ? INT_PIN_CFG_ACTL_FSYNC : 0) | (interrupt ? INT_PIN_CFG_FSYNC_INT_MODE_EN : 0);
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, INT_PIN_CFG, &buffer, 1, (uint8_t)~(INT_PIN_CFG_ACTL_FSYNC | INT_PIN_CFG_FSYNC_INT_MODE_EN));
+	buffer = interrupt ? FSYNC_INT_EN : 0;
+	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, INT_ENABLE, &buffer, 1, (uint8_t)~FSYNC_INT_EN);
+	mpu925x->settings.fsync = fsync & 0b111;
+
+	mpu925x_unlock(mpu925x);
+}
+
+/**
+ * @brief Get latched FSYNC state of a sample.
+ * 
+ * Works on register reads and FIFO frames, selected output must be in
+ * sample.
+ * @param fsync Output which holds FSYNC state.
+ * @param acceleration_raw Raw acceleration of sample.
+ * @param temperature_raw Raw temperature of sample.
+ * @param rotation_raw Raw rotation of sample.
+ * @returns FSYNC state, 0 if FSYNC is disabled.
+ * */
+uint8_t mpu925x_fsync_flag(mpu925x_fsync fsync, const int16_t *acceleration_raw, int16_t temperature_raw, const int16_t *rotation_raw)
+{
+	switch (fsync) {
+		case mpu925x_fsync_temperature:
+			return temperature_raw & 1;
+		case mpu925x_fsync_gyroscope_x:
+		case mpu925x_fsync_gyroscope_y:
+		case mpu925x_fsync_gyroscope_z:
+			return rotation_raw[fsync - mpu925x_fsync_gyroscope_x] & 1;
+		case mpu925x_fsync_accelerometer_x:
+		case mpu925x_fsync_accelerometer_y:
+		case mpu925x_fsync_accelerometer_z:
+			return acceleration_raw[fsync - mpu925x_fsync_accelerometer_x] & 1;
+		default:
+			return 0;
+	}
+}
+
 /**
  * @brief Set accelerometer full-scale range.
+ * 
+ * Range is changed with a single register write. Samples read afterwards are
+ * tagged with new range, samples already read keep their tag. While FIFO
+ * capture runs, FIFO count is read first to split queued frames.
  * @param mpu925x MPU-925X struct pointer.
  * @param scale Accelerometer full-scale range to be set.
  * */
 void mpu925x_set_accelerometer_scale(mpu925x_t *mpu925x, mpu925x_accelerometer_scale scale)
 {
 	// Get ACCEL_FS_SEL value.
-	uint8_t ACCEL_FS_SEL = scale << 3;
+	uint8_t ACCEL_FS_SEL = (scale & 0b11) << 3;
+
+	// Register and tag of next samples are changed together.
+	mpu925x_lock(mpu925x);
 
-	// Set accelerometer lsb.
-	mpu925x->settings.acceleration_lsb = INT16_MAX / powerof2(scale) / 2 + 1;
+	if ((scale & 0b11) != mpu925x->settings.accelerometer_scale)
+		mpu925x_fifo_split(mpu925x);
+
+	// Save scale and set accelerometer lsb.
+	mpu925x->settings.accelerometer_scale = scale & 0b11;
+	mpu925x->settings.acceleration_lsb = mpu925x_acceleration_lsb[scale & 0b11];
 
 	// Write register.
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG, &ACCEL_FS_SEL, 1);
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG, &ACCEL_FS_SEL, 1);
+
+	mpu925x_unlock(mpu925x);
 }
 
 /**
@@ -99,7 +290,9 @@ void mpu925x_set_accelerometer_dlpf(mpu925x_t *mpu925x, uint8_t a_fchoice, uint8
 
 	buffer |= dlpf & 0b111;
 
-	mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG_2, &buffer, 1);
+	// Saved for restoring after wake-on-motion.
+	mpu925x->settings.accelerometer_config_2 = buffer;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, ACCEL_CONFIG_2, &buffer, 1);
 }
 
 /**
@@ -125,19 +318,21 @@ void mpu925x_accelerometer_offset_cancellation(mpu925x_t *mpu925x, uint16_t samp
  * */
 void mpu925x_get_accelerometer_offset(mpu925x_t *mpu925x, uint16_t sampling_amount, int16_t *offset)
 {
-	float average[3] = {0.0, 0.0, 0.0};
+	int32_t sum[3] = {0, 0, 0};
 	for (uint16_t i = 0; i < sampling_amount; i++) {
 		// Read data.
 		mpu925x_get_acceleration_raw(mpu925x);
 
 		for (uint8_t j = 0; j < 3; j++) {
-			// Avoid overflow.	
-			float a = 1 / (i + 1);
-			float b = 1 - a;
-			average[j] = a * mpu925x->sensor_data.acceleration_raw[j] + b * average[j];
+			sum[j] += mpu925x->sensor_data.acceleration_raw[j];
 		}
 	}
 
+	float average[3];
+	for (uint8_t i = 0; i < 3; i++) {
+		average[i] = sampling_amount ? (float)sum[i] / sampling_amount : 0.0;
+	}
+
 	// Remove gravity depending on orientation.
 	switch (mpu925x->settings.orientation) {
 		case mpu925x_x_plus:
@@ -187,43 +382,66 @@ void mpu925x_set_accelerometer_offset(mpu925x_t *mpu925x, int16_t *offset)
 	for (uint8_t i = 0; i < 3; i++) {
 		buffer[0] = (uint8_t)((offset[i] >> 8) & 0xFF);
 		buffer[1] = (uint8_t)(offset[i] & 0xFF);
-		mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, XA_OFFSET_H + (i * 3), buffer, 2);
+		mpu925x_bus_write(mpu925x, mpu925x->settings.address, XA_OFFSET_H + (i * 3), buffer, 2);
 	}
 }
 
+/**
+ * @brief Set accelerometer scale and misalignment correction matrix.
+ * @param mpu925x MPU-925X struct pointer.
+ * @param matrix Correction matrix which is applied after bias removal, NULL
+ * to disable correction.
+ * @see mpu925x_accelerometer_calibration_solve
+ * */
+void mpu925x_set_accelerometer_matrix(mpu925x_t *mpu925x, float matrix[3][3])
+{
+	if (matrix == NULL) {
+		mpu925x->settings.accelerometer_matrix_enabled = 0;
+	}
+	else {
+		for (uint8_t i = 0; i < 3; i++) {
+			for (uint8_t j = 0; j < 3; j++) {
+				mpu925x->settings.accelerometer_matrix[i][j] = matrix[i][j];
+			}
+		}
+		mpu925x->settings.accelerometer_matrix_enabled = 1;
+	}
+
+	mpu925x_update_conversion(mpu925x);
+}
+
 /*******************************************************************************
  * Gyroscope settings
  ******************************************************************************/
 
 /**
  * @brief Set gyroscope full-scale range.
+ * 
+ * Range is changed with a single register write from shadow of GYRO_CONFIG.
+ * Samples read afterwards are tagged with new range, samples already read
+ * keep their tag. While FIFO capture runs, FIFO count is read first to split
+ * queued frames.
  * @param mpu925x MPU-925X struct pointer.
  * @param scale Gyroscope full-scale range to be set.
  * */
 void mpu925x_set_gyroscope_scale(mpu925x_t *mpu925x, mpu925x_gyroscope_scale scale)
 {
-	// Get GYRO_FS_SEL value.
-	uint8_t GYRO_FS_SEL = scale << 3;
+	// Register and tag of next samples are changed together.
+	mpu925x_lock(mpu925x);
 
-	// Set gyrocope scale.
-	switch (scale) {
-		default:
-		case mpu925x_250dps:
-			mpu925x->settings.gyroscope_lsb = GYROSCOPE_SCALE_250_DPS;
-			break;
-		case mpu925x_500dps:
-			mpu925x->settings.gyroscope_lsb = GYROSCOPE_SCALE_500_DPS;
-			break;
-		case mpu925x_1000dps:
-			mpu925x->settings.gyroscope_lsb = GYROSCOPE_SCALE_1000_DPS;
-			break;
-		case mpu925x_2000dps:
-			mpu925x->settings.gyroscope_lsb = GYROSCOPE_SCALE_2000_DPS;
-			break;
-	}
+	if ((scale & 0b11) != mpu925x->settings.gyroscope_scale)
+		mpu925x_fifo_split(mpu925x);
+
+	// Save scale and set gyroscope lsb.
+	mpu925x->settings.gyroscope_scale = scale & 0b11;
+	mpu925x->settings.gyroscope_lsb = mpu925x_gyroscope_lsb[scale & 0b11];
 
 	// Write register.
-	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, GYRO_CONFIG, &GYRO_FS_SEL, 1, 0b11100111);
+	mpu925x->settings.gyroscope_config &= ~GYRO_CONFIG_FS_SEL;
+	mpu925x->settings.gyroscope_config |= (scale & 0b11) << 3;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, GYRO_CONFIG, &mpu925x->settings.gyroscope_config, 1);
+
+	mpu925x_unlock(mpu925x);
 }
 
 /**
@@ -236,13 +454,18 @@ void mpu925x_set_gyroscope_dlpf(mpu925x_t *mpu925x, uint8_t g_fchoice, uint8_t d
 {
 	uint8_t buffer;
 
+	mpu925x_lock(mpu925x);
+
 	// Get bypass value.
-	buffer = ~g_fchoice & 0b11;
-	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, GYRO_CONFIG, &buffer, 1, 0b11111100);
+	mpu925x->settings.gyroscope_config &= ~GYRO_CONFIG_FCHOICE_B;
+	mpu925x->settings.gyroscope_config |= ~g_fchoice & GYRO_CONFIG_FCHOICE_B;
+	mpu925x_bus_write(mpu925x, mpu925x->settings.address, GYRO_CONFIG, &mpu925x->settings.gyroscope_config, 1);
 
 	// Set dlpf.
 	buffer = dlpf & 0b111;
 	mpu925x_bus_write_preserve(mpu925x, mpu925x->settings.address, CONFIG, &buffer, 1, 0b11111000);
+
+	mpu925x_unlock(mpu925x);
 }
 
 /**
@@ -269,24 +492,22 @@ void mpu925x_gyroscope_offset_cancellation(mpu925x_t *mpu925x, uint16_t sampling
  * */
 void mpu925x_get_gyroscope_offset(mpu925x_t *mpu925x, uint16_t sampling_amount, int16_t *offset)
 {
-	// Offsets of x, y and z axis are calculated seperately.
-	for (uint8_t i = 0; i < 3; i++) {
-		int16_t rotation_value;
-		float average = 0.0;
-
-		// Read rotation data and get average.
-		for (uint16_t j = 0; j < sampling_amount; j++) {
-			mpu925x_get_rotation_raw(mpu925x);
-			rotation_value = mpu925x->sensor_data.rotation_raw[i];
-
-			// Avoid overflow.
-			float a = 1.0 / (j + 1.0);
-			float b = 1.0 - a;
-			average = a * rotation_value + b * average;
+	int32_t sum[3] = {0, 0, 0};
+
+	// Offsets of x, y and z axis are calculated from the same samples.
+	for (uint16_t i = 0; i < sampling_amount; i++) {
+		mpu925x_get_rotation_raw(mpu925x);
+
+		for (uint8_t j = 0; j < 3; j++) {
+			sum[j] += mpu925x->sensor_data.rotation_raw[j];
 		}
+	}
 
-		// Get FS_SEL value.
-		uint8_t fs_sel = mpu925x->settings.gyroscope_scale;
+	// Get FS_SEL value.
+	uint8_t fs_sel = mpu925x->settings.gyroscope_scale;
+
+	for (uint8_t i = 0; i < 3; i++) {
+		float average = sampling_amount ? (float)sum[i] / sampling_amount : 0.0;
 
 		offset[i] = (int16_t)(-average / 4.0 * powerof2(fs_sel));
 	}
@@ -306,7 +527,7 @@ void mpu925x_set_gyroscope_offset(mpu925x_t *mpu925x, int16_t *offset)
 	for (uint8_t i = 0; i < 3; i++) {
 		buffer[0] = offset[i] >> 8;
 		buffer[1] = offset[i];
-		mpu925x->master_specific.bus_write(mpu925x, mpu925x->settings.address, XG_OFFSET_H + i * 2, buffer, 2);
+		mpu925x_bus_write(mpu925x, mpu925x->settings.address, XG_OFFSET_H + i * 2, buffer, 2);
 	}
 }
 
@@ -316,18 +537,39 @@ void mpu925x_set_gyroscope_offset(mpu925x_t *mpu925x, int16_t *offset)
 
 /**
  * @brief Set magnetometer measurement mode.
+ * 
+ * In ``mpu925x_pipelined_measurement_mode`` a single measurement is
+ * triggered here and every read which collects a result triggers the next
+ * one, so conversion runs while other sensors are read and AK8963 sleeps
+ * between measurements.
+ * 
+ * Setter waits for mode transition time, except in real-time profile
+ * (``settings.real_time``) where caller must leave at least 100 us between
+ * magnetometer mode changes (e.g. one control loop period).
+ * 
+ * While auxiliary I2C master is enabled, single, pipelined and external
+ * trigger modes are rejected: slave 0 consumes data ready at every sample and
+ * triggering a measurement would need a slave 4 transfer in read path.
  * @param mpu925x MPU-925X struct pointer.
  * @param measurement_mode Measurement mode for magnetometer to be set.
+ * @returns 0 on success, 1 if mode isn't allowed with auxiliary I2C master.
  * @see mpu925x_magnetometer_measurement_mode
  * */
-void mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_measurement_mode measurement_mode)
+uint8_t mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_measurement_mode measurement_mode)
 {
 	uint8_t buffer;
 
+	mpu925x_lock(mpu925x);
+
+	if (mpu925x->aux.enabled && !mpu925x_aux_measurement_mode_allowed(measurement_mode)) {
+		mpu925x_unlock(mpu925x);
+		return 1;
+	}
+
 	// Save measurement mode.
 	mpu925x->settings.measurement_mode = measurement_mode;
 
-	mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_bus_read(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
 	buffer &= 0b11110000;
 
 	switch (measurement_mode) {
@@ -335,7 +577,8 @@ void mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magne
 			buffer |= 0b0000;
 			break;
 		case mpu925x_single_measurement_mode:
-			buffer |= 0b0001;
+		case mpu925x_pipelined_measurement_mode:
+			buffer |= MAGNETOMETER_SINGLE_MEASUREMENT;
 			break;
 		case mpu925x_continuous_measurement_mode_1:
 			buffer |= 0b0010;
@@ -355,13 +598,20 @@ void mpu925x_set_magnetometer_measurement_mode(mpu925x_t *mpu925x, mpu925x_magne
 			break;
 	}
 
-	mpu925x->master_specific.bus_write(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_bus_write(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_unlock(mpu925x);
 
-	mpu925x->master_specific.delay_ms(mpu925x, 100);
+	if (!mpu925x->settings.real_time)
+		mpu925x->master_specific.delay_ms(mpu925x, MAGNETOMETER_MODE_DELAY_MS);
+
+	return 0;
 }
 
 /**
  * @brief Set magnetometer bit mode.
+ * 
+ * Setter waits for mode transition time, except in real-time profile
+ * (``settings.real_time``).
  * @param mpu925x MPU-925X struct pointer.
  * @param bit_mode Bit mode for magnetometer to be set.
  * @see mpu925x_magnetometer_bit_mode
@@ -370,10 +620,12 @@ void mpu925x_set_magnetometer_bit_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_
 {
 	uint8_t buffer;
 
+	mpu925x_lock(mpu925x);
+
 	// Save bit mode.
 	mpu925x->settings.bit_mode = bit_mode;
 
-	mpu925x->master_specific.bus_read(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_bus_read(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
 	buffer &= 0b11101111;
 
 	switch (bit_mode) {
@@ -388,7 +640,10 @@ void mpu925x_set_magnetometer_bit_mode(mpu925x_t *mpu925x, mpu925x_magnetometer_
 			break;
 	}
 
-	mpu925x->master_specific.bus_write(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_bus_write(mpu925x, AK8963_ADDRESS, CNTL1, &buffer, 1);
+	mpu925x_update_conversion(mpu925x);
+	mpu925x_unlock(mpu925x);
 
-	mpu925x->master_specific.delay_ms(mpu925x, 100);
+	if (!mpu925x->settings.real_time)
+		mpu925x->master_specific.delay_ms(mpu925x, MAGNETOMETER_MODE_DELAY_MS);
 }
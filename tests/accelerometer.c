@@ -29,9 +29,161 @@ void test_accelerometer_scale()
 	TEST_ASSERT_EQUAL(mpu925x.settings.acceleration_lsb, ACCELEROMETER_SCALE_4G);
 }
 
+/**
+ * @brief Write raw acceleration to virtual registers.
+ */
+void set_acceleration_raw(int16_t *acceleration)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration[i] >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration[i] & 0xFF;
+	}
+}
+
+/**
+ * @brief Reset software calibration.
+ */
+void reset_calibration()
+{
+	memset(mpu925x.settings.accelerometer_bias, 0, sizeof(mpu925x.settings.accelerometer_bias));
+	mpu925x_set_accelerometer_matrix(&mpu925x, NULL);
+}
+
+void test_accelerometer_offset_average()
+{
+	int16_t acceleration[3] = {100, -100, ACCELEROMETER_SCALE_2G};
+	int16_t offset[3];
+
+	reset_calibration();
+	mpu925x.settings.orientation = mpu925x_z_minus;
+	mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_2g);
+	set_acceleration_raw(acceleration);
+
+	mpu925x_get_accelerometer_offset(&mpu925x, 10, offset);
+
+	// Average must not collapse after first sample.
+	TEST_ASSERT_EQUAL(-(100 / 8 & ~1), offset[0]);
+	TEST_ASSERT_EQUAL(-(-100 / 8 & ~1), offset[1]);
+	TEST_ASSERT_EQUAL(0, offset[2]);
+}
+
+void test_accelerometer_six_position_calibration()
+{
+	// Scale and misalignment of simulated sensor and bias in g.
+	float k[3][3] = {
+		{1.02, 0.01, -0.02},
+		{0.00, 0.97, 0.015},
+		{0.01, -0.01, 1.05}
+	};
+	float bias[3] = {0.05, -0.03, 0.08};
+	mpu925x_accelerometer_calibration calibration = {
+		.sampling_amount = 4
+	};
+
+	reset_calibration();
+	mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_4g);
+
+	for (uint8_t pose = mpu925x_x_plus; pose <= mpu925x_z_minus; pose++) {
+		float sign = (pose & 1) ? -1.0 : 1.0;
+		uint8_t axis = pose / 2;
+		int16_t acceleration[3];
+
+		for (uint8_t i = 0; i < 3; i++) {
+			acceleration[i] = (int16_t)((k[i][axis] * sign + bias[i]) * ACCELEROMETER_SCALE_4G);
+		}
+		set_acceleration_raw(acceleration);
+
+		// Solving before collecting all poses fails.
+		TEST_ASSERT_EQUAL(1, mpu925x_accelerometer_calibration_solve(&mpu925x, &calibration));
+
+		uint8_t done = 0;
+		for (uint8_t i = 0; i < 4; i++) {
+			mpu925x_get_acceleration_raw(&mpu925x);
+			done = mpu925x_accelerometer_calibration_update(&mpu925x, &calibration, pose);
+		}
+		TEST_ASSERT_EQUAL(1, done);
+	}
+
+	TEST_ASSERT_EQUAL(0, mpu925x_accelerometer_calibration_solve(&mpu925x, &calibration));
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.001, bias[i], mpu925x.settings.accelerometer_bias[i]);
+	}
+
+	// Calibrated output of a tilted pose must be its true gravity vector.
+	float g[3] = {0.6, 0.0, 0.8};
+	int16_t acceleration[3];
+	for (uint8_t i = 0; i < 3; i++) {
+		acceleration[i] = (int16_t)((k[i][0] * g[0] + k[i][1] * g[1] + k[i][2] * g[2] + bias[i]) * ACCELEROMETER_SCALE_4G);
+	}
+	set_acceleration_raw(acceleration);
+	mpu925x_get_acceleration(&mpu925x);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.002, g[i], mpu925x.sensor_data.acceleration[i]);
+	}
+
+	reset_calibration();
+}
+
+void test_accelerometer_calibration_range_change()
+{
+	int16_t acceleration[3] = {ACCELEROMETER_SCALE_2G, 0, 0};
+	mpu925x_accelerometer_calibration calibration = {
+		.sampling_amount = 4
+	};
+	uint8_t done = 0;
+
+	mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_2g);
+	set_acceleration_raw(acceleration);
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x_get_acceleration_raw(&mpu925x);
+
+		// Range changes right after last sample is read, like automatic range.
+		if (i == 2) {
+			mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_4g);
+		}
+		TEST_ASSERT_EQUAL(0, mpu925x_accelerometer_calibration_update(&mpu925x, &calibration, mpu925x_x_plus));
+	}
+	TEST_ASSERT_EQUAL(3, calibration.count[mpu925x_x_plus]);
+
+	// Samples of new range discard collected data.
+	acceleration[0] = ACCELEROMETER_SCALE_4G;
+	set_acceleration_raw(acceleration);
+	for (uint8_t i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL(0, done);
+		mpu925x_get_acceleration_raw(&mpu925x);
+		done = mpu925x_accelerometer_calibration_update(&mpu925x, &calibration, mpu925x_x_plus);
+	}
+	TEST_ASSERT_EQUAL(1, done);
+	TEST_ASSERT_EQUAL_FLOAT(1.0, calibration.sum[mpu925x_x_plus][0] / calibration.count[mpu925x_x_plus] / calibration.acceleration_lsb);
+}
+
+void test_accelerometer_bias_commit()
+{
+	reset_calibration();
+
+	// Bit 0 is set and must be preserved.
+	mpu_virt_mem[XA_OFFSET_H] = 0x01;
+	mpu_virt_mem[XA_OFFSET_L] = 0x01;
+	mpu925x.settings.accelerometer_bias[0] = 100.0 / ACCELEROMETER_OFFSET_SCALE;
+	mpu925x.settings.accelerometer_bias[1] = -51.0 / ACCELEROMETER_OFFSET_SCALE;
+
+	mpu925x_accelerometer_bias_commit(&mpu925x);
+
+	TEST_ASSERT_EQUAL(0x0101 - 100, convert8bitto16bit(mpu_virt_mem[XA_OFFSET_H], mpu_virt_mem[XA_OFFSET_L]));
+	TEST_ASSERT_EQUAL(52, convert8bitto16bit(mpu_virt_mem[YA_OFFSET_H], mpu_virt_mem[YA_OFFSET_L]));
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.0, mpu925x.settings.accelerometer_bias[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.0 / ACCELEROMETER_OFFSET_SCALE, mpu925x.settings.accelerometer_bias[1]);
+
+	reset_calibration();
+}
+
 int main()
 {
 	RUN_TEST(test_accelerometer_scale);
+	RUN_TEST(test_accelerometer_offset_average);
+	RUN_TEST(test_accelerometer_six_position_calibration);
+	RUN_TEST(test_accelerometer_calibration_range_change);
+	RUN_TEST(test_accelerometer_bias_commit);
 
 	return UnityEnd();
 }
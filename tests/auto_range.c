@@ -0,0 +1,126 @@
+/**
+ * @file auto_range.c
+ * @author Ceyhun Şen
+ * @brief Test file for automatic full-scale range control.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Write same raw value to every acceleration and rotation register.
+ */
+void set_raw(int16_t acceleration, int16_t rotation)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration & 0xFF;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = (uint16_t)rotation >> 8;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = (uint16_t)rotation & 0xFF;
+	}
+}
+
+/**
+ * @brief Initialize with 2g and 250 dps scales and automatic range enabled.
+ */
+void prepare()
+{
+	memset(&mpu925x.auto_range, 0, sizeof(mpu925x.auto_range));
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+	mpu925x.auto_range.accelerometer = 1;
+	mpu925x.auto_range.gyroscope = 1;
+	mpu925x.auto_range.hold = 10;
+}
+
+void test_range_up()
+{
+	prepare();
+
+	// 0.95 of 2g full scale.
+	set_raw(31130, 100);
+	mock_write_count = 0;
+	mpu925x_get_all(&mpu925x);
+
+	// Transition is a single write and sample keeps its old range.
+	TEST_ASSERT_EQUAL_UINT32(1, mock_write_count);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.auto_range.transitions);
+	TEST_ASSERT_EQUAL(mpu925x_2g, mpu925x.sensor_data.accelerometer_scale);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 31130 / (float)ACCELEROMETER_SCALE_2G, mpu925x.sensor_data.acceleration[0]);
+	TEST_ASSERT_EQUAL(mpu925x_4g, mpu925x.settings.accelerometer_scale);
+	TEST_ASSERT_EQUAL_HEX8(mpu925x_4g << 3, mpu_virt_mem[ACCEL_CONFIG]);
+
+	// Next sample is read and converted with new range.
+	set_raw(20000, 100);
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL(mpu925x_4g, mpu925x.sensor_data.accelerometer_scale);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 20000 / (float)ACCELEROMETER_SCALE_4G, mpu925x.sensor_data.acceleration[0]);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.auto_range.transitions);
+}
+
+void test_range_down_and_hysteresis()
+{
+	prepare();
+	mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_8g);
+
+	// 0.5 of lower range's full scale doesn't decrease range.
+	set_raw(8192, 100);
+	for (uint8_t i = 0; i < 50; i++) {
+		mpu925x_get_all(&mpu925x);
+	}
+	TEST_ASSERT_EQUAL(mpu925x_8g, mpu925x.settings.accelerometer_scale);
+
+	// 0.3 of lower range's full scale decreases it after hold samples.
+	set_raw(4915, 100);
+	for (uint8_t i = 0; i < 9; i++) {
+		mpu925x_get_all(&mpu925x);
+	}
+	TEST_ASSERT_EQUAL(mpu925x_8g, mpu925x.settings.accelerometer_scale);
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL(mpu925x_4g, mpu925x.settings.accelerometer_scale);
+
+	// Same signal reads 0.6 of 4g full scale and stays there.
+	set_raw(9830, 100);
+	for (uint8_t i = 0; i < 50; i++) {
+		mpu925x_get_all(&mpu925x);
+	}
+	TEST_ASSERT_EQUAL(mpu925x_4g, mpu925x.settings.accelerometer_scale);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.auto_range.transitions);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 9830 / (float)ACCELEROMETER_SCALE_4G, mpu925x.sensor_data.acceleration[0]);
+}
+
+void test_gyroscope_keeps_dlpf()
+{
+	mpu925x_scheduler scheduler;
+
+	prepare();
+	// Fchoice_b is inverse of fchoice.
+	mpu925x_set_gyroscope_dlpf(&mpu925x, 0b10, 0b011);
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+
+	// -0.95 of 250 dps full scale.
+	set_raw(100, -31130);
+	mock_read_count = 0;
+	mock_write_count = 0;
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL(mpu925x_500dps, mpu925x.settings.gyroscope_scale);
+	TEST_ASSERT_EQUAL_HEX8((mpu925x_500dps << 3) | 0b01, mpu_virt_mem[GYRO_CONFIG]);
+	TEST_ASSERT_TRUE(mock_read_count + mock_write_count <= MPU925X_TRANSACTIONS_SCHEDULER + MPU925X_TRANSACTIONS_AUTO_RANGE);
+
+	// Highest range doesn't go up.
+	mpu925x_set_gyroscope_scale(&mpu925x, mpu925x_2000dps);
+	set_raw(100, INT16_MAX);
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL(mpu925x_2000dps, mpu925x.settings.gyroscope_scale);
+	TEST_ASSERT_EQUAL_HEX8((mpu925x_2000dps << 3) | 0b01, mpu_virt_mem[GYRO_CONFIG]);
+}
+
+int main()
+{
+	RUN_TEST(test_range_up);
+	RUN_TEST(test_range_down_and_hysteresis);
+	RUN_TEST(test_gyroscope_keeps_dlpf);
+
+	return UnityEnd();
+}
@@ -0,0 +1,260 @@
+/**
+ * @file aux.c
+ * @author Ceyhun Şen
+ * @brief Test file for auxiliary I2C master.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Initialize and enable auxiliary I2C master.
+ */
+void prepare()
+{
+	mpu925x.settings.measurement_mode = mpu925x_continuous_measurement_mode_2;
+	mpu925x_init(&mpu925x, 0);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_enable(&mpu925x, 4));
+}
+
+void test_enable()
+{
+	prepare();
+
+	// Bypass is disabled, slave 0 reads ST1 to ST2 of AK8963.
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x.aux.enabled);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[INT_PIN_CFG] & INT_PIN_CFG_BYPASS_EN);
+	TEST_ASSERT_EQUAL_HEX8(USER_CTRL_I2C_MST_EN, mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN);
+	TEST_ASSERT_EQUAL_HEX8(AK8963_ADDRESS | I2C_SLV_READ, mpu_virt_mem[I2C_SLV0_ADDR]);
+	TEST_ASSERT_EQUAL_HEX8(ST1, mpu_virt_mem[I2C_SLV0_REG]);
+	TEST_ASSERT_EQUAL_HEX8(I2C_SLV_EN | 8, mpu_virt_mem[I2C_SLV0_CTRL]);
+	TEST_ASSERT_EQUAL_HEX8(4, mpu_virt_mem[I2C_SLV4_CTRL] & I2C_MST_DLY);
+	TEST_ASSERT_EQUAL_UINT8(8, mpu925x.aux.size);
+
+	// AK8963 is reachable through slave 4.
+	mpu925x_set_magnetometer_measurement_mode(&mpu925x, mpu925x_continuous_measurement_mode_1);
+	TEST_ASSERT_EQUAL_HEX8(0b0010, ak_virt_mem[CNTL1] & 0x0F);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_health_check_identity(&mpu925x));
+
+	// Master is disabled again if AK8963 doesn't respond.
+	mpu925x_init(&mpu925x, 0);
+	ak_virt_mem[WIA] = 0;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_enable(&mpu925x, 0));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x.aux.enabled);
+	TEST_ASSERT_EQUAL_HEX8(INT_PIN_CFG_BYPASS_EN, mpu_virt_mem[INT_PIN_CFG] & INT_PIN_CFG_BYPASS_EN);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN);
+}
+
+void test_single_burst()
+{
+	mpu925x_scheduler scheduler;
+
+	prepare();
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+	ak_virt_mem[ST1] = 1;
+	ak_virt_mem[HXL] = 0x34;
+	ak_virt_mem[HXH] = 0x12;
+	ak_virt_mem[HZL] = 0xFF;
+	ak_virt_mem[HZH] = 0xFF;
+
+	// Sensors and magnetometer in one transaction.
+	mock_read_count = 0;
+	mock_write_count = 0;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	TEST_ASSERT_EQUAL_UINT32(0, mock_write_count);
+	TEST_ASSERT_EQUAL_INT16(0x1234, mpu925x.sensor_data.magnet_raw[0]);
+	TEST_ASSERT_EQUAL_INT16(-1, mpu925x.sensor_data.magnet_raw[2]);
+	TEST_ASSERT_EQUAL_INT16(0xFF, mpu925x.sensor_data.acceleration_raw[0]);
+	TEST_ASSERT_TRUE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_MAGNETOMETER);
+
+	mock_read_count = 0;
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	mock_read_count = 0;
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	TEST_ASSERT_TRUE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_MAGNETOMETER);
+
+	// Overflowed data is kept out.
+	ak_virt_mem[HXH] = 0x56;
+	ak_virt_mem[ST2] = MPU925X_MAGNETOMETER_OVERFLOW;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_INT16(0x1234, mpu925x.sensor_data.magnet_raw[0]);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_OVERFLOW, mpu925x.sensor_data.magnetometer_status & MPU925X_MAGNETOMETER_OVERFLOW);
+
+	// Single magnetometer read is served from EXT_SENS_DATA.
+	ak_virt_mem[ST2] = 0;
+	mock_read_count = 0;
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	TEST_ASSERT_EQUAL_INT16(0x5634, mpu925x.sensor_data.magnet_raw[0]);
+}
+
+void test_slave_reads()
+{
+	prepare();
+	for (uint16_t i = 0; i < 256; i++) {
+		aux_virt_mem[i] = i;
+	}
+
+	// Slave 2 follows magnetometer, slave 1 moves it when it is registered.
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_slave_read(&mpu925x, 2, MOCK_AUX_ADDRESS, 0xF7, 6, 0));
+	TEST_ASSERT_EQUAL_UINT8(8, mpu925x.aux.position[2]);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0x10, 3, 1));
+	TEST_ASSERT_EQUAL_UINT8(8, mpu925x.aux.position[1]);
+	TEST_ASSERT_EQUAL_UINT8(11, mpu925x.aux.position[2]);
+	TEST_ASSERT_EQUAL_UINT8(17, mpu925x.aux.size);
+	TEST_ASSERT_EQUAL_HEX8(I2C_MST_DELAY_ES_SHADOW | 0b10, mpu_virt_mem[I2C_MST_DELAY_CTRL]);
+
+	mock_read_count = 0;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL_HEX8(0x10 + i, mpu925x.sensor_data.external_data[mpu925x.aux.position[1] + i]);
+	}
+	for (uint8_t i = 0; i < 6; i++) {
+		TEST_ASSERT_EQUAL_HEX8(0xF7 + i, mpu925x.sensor_data.external_data[mpu925x.aux.position[2] + i]);
+	}
+
+	// Zero length disables slave.
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0x10, 0, 0));
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[I2C_SLV1_CTRL]);
+	TEST_ASSERT_EQUAL_HEX8(I2C_MST_DELAY_ES_SHADOW, mpu_virt_mem[I2C_MST_DELAY_CTRL]);
+	TEST_ASSERT_EQUAL_UINT8(8, mpu925x.aux.position[2]);
+
+	// Invalid slaves and lengths.
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_slave_read(&mpu925x, 0, MOCK_AUX_ADDRESS, 0, 4, 0));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_slave_read(&mpu925x, 4, MOCK_AUX_ADDRESS, 0, 4, 0));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_slave_read(&mpu925x, 3, MOCK_AUX_ADDRESS, 0, 16, 0));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_slave_read(&mpu925x, 3, MOCK_AUX_ADDRESS, 0, 10, 0));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0, 1, 0));
+}
+
+void test_single_transfers()
+{
+	uint8_t value;
+
+	prepare();
+	aux_virt_mem[0xD0] = 0x58;
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_read(&mpu925x, MOCK_AUX_ADDRESS, 0xD0, &value));
+	TEST_ASSERT_EQUAL_HEX8(0x58, value);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_write(&mpu925x, MOCK_AUX_ADDRESS, 0xF4, 0x27));
+	TEST_ASSERT_EQUAL_HEX8(0x27, aux_virt_mem[0xF4]);
+
+	// No slave at address.
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_read(&mpu925x, 0x50, 0, &value));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_write(&mpu925x, 0x50, 0, 0));
+}
+
+void test_fifo_slaves()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	mpu925x_fifo_frame frames[4];
+
+	prepare();
+	aux_virt_mem[0x20] = 0xAB;
+	aux_virt_mem[0x21] = 0xCD;
+	ak_virt_mem[HXL] = 0x34;
+	ak_virt_mem[HXH] = 0x12;
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0x20, 2, 0));
+
+	// Magnetometer and slave 1 are captured with accelerometer.
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_SLAVE_0 | MPU925X_FIFO_SLAVE_1, 1000));
+	TEST_ASSERT_EQUAL_UINT16(6 + 8 + 2, capture.layout.size);
+	TEST_ASSERT_EQUAL_HEX8(USER_CTRL_I2C_MST_EN, mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN);
+	mock_sample(2);
+	TEST_ASSERT_EQUAL_UINT16(2, mpu925x_fifo_read(&mpu925x, &capture, frames, 4, &block));
+	TEST_ASSERT_EQUAL_HEX8(0x34, frames[1].external_data[mpu925x.aux.position[0] + HXL - ST1]);
+	TEST_ASSERT_EQUAL_HEX8(0x12, frames[1].external_data[mpu925x.aux.position[0] + HXH - ST1]);
+	TEST_ASSERT_EQUAL_HEX8(0xAB, frames[1].external_data[mpu925x.aux.position[1]]);
+	TEST_ASSERT_EQUAL_HEX8(0xCD, frames[1].external_data[mpu925x.aux.position[1] + 1]);
+	mpu925x_fifo_stop(&mpu925x);
+}
+
+void test_disable()
+{
+	prepare();
+	mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0x20, 2, 0);
+	mpu925x_aux_disable(&mpu925x);
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x.aux.enabled);
+	TEST_ASSERT_EQUAL_HEX8(INT_PIN_CFG_BYPASS_EN, mpu_virt_mem[INT_PIN_CFG] & INT_PIN_CFG_BYPASS_EN);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[I2C_SLV0_CTRL]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[I2C_SLV1_CTRL]);
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_slave_read(&mpu925x, 1, MOCK_AUX_ADDRESS, 0x20, 2, 0));
+
+	// AK8963 is on main bus again.
+	ak_virt_mem[ST1] = 1;
+	ak_virt_mem[HXL] = 0x78;
+	mock_read_count = 0;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(4, mock_read_count);
+	TEST_ASSERT_EQUAL_INT16(0x78, mpu925x.sensor_data.magnet_raw[0]);
+}
+
+uint32_t delay_count;
+
+/**
+ * @brief Delay function which counts calls.
+ */
+void counting_delay(mpu925x_t *mpu925x, uint32_t delay)
+{
+	delay_count++;
+	mock_delay(mpu925x, delay);
+}
+
+/**
+ * @brief Triggered measurement modes would need slave 4 transfers in read
+ * path, they are rejected while master is enabled.
+ */
+void test_triggered_modes()
+{
+	mpu925x_magnetometer_measurement_mode triggered[] = {
+		mpu925x_single_measurement_mode,
+		mpu925x_pipelined_measurement_mode,
+		mpu925x_external_trigger_measurement_mode
+	};
+
+	prepare();
+	for (uint8_t m = 0; m < sizeof(triggered) / sizeof(triggered[0]); m++) {
+		TEST_ASSERT_EQUAL_UINT8(1, mpu925x_set_magnetometer_measurement_mode(&mpu925x, triggered[m]));
+		TEST_ASSERT_EQUAL(mpu925x_continuous_measurement_mode_2, mpu925x.settings.measurement_mode);
+		TEST_ASSERT_EQUAL_HEX8(0b0110, ak_virt_mem[CNTL1] & 0x0F);
+	}
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_set_magnetometer_measurement_mode(&mpu925x, mpu925x_continuous_measurement_mode_1));
+
+	// Read path never waits for slave 4.
+	mpu925x.master_specific.delay_ms = counting_delay;
+	delay_count = 0;
+	for (uint8_t i = 0; i < 10; i++) {
+		ak_virt_mem[ST1] = 1;
+		mpu925x_get_all(&mpu925x);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, delay_count);
+	mpu925x.master_specific.delay_ms = mock_delay;
+
+	// Master isn't enabled in a triggered mode.
+	mpu925x_aux_disable(&mpu925x);
+	mpu925x_set_magnetometer_measurement_mode(&mpu925x, mpu925x_pipelined_measurement_mode);
+	mock_write_count = 0;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_aux_enable(&mpu925x, 0));
+	TEST_ASSERT_EQUAL_UINT32(0, mock_write_count);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x.aux.enabled);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN);
+}
+
+int main()
+{
+	RUN_TEST(test_enable);
+	RUN_TEST(test_single_burst);
+	RUN_TEST(test_slave_reads);
+	RUN_TEST(test_single_transfers);
+	RUN_TEST(test_fifo_slaves);
+	RUN_TEST(test_disable);
+	RUN_TEST(test_triggered_modes);
+
+	return UnityEnd();
+}
@@ -0,0 +1,110 @@
+/**
+ * @file calibration.c
+ * @author Ceyhun Şen
+ * @brief Test file for calibration storage and warm initialization.
+ */
+
+#include "common.h"
+
+uint8_t blob[MPU925X_CALIBRATION_SIZE];
+
+/**
+ * @brief Initialize driver, calibrate it and export calibration.
+ */
+void prepare()
+{
+	float matrix[3][3] = {{1.01, 0.02, 0}, {0, 0.99, 0}, {0, 0, 1}};
+	float mounting[3][3] = {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}};
+	int16_t gyroscope_offset[3] = {-120, 45, 7};
+
+	ak_virt_mem[ASAX] = 140;
+	ak_virt_mem[ASAY] = 120;
+	ak_virt_mem[ASAZ] = 128;
+	mpu_virt_mem[XA_OFFSET_H] = 0x12;
+	mpu_virt_mem[XA_OFFSET_L] = 0x35;
+	mpu_virt_mem[ZA_OFFSET_L] = 0x81;
+	mpu925x_init(&mpu925x, 0);
+
+	mpu925x_set_gyroscope_offset(&mpu925x, gyroscope_offset);
+	mpu925x_set_accelerometer_matrix(&mpu925x, matrix);
+	mpu925x_set_mounting_matrix(&mpu925x, mounting);
+	mpu925x.settings.gyroscope_bias[1] = 0.25;
+	mpu925x.settings.accelerometer_bias[2] = -0.01;
+
+	TEST_ASSERT_EQUAL_UINT16(MPU925X_CALIBRATION_SIZE, mpu925x_calibration_export(&mpu925x, blob, sizeof(blob)));
+}
+
+/**
+ * @brief Power cycle simulated sensor and forget driver state.
+ */
+void power_cycle()
+{
+	memset(mpu_virt_mem, 0, sizeof(mpu_virt_mem));
+	memset(ak_virt_mem, 0, sizeof(ak_virt_mem));
+	mpu_virt_mem[WHO_AM_I] = 0x73;
+	ak_virt_mem[WIA] = 0x48;
+	memset(&mpu925x.settings.magnetometer_coefficient, 0, sizeof(mpu925x.settings.magnetometer_coefficient));
+	memset(&mpu925x.settings.gyroscope_bias, 0, sizeof(mpu925x.settings.gyroscope_bias));
+	memset(&mpu925x.settings.accelerometer_bias, 0, sizeof(mpu925x.settings.accelerometer_bias));
+	mpu925x_set_accelerometer_matrix(&mpu925x, NULL);
+	mpu925x_set_mounting_matrix(&mpu925x, NULL);
+	mock_read_count = 0;
+	mock_write_count = 0;
+}
+
+void test_warm_init()
+{
+	float coefficient[3], conversion[3][3];
+
+	prepare();
+	memcpy(coefficient, mpu925x.settings.magnetometer_coefficient, sizeof(coefficient));
+	memcpy(conversion, mpu925x.conversion.snapshot[mpu925x.conversion.version & 1].accelerometer, sizeof(conversion));
+	power_cycle();
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_warm_init(&mpu925x, 0, blob, sizeof(blob)));
+
+	// Fuse ROM is not accessed, values come from blob.
+	TEST_ASSERT_EQUAL_HEX8(0, ak_virt_mem[CNTL2]);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY(coefficient, mpu925x.settings.magnetometer_coefficient, 3);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY(&conversion[0][0], &mpu925x.conversion.snapshot[mpu925x.conversion.version & 1].accelerometer[0][0], 9);
+	TEST_ASSERT_EQUAL_FLOAT(0.25, mpu925x.settings.gyroscope_bias[1]);
+	TEST_ASSERT_EQUAL_FLOAT(-0.01, mpu925x.settings.accelerometer_bias[2]);
+	TEST_ASSERT_TRUE(mpu925x.settings.body_frame);
+
+	// Offset registers are restored.
+	TEST_ASSERT_EQUAL_HEX8((uint16_t)-120 >> 8, mpu_virt_mem[XG_OFFSET_H]);
+	TEST_ASSERT_EQUAL_HEX8((uint16_t)-120 & 0xFF, mpu_virt_mem[XG_OFFSET_L]);
+	TEST_ASSERT_EQUAL_HEX8(7, mpu_virt_mem[ZG_OFFSET_L]);
+	TEST_ASSERT_EQUAL_HEX8(0x12, mpu_virt_mem[XA_OFFSET_H]);
+	TEST_ASSERT_EQUAL_HEX8(0x35, mpu_virt_mem[XA_OFFSET_L]);
+	TEST_ASSERT_EQUAL_HEX8(0x81, mpu_virt_mem[ZA_OFFSET_L]);
+}
+
+void test_invalid_blob()
+{
+	prepare();
+	power_cycle();
+	ak_virt_mem[ASAX] = 128;
+	ak_virt_mem[ASAY] = 128;
+	ak_virt_mem[ASAZ] = 128;
+
+	// Corrupted blob is rejected and sensor is initialized from fuse ROM.
+	blob[20] ^= 1;
+	TEST_ASSERT_EQUAL_UINT8(2, mpu925x_calibration_import(&mpu925x, blob, sizeof(blob)));
+	TEST_ASSERT_EQUAL_UINT8(3, mpu925x_warm_init(&mpu925x, 0, blob, sizeof(blob)));
+	TEST_ASSERT_EQUAL_FLOAT(1.0, mpu925x.settings.magnetometer_coefficient[0]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[XG_OFFSET_L]);
+	TEST_ASSERT_EQUAL_FLOAT(0, mpu925x.settings.gyroscope_bias[1]);
+
+	blob[1] = CALIBRATION_VERSION + 1;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_calibration_import(&mpu925x, blob, sizeof(blob)));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_calibration_import(&mpu925x, blob, MPU925X_CALIBRATION_SIZE - 1));
+}
+
+int main()
+{
+	RUN_TEST(test_warm_init);
+	RUN_TEST(test_invalid_blob);
+
+	return UnityEnd();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file clock_sync.c
+ * @author Ceyhun Şen
+ * @brief Test file for host clock synchronization.
+ */
+
+#include "common.h"
+#include <stdlib.h>
+
+/**
+ * @brief True host time of a sample, sensor starts at an arbitrary host time.
+ */
+uint64_t true_time(uint32_t sample, double period)
+{
+	return 5000000000ULL + (uint64_t)(sample * period);
+}
+
+void test_ideal_clock()
+{
+	mpu925x_clock_sync sync;
+
+	mpu925x_clock_sync_init(&sync, 1000);
+
+	// Single observation maps samples with nominal period.
+	mpu925x_clock_sync_update(&sync, 100, true_time(100, 1000));
+	TEST_ASSERT_EQUAL_UINT64(true_time(100, 1000), mpu925x_clock_sync_time(&sync, 100));
+	TEST_ASSERT_EQUAL_UINT64(true_time(250, 1000), mpu925x_clock_sync_time(&sync, 250));
+	TEST_ASSERT_EQUAL_UINT64(true_time(40, 1000), mpu925x_clock_sync_time(&sync, 40));
+
+	// Old and repeated observations are ignored.
+	mpu925x_clock_sync_update(&sync, 100, true_time(100, 1000) + 500);
+	mpu925x_clock_sync_update(&sync, 50, 0);
+	TEST_ASSERT_EQUAL_UINT32(1, sync.updates);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 0, mpu925x_clock_sync_drift(&sync));
+}
+
+void test_drift_and_jitter()
+{
+	mpu925x_clock_sync sync;
+	double period = 1000 * 1.012;
+	uint32_t sample = 0;
+
+	srand(1);
+	mpu925x_clock_sync_init(&sync, 1000);
+
+	// Sensor is 1.2 % slow, drained every 5 to 20 samples with up to 200 us
+	// host latency, for an hour.
+	for (uint32_t i = 0; i < 360000; i++) {
+		sample += 5 + rand() % 16;
+		mpu925x_clock_sync_update(&sync, sample, true_time(sample, period) + rand() % 200);
+	}
+	TEST_ASSERT_FLOAT_WITHIN(20, 12000, mpu925x_clock_sync_drift(&sync));
+	TEST_ASSERT_TRUE(sync.jitter < 100);
+
+	// Timestamps are within latency band, including recent past.
+	for (uint32_t n = sample - 100; n < sample + 100; n++) {
+		int64_t error = (int64_t)(mpu925x_clock_sync_time(&sync, n) - true_time(n, period));
+		TEST_ASSERT_TRUE(error > 80 && error < 120);
+	}
+}
+
+void test_wrap_around()
+{
+	mpu925x_clock_sync sync;
+	uint32_t sample = UINT32_MAX - 500;
+	uint64_t time = 1000;
+
+	mpu925x_clock_sync_init(&sync, 500);
+	for (uint16_t i = 0; i < 100; i++) {
+		mpu925x_clock_sync_update(&sync, sample, time);
+		sample += 10;
+		time += 20000;
+	}
+
+	// Sample count wrapped around during updates.
+	TEST_ASSERT_TRUE(sample < 1000);
+	TEST_ASSERT_EQUAL_UINT64(time, mpu925x_clock_sync_time(&sync, sample));
+	TEST_ASSERT_EQUAL_UINT64(time - 40000, mpu925x_clock_sync_time(&sync, sample - 20));
+
+	// Last sample at or before a time, across wrap around.
+	TEST_ASSERT_EQUAL_UINT32(sample, mpu925x_clock_sync_sample(&sync, time));
+	TEST_ASSERT_EQUAL_UINT32(sample, mpu925x_clock_sync_sample(&sync, time + 1999));
+	TEST_ASSERT_EQUAL_UINT32(sample + 1, mpu925x_clock_sync_sample(&sync, time + 2000));
+	TEST_ASSERT_EQUAL_UINT32(sample - 1, mpu925x_clock_sync_sample(&sync, time - 1));
+	TEST_ASSERT_EQUAL_UINT32(sample - 1000, mpu925x_clock_sync_sample(&sync, time - 2000000));
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 2000, mpu925x_clock_sync_period(&sync));
+}
+
+int main()
+{
+	RUN_TEST(test_ideal_clock);
+	RUN_TEST(test_drift_and_jitter);
+	RUN_TEST(test_wrap_around);
+
+	return UnityEnd();
+}
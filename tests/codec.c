@@ -0,0 +1,170 @@
+/**
+ * @file codec.c
+ * @author Ceyhun Şen
+ * @brief Test file for raw sample codec.
+ */
+
+#include "common.h"
+#include "mpu925x_codec.h"
+
+#define CHANNELS MPU925X_CODEC_FRAME_CHANNELS
+#define FRAMES   300
+
+int16_t input[FRAMES][CHANNELS];
+int16_t output[64][MPU925X_CODEC_MAX_CHANNELS];
+uint8_t stream[8192];
+uint32_t stream_size;
+
+/**
+ * @brief Fill input with slowly changing signals, noise and extreme jumps.
+ */
+void make_input()
+{
+	uint32_t seed = 1;
+
+	for (uint16_t n = 0; n < FRAMES; n++) {
+		for (uint8_t i = 0; i < CHANNELS; i++) {
+			seed = seed * 1103515245 + 12345;
+			input[n][i] = (int16_t)(n * (i + 1) * 5 - 2000 * i + (int16_t)((seed >> 16) % 31) - 15);
+		}
+	}
+	input[100][0] = INT16_MAX;
+	input[101][0] = INT16_MIN;
+	input[102][0] = INT16_MAX;
+}
+
+/**
+ * @brief Encode all input to stream with given settings.
+ */
+void encode(mpu925x_codec_encoder *encoder, uint8_t predictor, uint8_t coding)
+{
+	static uint8_t buffer[512];
+
+	encoder->channels = CHANNELS;
+	encoder->predictor = predictor;
+	encoder->coding = coding;
+	encoder->block_frames = 64;
+	encoder->buffer = buffer;
+	encoder->buffer_size = sizeof(buffer);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_codec_encoder_init(encoder));
+
+	stream_size = 0;
+	for (uint16_t n = 0; n < FRAMES; n++) {
+		uint16_t size = mpu925x_codec_encode(encoder, input[n]);
+		memcpy(&stream[stream_size], buffer, size);
+		stream_size += size;
+	}
+	uint16_t size = mpu925x_codec_flush(encoder);
+	memcpy(&stream[stream_size], buffer, size);
+	stream_size += size;
+}
+
+/**
+ * @brief Decode stream and compare with input.
+ * @returns Number of decoded frames.
+ */
+uint32_t decode_and_compare(uint32_t size)
+{
+	mpu925x_codec_block block;
+	uint32_t position = 0, frames = 0, consumed;
+
+	while ((consumed = mpu925x_codec_decode(&stream[position], size - position, &output[0][0], 64, &block)) > 0) {
+		position += consumed;
+		for (uint16_t n = 0; n < block.count; n++) {
+			TEST_ASSERT_EQUAL_UINT8(CHANNELS, block.channels);
+			TEST_ASSERT_EQUAL_INT16_ARRAY(input[block.sequence + n], &output[0][0] + n * CHANNELS, CHANNELS);
+		}
+		frames += block.count;
+	}
+
+	return frames;
+}
+
+void test_round_trip()
+{
+	mpu925x_codec_encoder encoder;
+
+	make_input();
+	for (uint8_t predictor = MPU925X_CODEC_NONE; predictor <= MPU925X_CODEC_LINEAR; predictor++) {
+		for (uint8_t coding = MPU925X_CODEC_VARINT; coding <= MPU925X_CODEC_RICE; coding++) {
+			encode(&encoder, predictor, coding);
+			TEST_ASSERT_EQUAL_UINT32(FRAMES, encoder.sequence);
+			TEST_ASSERT_EQUAL_UINT32(FRAMES, decode_and_compare(stream_size));
+
+			// Prediction compresses correlated data.
+			if (predictor != MPU925X_CODEC_NONE) {
+				TEST_ASSERT_TRUE(stream_size < FRAMES * CHANNELS * 2 * 3 / 4);
+			}
+		}
+	}
+}
+
+void test_resync()
+{
+	mpu925x_codec_encoder encoder;
+	mpu925x_codec_block block;
+
+	make_input();
+	encode(&encoder, MPU925X_CODEC_DELTA, MPU925X_CODEC_RICE);
+
+	// Corrupt a byte in second block, it is dropped and decoding continues.
+	uint32_t first = mpu925x_codec_decode(stream, stream_size, &output[0][0], 64, &block);
+	mpu925x_codec_decode(&stream[first], stream_size - first, &output[0][0], 64, &block);
+	stream[first + 20] ^= 0x10;
+	TEST_ASSERT_EQUAL_UINT32(FRAMES - block.count, decode_and_compare(stream_size));
+
+	// Noise before a block is skipped.
+	memmove(&stream[5], stream, stream_size);
+	memcpy(stream, "\xA5\x5A\xA5\x00\x01", 5);
+	TEST_ASSERT_EQUAL_UINT32(5 + first, mpu925x_codec_decode(stream, stream_size + 5, &output[0][0], 64, &block));
+	TEST_ASSERT_EQUAL_UINT32(5, block.skipped);
+}
+
+void test_partial_stream()
+{
+	mpu925x_codec_encoder encoder;
+	mpu925x_codec_block block;
+
+	make_input();
+	encode(&encoder, MPU925X_CODEC_LINEAR, MPU925X_CODEC_VARINT);
+
+	// Incomplete block isn't consumed, it needs more data.
+	uint32_t first = mpu925x_codec_decode(stream, stream_size, &output[0][0], 64, &block);
+	TEST_ASSERT_EQUAL_UINT32(0, mpu925x_codec_decode(stream, first - 1, &output[0][0], 64, &block));
+	TEST_ASSERT_EQUAL_UINT16(0, block.count);
+
+	// Trailing byte could be start of sync marker.
+	stream[0] = 0x00;
+	stream[1] = 0xA5;
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x_codec_decode(stream, 2, &output[0][0], 64, &block));
+
+	// Blocks larger than output are skipped.
+	encode(&encoder, MPU925X_CODEC_DELTA, MPU925X_CODEC_VARINT);
+	TEST_ASSERT_EQUAL_UINT16(0, (mpu925x_codec_decode(stream, first, &output[0][0], 32, &block), block.count));
+}
+
+void test_frame()
+{
+	int16_t frame[CHANNELS];
+
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu925x.sensor_data.acceleration_raw[i] = i + 1;
+		mpu925x.sensor_data.rotation_raw[i] = i + 5;
+		mpu925x.sensor_data.magnet_raw[i] = i + 8;
+	}
+	mpu925x.sensor_data.temperature_raw = 4;
+	mpu925x_codec_frame(&mpu925x, frame);
+	for (uint8_t i = 0; i < CHANNELS; i++) {
+		TEST_ASSERT_EQUAL_INT16(i + 1, frame[i]);
+	}
+}
+
+int main()
+{
+	RUN_TEST(test_round_trip);
+	RUN_TEST(test_resync);
+	RUN_TEST(test_partial_stream);
+	RUN_TEST(test_frame);
+
+	return UnityEnd();
+}
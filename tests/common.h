@@ -17,8 +17,188 @@
 
 #define VIRT_MEMORY_SIZE 256
 
+// Address of simulated auxiliary I2C slave.
+#define MOCK_AUX_ADDRESS 0x76
+
 uint8_t mpu_virt_mem[VIRT_MEMORY_SIZE];
 uint8_t ak_virt_mem[VIRT_MEMORY_SIZE];
+uint8_t aux_virt_mem[VIRT_MEMORY_SIZE];
+
+// Bus transaction counters.
+uint32_t mock_read_count;
+uint32_t mock_write_count;
+
+// FIFO simulator state.
+uint8_t mock_fifo[FIFO_SIZE];
+uint16_t mock_fifo_start, mock_fifo_count;
+
+// Simulated self-test responses in LSB (accelerometer xyz, gyroscope xyz)
+// and AK8963 self-test output.
+int16_t mock_self_test_response[6];
+int16_t mock_magnetometer_self_test[3];
+
+/**
+ * @brief Push a byte to simulated FIFO, oldest byte is dropped on overflow.
+ */
+void mock_fifo_push(uint8_t value)
+{
+	if (mock_fifo_count == FIFO_SIZE) {
+		mock_fifo_start = (mock_fifo_start + 1) % FIFO_SIZE;
+		mock_fifo_count--;
+		mpu_virt_mem[INT_STATUS] |= 1 << 4;
+	}
+	mock_fifo[(mock_fifo_start + mock_fifo_count) % FIFO_SIZE] = value;
+	mock_fifo_count++;
+}
+
+/**
+ * @brief Push a 16 bit sensor register to simulated FIFO.
+ * 
+ * @param reg High byte register of sensor output.
+ * @param response Self-test response added to output.
+ */
+void mock_fifo_push_register(uint8_t reg, int16_t response)
+{
+	int16_t value = convert8bitto16bit(mpu_virt_mem[reg], mpu_virt_mem[reg + 1]) + response;
+
+	mock_fifo_push((uint16_t)value >> 8);
+	mock_fifo_push(value & 0xFF);
+}
+
+/**
+ * @brief Memory of a slave on auxiliary I2C bus.
+ * 
+ * @param address 7 bit slave address.
+ * @return Slave memory, NULL if there is no slave at address.
+ */
+uint8_t *mock_aux_memory(uint8_t address)
+{
+	if (address == AK8963_ADDRESS)
+		return ak_virt_mem;
+	if (address == MOCK_AUX_ADDRESS)
+		return aux_virt_mem;
+
+	return NULL;
+}
+
+/**
+ * @brief Check if AK8963 is behind auxiliary I2C master, so it is not on
+ * main bus.
+ */
+uint8_t mock_aux_master()
+{
+	return (mpu_virt_mem[USER_CTRL] & USER_CTRL_I2C_MST_EN) != 0;
+}
+
+/**
+ * @brief Read enabled slaves 0 to 3 into EXT_SENS_DATA registers in order,
+ * as auxiliary I2C master does at every sample.
+ */
+void mock_aux_update()
+{
+	uint8_t position = 0;
+
+	if (!mock_aux_master())
+		return;
+
+	for (uint8_t i = 0; i < 4; i++) {
+		uint8_t address = mpu_virt_mem[I2C_SLV0_ADDR + i * 3];
+		uint8_t reg = mpu_virt_mem[I2C_SLV0_REG + i * 3];
+		uint8_t control = mpu_virt_mem[I2C_SLV0_CTRL + i * 3];
+		uint8_t *memory = mock_aux_memory(address & 0x7F);
+
+		if (!(control & I2C_SLV_EN))
+			continue;
+		for (uint8_t j = 0; j < (control & I2C_SLV_LENG) && position < 24; j++, position++) {
+			mpu_virt_mem[EXT_SENS_DATA_00 + position] = memory != NULL ? memory[(uint8_t)(reg + j)] : 0;
+		}
+	}
+}
+
+/**
+ * @brief Finish AK8963 self-test measurement immediately when it is started.
+ */
+void mock_ak8963_written(uint8_t reg, uint8_t value)
+{
+	if (reg == CNTL1 && (value & 0x0F) == 0b1000 && (ak_virt_mem[ASTC] & ASTC_SELF)) {
+		for (uint8_t i = 0; i < 3; i++) {
+			ak_virt_mem[HXL + i * 2] = (uint16_t)mock_magnetometer_self_test[i] & 0xFF;
+			ak_virt_mem[HXH + i * 2] = (uint16_t)mock_magnetometer_self_test[i] >> 8;
+		}
+		ak_virt_mem[ST1] |= 1;
+	}
+}
+
+/**
+ * @brief Run slave 4 transfer immediately, I2C_MST_STATUS is set to done or
+ * NACK.
+ */
+void mock_aux_transfer()
+{
+	uint8_t address = mpu_virt_mem[I2C_SLV4_ADDR];
+	uint8_t reg = mpu_virt_mem[I2C_SLV4_REG];
+	uint8_t *memory = mock_aux_memory(address & 0x7F);
+
+	mpu_virt_mem[I2C_SLV4_CTRL] &= ~I2C_SLV_EN;
+	if (!mock_aux_master() || memory == NULL) {
+		mpu_virt_mem[I2C_MST_STATUS] |= I2C_SLV4_NACK;
+		return;
+	}
+	if (address & I2C_SLV_READ)
+		mpu_virt_mem[I2C_SLV4_DI] = memory[reg];
+	else
+		memory[reg] = mpu_virt_mem[I2C_SLV4_DO];
+	if (memory == ak_virt_mem && !(address & I2C_SLV_READ))
+		mock_ak8963_written(reg, memory[reg]);
+	mpu_virt_mem[I2C_MST_STATUS] |= I2C_SLV4_DONE;
+}
+
+/**
+ * @brief Simulate sampling for given time, enabled outputs are pushed to
+ * FIFO in register order at 1 kHz / (1 + SMPLRT_DIV).
+ * 
+ * @param delay Time in milliseconds.
+ */
+void mock_sample(uint32_t delay)
+{
+	uint8_t enabled = mpu_virt_mem[FIFO_EN];
+	uint32_t samples = delay / (1 + mpu_virt_mem[SMPLRT_DIV]);
+
+	if (!(mpu_virt_mem[USER_CTRL] & USER_CTRL_FIFO_EN))
+		return;
+
+	for (uint32_t n = 0; n < samples; n++) {
+		if (enabled & FIFO_ACCEL) {
+			for (uint8_t i = 0; i < 3; i++) {
+				int16_t response = (mpu_virt_mem[ACCEL_CONFIG] & (0x80 >> i)) ? mock_self_test_response[i] : 0;
+				mock_fifo_push_register(ACCEL_XOUT_H + i * 2, response);
+			}
+		}
+		if (enabled & FIFO_TEMP) {
+			mock_fifo_push_register(TEMP_OUT_H, 0);
+		}
+		for (uint8_t i = 0; i < 3; i++) {
+			if (enabled & (0x40 >> i)) {
+				int16_t response = (mpu_virt_mem[GYRO_CONFIG] & (0x80 >> i)) ? mock_self_test_response[i + 3] : 0;
+				mock_fifo_push_register(GYRO_XOUT_H + i * 2, response);
+			}
+		}
+
+		// Enabled slaves take EXT_SENS_DATA registers in order.
+		uint8_t position = 0;
+		mock_aux_update();
+		for (uint8_t i = 0; i < 4; i++) {
+			uint8_t control = mpu_virt_mem[I2C_SLV0_CTRL + i * 3];
+			uint8_t length = (control & I2C_SLV_EN) ? control & I2C_SLV_LENG : 0;
+			uint8_t captured = i < 3 ? enabled & (1 << i) : mpu_virt_mem[I2C_MST_CTRL] & I2C_MST_SLV_3_FIFO_EN;
+
+			for (uint8_t j = 0; j < length && position < 24; j++, position++) {
+				if (captured)
+					mock_fifo_push(mpu_virt_mem[EXT_SENS_DATA_00 + position]);
+			}
+		}
+	}
+}
 
 /**
  * @brief Read data from virtual memory.
@@ -32,14 +212,35 @@ uint8_t ak_virt_mem[VIRT_MEMORY_SIZE];
  */
 uint8_t mock_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
 {
+	mock_read_count++;
+
+	if (slave_address == MPU925X_ADDRESS && reg == FIFO_R_W) {
+		for (uint16_t i = 0; i < size; i++) {
+			buffer[i] = mock_fifo_count > 0 ? mock_fifo[mock_fifo_start] : 0;
+			if (mock_fifo_count > 0) {
+				mock_fifo_start = (mock_fifo_start + 1) % FIFO_SIZE;
+				mock_fifo_count--;
+			}
+		}
+		return 0;
+	}
 	if (slave_address == MPU925X_ADDRESS) {
+		mpu_virt_mem[FIFO_COUNTH] = mock_fifo_count >> 8;
+		mpu_virt_mem[FIFO_COUNTL] = mock_fifo_count & 0xFF;
+		mock_aux_update();
 		for (uint16_t i = 0; i < size; i++) {
 			buffer[i] = mpu_virt_mem[reg + i];
 		}
+
+		// I2C_MST_STATUS and INT_STATUS are cleared on read.
+		if (reg <= I2C_MST_STATUS && reg + size > I2C_MST_STATUS)
+			mpu_virt_mem[I2C_MST_STATUS] = 0;
+		if (reg <= INT_STATUS && reg + size > INT_STATUS)
+			mpu_virt_mem[INT_STATUS] = 0;
 	}
 	if (slave_address == AK8963_ADDRESS) {
 		for (uint16_t i = 0; i < size; i++) {
-			buffer[i] = ak_virt_mem[reg + i];
+			buffer[i] = mock_aux_master() ? 0 : ak_virt_mem[reg + i];
 		}
 	}
 
@@ -58,30 +259,45 @@ uint8_t mock_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_
  */
 uint8_t mock_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
 {
+	mock_write_count++;
+
 	if (slave_address == MPU925X_ADDRESS) {
 		for (uint16_t i = 0; i < size; i++) {
 			mpu_virt_mem[reg + i] = buffer[i];
 		}
 	}
-	if (slave_address == AK8963_ADDRESS) {
+	if (slave_address == AK8963_ADDRESS && !mock_aux_master()) {
 		for (uint16_t i = 0; i < size; i++) {
 			ak_virt_mem[reg + i] = buffer[i];
 		}
+		mock_ak8963_written(reg, buffer[0]);
+	}
+
+	// Slave 4 transfer starts when it is enabled.
+	if (slave_address == MPU925X_ADDRESS && reg <= I2C_SLV4_CTRL && reg + size > I2C_SLV4_CTRL &&
+	    (mpu_virt_mem[I2C_SLV4_CTRL] & I2C_SLV_EN)) {
+		mock_aux_transfer();
+	}
+
+	// FIFO reset bit clears itself.
+	if (slave_address == MPU925X_ADDRESS && reg == USER_CTRL && (buffer[0] & USER_CTRL_FIFO_RST)) {
+		mock_fifo_start = 0;
+		mock_fifo_count = 0;
+		mpu_virt_mem[USER_CTRL] &= ~USER_CTRL_FIFO_RST;
 	}
 
 	return 0;
 }
 
 /**
- * @brief Mock delay function. This function is not necessary on tests but
- * necessary for driver.
+ * @brief Mock delay function. Time passes only for FIFO simulator.
  * 
  * @param mpu925x Main struct pointer.
  * @param delay Delay time in milliseconds.
  */
 void mock_delay(mpu925x_t *mpu925x, uint32_t delay)
 {
-
+	mock_sample(delay);
 }
 
 // Create mpu925x_t struct instance.
@@ -95,7 +311,8 @@ mpu925x_t mpu925x = {
 
 	.settings = {
 		// Other settings
-		.orientation = mpu925x_z_plus
+		.orientation = mpu925x_z_plus,
+		.address = MPU925X_ADDRESS
 	}
 };
 
@@ -107,6 +324,13 @@ void setUp()
 	// Clean virtual memory.
 	memset(mpu_virt_mem, 0, sizeof(mpu_virt_mem));
 	memset(ak_virt_mem, 0, sizeof(ak_virt_mem));
+	memset(aux_virt_mem, 0, sizeof(aux_virt_mem));
+	mock_read_count = 0;
+	mock_write_count = 0;
+	mock_fifo_start = 0;
+	mock_fifo_count = 0;
+	memset(mock_self_test_response, 0, sizeof(mock_self_test_response));
+	memset(mock_magnetometer_self_test, 0, sizeof(mock_magnetometer_self_test));
 
 	// Set WHO_AM_I and WIA registers.
 	mpu_virt_mem[WHO_AM_I] = 0x73;
@@ -0,0 +1,209 @@
+/**
+ * @file ekf_ahrs.c
+ * @author Ceyhun Şen
+ * @brief Test file for EKF AHRS against simulated trajectories.
+ */
+
+#include "common.h"
+#include "mpu925x_ekf_ahrs.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define SAMPLE_PERIOD 0.005f
+
+/**
+ * @brief Configure filter with noise levels used by simulation.
+ */
+void prepare_filter(mpu925x_ekf_ahrs *ekf, float magnetometer_noise)
+{
+	ekf->gyroscope_noise = 0.005f;
+	ekf->gyroscope_bias_noise = 0.0001f;
+	ekf->accelerometer_noise = 0.02f;
+	ekf->acceleration_rejection = 10.0f;
+	ekf->magnetometer_noise = magnetometer_noise;
+	ekf->sample_period = SAMPLE_PERIOD;
+	mpu925x_ekf_ahrs_init(ekf);
+}
+
+/**
+ * @brief Uniform noise in [-amplitude, amplitude].
+ */
+float noise(float amplitude)
+{
+	return amplitude * (2.0f * rand() / RAND_MAX - 1.0f);
+}
+
+/**
+ * @brief Angle in degrees between true and estimated attitude.
+ */
+float attitude_error(const double *truth, const float *estimate)
+{
+	double dot = fabs(truth[0] * estimate[0] + truth[1] * estimate[1] + truth[2] * estimate[2] + truth[3] * estimate[3]);
+
+	if (dot > 1)
+		dot = 1;
+	return 2 * acos(dot) * 180 / M_PI;
+}
+
+/**
+ * @brief Rotate world vector to body frame with true quaternion.
+ */
+void to_body(const double *q, const double *v, float *r)
+{
+	double w = q[0], x = q[1], y = q[2], z = q[3];
+
+	r[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y + w * z) * v[1] + 2 * (x * z - w * y) * v[2];
+	r[1] = 2 * (x * y - w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z + w * x) * v[2];
+	r[2] = 2 * (x * z + w * y) * v[0] + 2 * (y * z - w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+/**
+ * @brief Run simulated trajectory with constant gyroscope bias.
+ * 
+ * Platform swings around all axes for 60 seconds. Between 20th and 25th
+ * seconds it also accelerates sideways with 0.3g.
+ */
+void simulate(mpu925x_ekf_ahrs *ekf, const float *bias, float *maximum_error)
+{
+	const double up[3] = {0, 0, 1};
+	const double north[3] = {0.4, 0, -0.9};
+	double q[4] = {1, 0, 0, 0};
+	float rotation[3], acceleration[3], magnetic_field[3];
+
+	srand(1);
+	*maximum_error = 0;
+
+	to_body(q, up, acceleration);
+	to_body(q, north, magnetic_field);
+	mpu925x_ekf_ahrs_align(ekf, acceleration, ekf->magnetometer_noise > 0 ? magnetic_field : NULL);
+
+	for (uint32_t n = 1; n <= 60 / SAMPLE_PERIOD; n++) {
+		double t = n * SAMPLE_PERIOD;
+		double omega[3] = {0.5 * sin(0.7 * t), 0.4 * cos(0.5 * t), 0.3 * sin(0.3 * t)};
+
+		// Integrate true attitude.
+		double angle = sqrt(omega[0] * omega[0] + omega[1] * omega[1] + omega[2] * omega[2]) * SAMPLE_PERIOD;
+		double s = angle > 0 ? sin(angle / 2) / angle * SAMPLE_PERIOD : 0;
+		double d[4] = {cos(angle / 2), omega[0] * s, omega[1] * s, omega[2] * s};
+		double r[4] = {
+			q[0] * d[0] - q[1] * d[1] - q[2] * d[2] - q[3] * d[3],
+			q[0] * d[1] + q[1] * d[0] + q[2] * d[3] - q[3] * d[2],
+			q[0] * d[2] - q[1] * d[3] + q[2] * d[0] + q[3] * d[1],
+			q[0] * d[3] + q[1] * d[2] - q[2] * d[1] + q[3] * d[0],
+		};
+		for (uint8_t i = 0; i < 4; i++) {
+			q[i] = r[i];
+		}
+
+		// Generate measurements.
+		double specific_force[3] = {0, 0, 1};
+		if (t >= 20 && t < 25) {
+			specific_force[0] = 0.3;
+		}
+		to_body(q, specific_force, acceleration);
+		to_body(q, north, magnetic_field);
+		for (uint8_t i = 0; i < 3; i++) {
+			rotation[i] = omega[i] + bias[i] + noise(0.005f);
+			acceleration[i] += noise(0.01f);
+			magnetic_field[i] += noise(0.01f);
+		}
+
+		mpu925x_ekf_ahrs_predict(ekf, rotation, SAMPLE_PERIOD);
+		mpu925x_ekf_ahrs_correct_acceleration(ekf, acceleration);
+		if (ekf->magnetometer_noise > 0) {
+			mpu925x_ekf_ahrs_correct_magnetic_field(ekf, magnetic_field);
+		}
+
+		// Skip initial convergence.
+		if (t > 10) {
+			float error = attitude_error(q, ekf->quaternion);
+			if (error > *maximum_error) {
+				*maximum_error = error;
+			}
+		}
+	}
+}
+
+void test_align()
+{
+	mpu925x_ekf_ahrs ekf;
+	float acceleration[3] = {0, 0.5f, 0.8660254f};
+	float roll, pitch, yaw;
+
+	prepare_filter(&ekf, 0);
+	mpu925x_ekf_ahrs_align(&ekf, acceleration, NULL);
+	mpu925x_ekf_ahrs_get_euler(&ekf, &roll, &pitch, &yaw);
+
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 30.0, roll);
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, pitch);
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, yaw);
+}
+
+void test_trajectory_with_magnetometer()
+{
+	mpu925x_ekf_ahrs ekf;
+	float bias[3] = {0.02f, -0.015f, 0.01f};
+	float maximum_error;
+
+	prepare_filter(&ekf, 0.05f);
+	simulate(&ekf, bias, &maximum_error);
+
+	TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, maximum_error);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.003, bias[i], ekf.gyroscope_bias[i]);
+	}
+}
+
+void test_trajectory_without_magnetometer()
+{
+	mpu925x_ekf_ahrs ekf;
+	float bias[3] = {0.02f, -0.015f, 0.0f};
+	float maximum_error, roll, pitch, yaw;
+
+	prepare_filter(&ekf, 0);
+	simulate(&ekf, bias, &maximum_error);
+
+	// Heading is unobservable, only x and y bias converge while swinging.
+	for (uint8_t i = 0; i < 2; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.005, bias[i], ekf.gyroscope_bias[i]);
+	}
+	mpu925x_ekf_ahrs_get_euler(&ekf, &roll, &pitch, &yaw);
+	TEST_ASSERT_FALSE(isnan(roll) || isnan(pitch) || isnan(yaw));
+}
+
+void test_update_from_driver()
+{
+	mpu925x_ekf_ahrs ekf;
+	float roll, pitch, yaw;
+
+	prepare_filter(&ekf, 0);
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+
+	// Tilted 90 degrees around x axis and rotating 10 dps around x axis.
+	mpu_virt_mem[ACCEL_YOUT_H] = ACCELEROMETER_SCALE_2G >> 8;
+	mpu_virt_mem[ACCEL_YOUT_L] = ACCELEROMETER_SCALE_2G & 0xFF;
+	mpu_virt_mem[GYRO_XOUT_H] = 1310 >> 8;
+	mpu_virt_mem[GYRO_XOUT_L] = 1310 & 0xFF;
+
+	for (uint8_t i = 0; i < 100; i++) {
+		mpu925x_get_all(&mpu925x);
+		mpu925x_ekf_ahrs_update(&mpu925x, &ekf);
+	}
+	mpu925x_ekf_ahrs_get_euler(&ekf, &roll, &pitch, &yaw);
+
+	// Gyroscope disagrees with static accelerometer, so filter stays near it.
+	TEST_ASSERT_FLOAT_WITHIN(2.0, 90.0, roll);
+	TEST_ASSERT_FLOAT_WITHIN(1.0, 0.0, pitch);
+}
+
+int main()
+{
+	RUN_TEST(test_align);
+	RUN_TEST(test_trajectory_with_magnetometer);
+	RUN_TEST(test_trajectory_without_magnetometer);
+	RUN_TEST(test_update_from_driver);
+
+	return UnityEnd();
+}
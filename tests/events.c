@@ -0,0 +1,152 @@
+/**
+ * @file events.c
+ * @author Ceyhun Şen
+ * @brief Test file for motion event detection and wake-on-motion.
+ */
+
+#include "common.h"
+#include "mpu925x_events.h"
+#include <math.h>
+
+#define SAMPLE_RATE 100
+
+mpu925x_events events;
+
+/**
+ * @brief Configure every event at 100 Hz.
+ */
+void prepare()
+{
+	memset(&events, 0, sizeof(events));
+	events.sample_rate = SAMPLE_RATE;
+	events.tap_threshold = 0.5;
+	events.tap_duration = 50;
+	events.tap_latency = 100;
+	events.double_tap_window = 500;
+	events.free_fall_threshold = 0.3;
+	events.free_fall_time = 50;
+	events.shock_threshold = 4;
+	events.shock_holdoff = 100;
+	events.inactivity_threshold = 0.05;
+	events.inactivity_time = 1000;
+	events.step_threshold = 0.1;
+	events.step_interval = 250;
+	mpu925x_events_init(&events);
+}
+
+/**
+ * @brief Feed same sample a number of times, returns all flags.
+ */
+uint8_t feed(float x, float y, float z, uint16_t count)
+{
+	float acceleration[3] = {x, y, z};
+	uint8_t flags = 0;
+
+	for (uint16_t i = 0; i < count; i++) {
+		flags |= mpu925x_events_update(&events, acceleration);
+	}
+
+	return flags;
+}
+
+void test_tap()
+{
+	prepare();
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 1, 50));
+
+	// Tap is reported when 20 ms pulse ends.
+	TEST_ASSERT_EQUAL_HEX8(0, feed(1, 0, 1, 2));
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_EVENT_TAP, feed(0, 0, 1, 1));
+
+	// Pulse in latency is ignored, second tap is a double tap.
+	TEST_ASSERT_EQUAL_HEX8(0, feed(1, 0, 1, 1));
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 1, 20));
+	feed(1, 0, 1, 2);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_EVENT_TAP | MPU925X_EVENT_DOUBLE_TAP, feed(0, 0, 1, 1));
+
+	// Long push isn't a tap.
+	feed(0, 0, 1, 100);
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 1, 1, 10) & MPU925X_EVENT_TAP);
+}
+
+void test_free_fall_and_shock()
+{
+	prepare();
+	feed(0, 0, 1, 10);
+
+	// 50 ms free-fall is reported once.
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 0.1, 4));
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_EVENT_FREE_FALL, feed(0, 0, 0.1, 1));
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 0.1, 50) & MPU925X_EVENT_FREE_FALL);
+
+	// Impact, second shock is in holdoff.
+	TEST_ASSERT_TRUE(feed(0, 0, 6, 1) & MPU925X_EVENT_SHOCK);
+	feed(0, 0, 1, 5);
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 6, 1) & MPU925X_EVENT_SHOCK);
+	feed(0, 0, 1, 10);
+	TEST_ASSERT_TRUE(feed(0, 0, 6, 1) & MPU925X_EVENT_SHOCK);
+}
+
+void test_inactivity_and_steps()
+{
+	float acceleration[200][3];
+	uint8_t flags = 0;
+
+	prepare();
+
+	// Small noise is still, inactivity is reported after 1 s.
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0.01, 0, 1, 99));
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_EVENT_INACTIVITY, feed(0, 0.01, 1, 1));
+	TEST_ASSERT_EQUAL_HEX8(0, feed(0, 0, 1, 200));
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_EVENT_ACTIVITY, feed(0.2, 0, 1, 1) & MPU925X_EVENT_ACTIVITY);
+
+	// Walking at 2 steps per second for 10 s in blocks.
+	for (uint16_t block = 0; block < 5; block++) {
+		for (uint16_t n = 0; n < 200; n++) {
+			float t = (block * 200 + n) / (float)SAMPLE_RATE;
+			acceleration[n][0] = 0;
+			acceleration[n][1] = 0.1 * cosf(2 * M_PI * 2 * t);
+			acceleration[n][2] = 1 + 0.3 * sinf(2 * M_PI * 2 * t);
+		}
+		flags |= mpu925x_events_process(&events, acceleration, 200);
+	}
+	TEST_ASSERT_TRUE(flags & MPU925X_EVENT_STEP);
+	TEST_ASSERT_UINT32_WITHIN(1, 20, events.steps);
+	TEST_ASSERT_EQUAL_UINT8(0, events.inactive);
+}
+
+void test_wake_on_motion()
+{
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_set_accelerometer_dlpf(&mpu925x, 1, 3);
+
+	mpu925x_wake_on_motion_enable(&mpu925x, 0.1, mpu925x_wake_on_motion_31_25_hz);
+	TEST_ASSERT_EQUAL_HEX8(0b111, mpu_virt_mem[PWR_MGMT_2]);
+	TEST_ASSERT_EQUAL_HEX8(1, mpu_virt_mem[ACCEL_CONFIG_2]);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_INTERRUPT_WAKE_ON_MOTION, mpu_virt_mem[INT_ENABLE]);
+	TEST_ASSERT_EQUAL_HEX8(0xC0, mpu_virt_mem[MOT_DETECT_CTRL]);
+	TEST_ASSERT_EQUAL_UINT8(25, mpu_virt_mem[WOM_THR]);
+	TEST_ASSERT_EQUAL_UINT8(mpu925x_wake_on_motion_31_25_hz, mpu_virt_mem[LP_ACCEL_ODR]);
+	// Clock source is kept, reset bit isn't cleared by mock.
+	TEST_ASSERT_EQUAL_HEX8((1 << 5) | 1, mpu_virt_mem[PWR_MGMT_1] & 0x7F);
+
+	mpu_virt_mem[INT_STATUS] = MPU925X_INTERRUPT_WAKE_ON_MOTION;
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_INTERRUPT_WAKE_ON_MOTION, mpu925x_get_interrupt_status(&mpu925x));
+
+	mpu925x_wake_on_motion_disable(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(1, mpu_virt_mem[PWR_MGMT_1] & 0x7F);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[PWR_MGMT_2]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[INT_ENABLE]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[MOT_DETECT_CTRL]);
+	TEST_ASSERT_EQUAL_HEX8(3, mpu_virt_mem[ACCEL_CONFIG_2]);
+}
+
+int main()
+{
+	RUN_TEST(test_tap);
+	RUN_TEST(test_free_fall_and_shock);
+	RUN_TEST(test_inactivity_and_steps);
+	RUN_TEST(test_wake_on_motion);
+
+	return UnityEnd();
+}
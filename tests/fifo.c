@@ -0,0 +1,414 @@
+/**
+ * @file fifo.c
+ * @author Ceyhun Şen
+ * @brief Test file for FIFO capture.
+ */
+
+#include "common.h"
+
+#define START_US    1000000
+#define SLOW_PERIOD 1015
+
+uint64_t time_us;
+uint64_t latency_us;
+int16_t counter;
+mpu925x_fifo_frame frames[64];
+
+/**
+ * @brief Simulated host clock.
+ */
+uint64_t get_time_us(mpu925x_t *mpu925x)
+{
+	return time_us;
+}
+
+/**
+ * @brief Sample given amount of frames at 1 kHz, acceleration x and rotation
+ * z count samples.
+ */
+void sample(uint16_t amount)
+{
+	for (uint16_t i = 0; i < amount; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H] = (uint16_t)counter >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L] = counter & 0xFF;
+		mpu_virt_mem[GYRO_ZOUT_H] = (uint16_t)-counter >> 8;
+		mpu_virt_mem[GYRO_ZOUT_L] = (uint16_t)-counter & 0xFF;
+		counter++;
+		time_us += 1000;
+		mock_sample(1);
+	}
+}
+
+/**
+ * @brief Check that block continues counted stream.
+ */
+void check_block(mpu925x_fifo_block *block, uint32_t sequence, uint16_t count, int16_t first)
+{
+	TEST_ASSERT_EQUAL_UINT32(sequence, block->sequence);
+	TEST_ASSERT_EQUAL_UINT16(count, block->count);
+	for (uint16_t i = 0; i < count; i++) {
+		TEST_ASSERT_EQUAL_INT16(first + i, frames[i].acceleration_raw[0]);
+		TEST_ASSERT_EQUAL_INT16(-(first + i), frames[i].rotation_raw[2]);
+	}
+}
+
+void test_contiguous_blocks()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+
+	mpu925x_init(&mpu925x, 0);
+	mpu925x.master_specific.get_time_us = get_time_us;
+	time_us = 1000000;
+	counter = 0;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fifo_start(&mpu925x, &capture, 0, 1000));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER, 0));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, 1000));
+	TEST_ASSERT_EQUAL_UINT8(12, capture.layout.size);
+
+	// Newest frame is sampled just before read.
+	sample(10);
+	TEST_ASSERT_EQUAL_UINT16(10, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	check_block(&block, 0, 10, 0);
+	TEST_ASSERT_EQUAL_UINT64(time_us - 9000, block.timestamp);
+	TEST_ASSERT_EQUAL_UINT8(0, block.overflow);
+
+	// Frames which don't fit stay in FIFO, 40 frames need two bursts.
+	sample(40);
+	mock_read_count = 0;
+	TEST_ASSERT_EQUAL_UINT16(30, mpu925x_fifo_read(&mpu925x, &capture, frames, 30, &block));
+	TEST_ASSERT_EQUAL_UINT32(3, mock_read_count);
+	check_block(&block, 10, 30, 10);
+	TEST_ASSERT_EQUAL_UINT64(time_us - 39000, block.timestamp);
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	check_block(&block, 40, 10, 40);
+
+	// Empty FIFO.
+	TEST_ASSERT_EQUAL_UINT16(0, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL_UINT32(50, block.sequence);
+
+	mpu925x_fifo_stop(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[FIFO_EN]);
+	mpu925x.master_specific.get_time_us = NULL;
+}
+
+void test_overflow()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+
+	mpu925x_init(&mpu925x, 0);
+	counter = 0;
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, 1000);
+
+	// 50 frames don't fit in 512 bytes.
+	sample(50);
+	TEST_ASSERT_EQUAL_UINT16(0, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL_UINT8(1, block.overflow);
+	TEST_ASSERT_EQUAL_UINT32(1, capture.overflows);
+	TEST_ASSERT_EQUAL_UINT16(0, mock_fifo_count);
+
+	// First block after overflow is flagged, then stream is contiguous again.
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	TEST_ASSERT_EQUAL_UINT8(1, block.overflow);
+	sample(5);
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	TEST_ASSERT_EQUAL_UINT8(1, block.overflow);
+	check_block(&block, 0, 5, 50);
+	TEST_ASSERT_EQUAL_UINT64(0, block.timestamp);
+	sample(5);
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	TEST_ASSERT_EQUAL_UINT8(0, block.overflow);
+	check_block(&block, 5, 5, 55);
+	TEST_ASSERT_EQUAL_UINT64(5000, block.timestamp);
+}
+
+void test_layout()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+
+	mpu925x_init(&mpu925x, 0);
+	mpu_virt_mem[TEMP_OUT_H] = 0x12;
+	mpu_virt_mem[TEMP_OUT_L] = 0x34;
+	mpu_virt_mem[GYRO_YOUT_H] = 0x56;
+	mpu_virt_mem[GYRO_YOUT_L] = 0x78;
+	mpu925x_set_gyroscope_scale(&mpu925x, mpu925x_1000dps);
+
+	// Temperature and gyroscope y axis only.
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_TEMPERATURE | 0x20, 1000);
+	TEST_ASSERT_EQUAL_UINT8(4, capture.layout.size);
+	sample(3);
+	TEST_ASSERT_EQUAL_UINT16(3, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL_INT16(0x1234, frames[2].temperature_raw);
+	TEST_ASSERT_EQUAL_INT16(0x5678, frames[2].rotation_raw[1]);
+	TEST_ASSERT_EQUAL_INT16(0, frames[2].acceleration_raw[0]);
+	TEST_ASSERT_EQUAL_INT16(0, frames[2].rotation_raw[2]);
+	TEST_ASSERT_EQUAL(mpu925x_1000dps, block.gyroscope_scale);
+}
+
+void test_range_changes()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+	counter = 0;
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, 1000);
+
+	// Ranges change with frames still queued, same range isn't a change.
+	sample(5);
+	mpu925x_set_accelerometer_scale(&mpu925x, mpu925x_8g);
+	sample(3);
+	mpu925x_set_gyroscope_scale(&mpu925x, mpu925x_1000dps);
+	mpu925x_set_gyroscope_scale(&mpu925x, mpu925x_1000dps);
+	sample(4);
+
+	// Automatic range control increases accelerometer range.
+	mpu925x.auto_range.accelerometer = 1;
+	mpu_virt_mem[ACCEL_YOUT_H] = 0x7F;
+	mpu_virt_mem[ACCEL_YOUT_L] = 0xFF;
+	mpu925x_get_all(&mpu925x);
+	mpu925x.auto_range.accelerometer = 0;
+	TEST_ASSERT_EQUAL(mpu925x_16g, mpu925x.settings.accelerometer_scale);
+	sample(2);
+
+	// Blocks end at range changes.
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	check_block(&block, 0, 5, 0);
+	TEST_ASSERT_EQUAL(mpu925x_2g, block.accelerometer_scale);
+	TEST_ASSERT_EQUAL(mpu925x_250dps, block.gyroscope_scale);
+
+	// A smaller read leaves split point ahead.
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 2, &block);
+	check_block(&block, 5, 2, 5);
+	TEST_ASSERT_EQUAL(mpu925x_8g, block.accelerometer_scale);
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	check_block(&block, 7, 1, 7);
+	TEST_ASSERT_EQUAL(mpu925x_8g, block.accelerometer_scale);
+	TEST_ASSERT_EQUAL(mpu925x_250dps, block.gyroscope_scale);
+
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	check_block(&block, 8, 4, 8);
+	TEST_ASSERT_EQUAL(mpu925x_8g, block.accelerometer_scale);
+	TEST_ASSERT_EQUAL(mpu925x_1000dps, block.gyroscope_scale);
+
+	mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+	check_block(&block, 12, 2, 12);
+	TEST_ASSERT_EQUAL(mpu925x_16g, block.accelerometer_scale);
+	TEST_ASSERT_EQUAL(mpu925x_1000dps, block.gyroscope_scale);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x.fifo.splits);
+
+	// Too many pending changes drop FIFO like an overflow.
+	for (uint8_t i = 0; i <= MPU925X_FIFO_SPLITS; i++) {
+		sample(1);
+		mpu925x_set_gyroscope_scale(&mpu925x, i % 4);
+	}
+	sample(1);
+	TEST_ASSERT_EQUAL_UINT16(0, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL_UINT8(1, block.overflow);
+	sample(2);
+	TEST_ASSERT_EQUAL_UINT16(2, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL(MPU925X_FIFO_SPLITS % 4, block.gyroscope_scale);
+	mpu925x_fifo_stop(&mpu925x);
+}
+
+void test_raw_in_place()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	uint8_t raw[64];
+
+	mpu925x_init(&mpu925x, 0);
+	counter = 100;
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, 1000);
+	TEST_ASSERT_EQUAL_UINT8(MPU925X_LAYOUT_ABSENT, capture.layout.temperature);
+	TEST_ASSERT_EQUAL_UINT8(10, capture.layout.rotation[2]);
+
+	// Only whole frames are drained to buffer, they are read in place.
+	sample(6);
+	TEST_ASSERT_EQUAL_UINT16(5, mpu925x_fifo_read_raw(&mpu925x, &capture, raw, sizeof(raw), &block));
+	for (uint8_t n = 0; n < 5; n++) {
+		const uint8_t *frame = &raw[n * capture.layout.size];
+		TEST_ASSERT_EQUAL_INT16(100 + n, mpu925x_frame_value(frame, capture.layout.acceleration));
+		TEST_ASSERT_EQUAL_INT16(-(100 + n), mpu925x_frame_value(frame, capture.layout.rotation[2]));
+	}
+
+	// Register burst layout.
+	mpu925x_frame_decode(&mpu925x_register_layout, &mpu_virt_mem[ACCEL_XOUT_H], 1, frames);
+	TEST_ASSERT_EQUAL_INT16(105, frames[0].acceleration_raw[0]);
+	TEST_ASSERT_EQUAL_INT16(convert8bitto16bit(mpu_virt_mem[TEMP_OUT_H], mpu_virt_mem[TEMP_OUT_L]), frames[0].temperature_raw);
+	TEST_ASSERT_EQUAL_INT16(-105, frames[0].rotation_raw[2]);
+}
+
+/**
+ * @brief Pseudo random number generator.
+ */
+uint8_t random_byte(uint32_t *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 16;
+}
+
+/**
+ * @brief Random sensor and slave configurations, decoded frames must match
+ * simulated registers and generic decoder must match fast paths.
+ */
+void test_layout_properties()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	mpu925x_fifo_frame expected, generic[2];
+	uint8_t raw[2 * sizeof(mpu925x_fifo_frame)];
+	uint32_t seed = 1;
+
+	mpu925x_init(&mpu925x, 0);
+	for (uint16_t run = 0; run < 1000; run++) {
+		uint16_t sensors = (random_byte(&seed) << 1 | (random_byte(&seed) & 1)) & 0x1FF;
+		for (uint8_t i = 0; i < 4; i++) {
+			// Some runs without slaves, so fast paths are covered.
+			mpu_virt_mem[I2C_SLV0_CTRL + i * 3] = (run & 1) ? random_byte(&seed) & (I2C_SLV_EN | I2C_SLV_LENG) : 0;
+		}
+		for (uint8_t reg = ACCEL_XOUT_H; reg <= EXT_SENS_DATA_23; reg++) {
+			mpu_virt_mem[reg] = random_byte(&seed);
+		}
+
+		// Expected frame from registers.
+		memset(&expected, 0, sizeof(expected));
+		for (uint8_t i = 0; i < 3; i++) {
+			if (sensors & MPU925X_FIFO_ACCELEROMETER)
+				expected.acceleration_raw[i] = convert8bitto16bit(mpu_virt_mem[ACCEL_XOUT_H + i * 2], mpu_virt_mem[ACCEL_XOUT_L + i * 2]);
+			if (sensors & (0x40 >> i))
+				expected.rotation_raw[i] = convert8bitto16bit(mpu_virt_mem[GYRO_XOUT_H + i * 2], mpu_virt_mem[GYRO_XOUT_L + i * 2]);
+		}
+		if (sensors & MPU925X_FIFO_TEMPERATURE)
+			expected.temperature_raw = convert8bitto16bit(mpu_virt_mem[TEMP_OUT_H], mpu_virt_mem[TEMP_OUT_L]);
+		uint8_t position = 0;
+		for (uint8_t i = 0; i < 4; i++) {
+			uint8_t control = mpu_virt_mem[I2C_SLV0_CTRL + i * 3];
+			uint8_t length = (control & I2C_SLV_EN) ? control & I2C_SLV_LENG : 0;
+			uint16_t flag = i < 3 ? 1 << i : MPU925X_FIFO_SLAVE_3;
+
+			for (uint8_t j = 0; j < length && position < MPU925X_EXTERNAL_DATA_SIZE; j++, position++) {
+				if (sensors & flag)
+					expected.external_data[position] = mpu_virt_mem[EXT_SENS_DATA_00 + position];
+			}
+		}
+
+		if (mpu925x_fifo_start(&mpu925x, &capture, sensors, 1000) != 0) {
+			TEST_ASSERT_EQUAL_MEMORY(&(mpu925x_fifo_frame){0}, &expected, sizeof(expected));
+			continue;
+		}
+
+		// Layout matches bytes written by simulator.
+		mock_sample(3);
+		TEST_ASSERT_EQUAL_UINT16(3 * capture.layout.size, mock_fifo_count);
+		TEST_ASSERT_EQUAL_UINT16(3, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+		for (uint8_t n = 0; n < 3; n++) {
+			TEST_ASSERT_EQUAL_MEMORY(&expected, &frames[n], sizeof(expected));
+		}
+
+		mock_sample(2);
+		TEST_ASSERT_EQUAL_UINT16(2, mpu925x_fifo_read_raw(&mpu925x, &capture, raw, sizeof(raw), &block));
+		mpu925x_frame_layout table = capture.layout;
+		table.path = 0;
+		mpu925x_frame_decode(&table, raw, 2, generic);
+		mpu925x_frame_decode(&capture.layout, raw, 2, frames);
+		TEST_ASSERT_EQUAL_MEMORY(generic, frames, sizeof(generic));
+	}
+
+	mpu925x_fifo_stop(&mpu925x);
+	for (uint8_t i = 0; i < 4; i++) {
+		mpu_virt_mem[I2C_SLV0_CTRL + i * 3] = 0;
+	}
+}
+
+/**
+ * @brief Simulated host clock which is read with latency.
+ */
+uint64_t late_time_us(mpu925x_t *mpu925x)
+{
+	return time_us + latency_us;
+}
+
+/**
+ * @brief Sample given amount of frames with a slow sensor oscillator.
+ */
+void slow_sample(uint16_t amount)
+{
+	for (uint16_t i = 0; i < amount; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H] = (uint16_t)counter >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L] = counter & 0xFF;
+		counter++;
+		time_us += SLOW_PERIOD;
+		mock_sample(1);
+	}
+}
+
+/**
+ * @brief Every frame's timestamp must be within given band around its true
+ * time, counter in acceleration x tells which sample it is.
+ */
+void check_timestamps(mpu925x_fifo_block *block, int64_t minimum, int64_t maximum)
+{
+	for (uint16_t i = 0; i < block->count; i++) {
+		uint64_t sampled = START_US + (uint64_t)(frames[i].acceleration_raw[0] + 1) * SLOW_PERIOD;
+		int64_t error = (int64_t)(mpu925x_fifo_timestamp(block, i) - sampled);
+		TEST_ASSERT_TRUE(error >= minimum && error <= maximum);
+	}
+}
+
+void test_timestamp_reconstruction()
+{
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	uint32_t seed = 7;
+
+	mpu925x_init(&mpu925x, 0);
+	mpu925x.master_specific.get_time_us = late_time_us;
+	time_us = START_US;
+	counter = 0;
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER, 1000);
+
+	// Sensor is 1.5 % slow, reads have up to 100 us latency.
+	for (uint16_t i = 0; i < 1000; i++) {
+		slow_sample(5 + random_byte(&seed) % 26);
+		latency_us = random_byte(&seed) % 101;
+		mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block);
+		if (i >= 200)
+			check_timestamps(&block, 20, 80);
+	}
+	TEST_ASSERT_FLOAT_WITHIN(0.05, SLOW_PERIOD, block.period);
+	TEST_ASSERT_FLOAT_WITHIN(50, 15000, mpu925x_clock_sync_drift(&capture.clock));
+	TEST_ASSERT_EQUAL_UINT32(block.sequence, block.sample);
+
+	// Lost samples are counted, timestamps stay on the same line.
+	slow_sample(100);
+	latency_us = 50;
+	TEST_ASSERT_EQUAL_UINT16(0, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	slow_sample(10);
+	TEST_ASSERT_EQUAL_UINT16(10, mpu925x_fifo_read(&mpu925x, &capture, frames, 64, &block));
+	TEST_ASSERT_EQUAL_UINT8(1, block.overflow);
+	TEST_ASSERT_EQUAL_UINT32(frames[0].acceleration_raw[0], block.sample);
+	TEST_ASSERT_TRUE(block.sample > block.sequence);
+	check_timestamps(&block, 20, 80);
+
+	mpu925x_fifo_stop(&mpu925x);
+	mpu925x.master_specific.get_time_us = NULL;
+	latency_us = 0;
+}
+
+int main()
+{
+	RUN_TEST(test_contiguous_blocks);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_layout);
+	RUN_TEST(test_range_changes);
+	RUN_TEST(test_raw_in_place);
+	RUN_TEST(test_layout_properties);
+	RUN_TEST(test_timestamp_reconstruction);
+
+	return UnityEnd();
+}
@@ -0,0 +1,117 @@
+/**
+ * @file filter.c
+ * @author Ceyhun Şen
+ * @brief Test file for digital filter bank.
+ */
+
+#include "common.h"
+#include "mpu925x_filter.h"
+#include <math.h>
+
+#define SAMPLE_RATE 1000.0f
+#define BLOCK       1000
+
+float samples[BLOCK][3];
+
+/**
+ * @brief Fill block with a sine per axis, starting at sample offset.
+ */
+void fill(float frequency[3], uint32_t offset)
+{
+	for (uint16_t n = 0; n < BLOCK; n++) {
+		for (uint8_t i = 0; i < 3; i++) {
+			samples[n][i] = sinf(2 * M_PI * frequency[i] * (n + offset) / SAMPLE_RATE);
+		}
+	}
+}
+
+/**
+ * @brief Sine amplitude of an axis in second half of block, after filter
+ * settles.
+ */
+float amplitude(uint8_t axis)
+{
+	float sum = 0;
+
+	for (uint16_t n = BLOCK / 2; n < BLOCK; n++) {
+		sum += samples[n][axis] * samples[n][axis];
+	}
+
+	return sqrtf(2 * sum / (BLOCK / 2));
+}
+
+void test_butterworth_and_notch()
+{
+	mpu925x_filter filter;
+	mpu925x_biquad notch;
+	float frequency[3] = {10, 150, 300};
+
+	// 4th order low pass at 100 Hz, -15.8 dB at 150 Hz after frequency warping.
+	mpu925x_filter_init(&filter);
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_filter_add_butterworth_lowpass(&filter, 3, SAMPLE_RATE, 100));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_filter_add_butterworth_lowpass(&filter, 4, SAMPLE_RATE, 100));
+	TEST_ASSERT_EQUAL_UINT8(2, filter.section_count);
+
+	// Axes are filtered independently, same stream in blocks keeps state.
+	fill(frequency, 0);
+	mpu925x_filter_process(&filter, samples, 300);
+	mpu925x_filter_process(&filter, &samples[300], BLOCK - 300);
+	TEST_ASSERT_FLOAT_WITHIN(0.02, 1.0, amplitude(0));
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 0.163, amplitude(1));
+	TEST_ASSERT_TRUE(amplitude(2) < 0.01);
+
+	// Notch at 150 Hz removes it and passes the others.
+	mpu925x_filter_init(&filter);
+	mpu925x_biquad_notch(&notch, SAMPLE_RATE, 150, 10);
+	mpu925x_filter_add(&filter, &notch);
+	fill(frequency, 0);
+	mpu925x_filter_process(&filter, samples, BLOCK);
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 1.0, amplitude(0));
+	TEST_ASSERT_TRUE(amplitude(1) < 0.01);
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 1.0, amplitude(2));
+}
+
+void test_decimator()
+{
+	mpu925x_decimator decimator;
+	float taps[32], expected[BLOCK / 4][3];
+	float frequency[3] = {5, 20, 200};
+	uint16_t produced = 0;
+
+	mpu925x_fir_lowpass(taps, 32, 0.5 / 4);
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_decimator_init(&decimator, 4, taps, MPU925X_DECIMATOR_MAX_TAPS + 1));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_decimator_init(&decimator, 4, taps, 32));
+	fill(frequency, 0);
+
+	// Direct convolution at every 4th sample.
+	for (uint16_t m = 0; m < BLOCK / 4; m++) {
+		uint16_t n = m * 4 + 3;
+		for (uint8_t i = 0; i < 3; i++) {
+			expected[m][i] = 0;
+			for (uint8_t k = 0; k < 32 && k <= n; k++) {
+				expected[m][i] += taps[k] * samples[n - k][i];
+			}
+		}
+	}
+
+	// In place, in blocks which aren't multiples of factor.
+	for (uint16_t n = 0; n < BLOCK; n += 7) {
+		uint16_t count = BLOCK - n < 7 ? BLOCK - n : 7;
+		produced += mpu925x_decimator_process(&decimator, &samples[n], count, &samples[produced]);
+	}
+	TEST_ASSERT_EQUAL_UINT16(BLOCK / 4, produced);
+	TEST_ASSERT_EQUAL_FLOAT_ARRAY((float *)expected, (float *)samples, BLOCK / 4 * 3);
+
+	// 200 Hz is above output Nyquist frequency.
+	for (uint16_t m = BLOCK / 8; m < BLOCK / 4; m++) {
+		TEST_ASSERT_TRUE(fabsf(samples[m][2]) < 0.01);
+	}
+}
+
+int main()
+{
+	RUN_TEST(test_butterworth_and_notch);
+	RUN_TEST(test_decimator);
+
+	return UnityEnd();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file frame.c
+ * @author Ceyhun Şen
+ * @brief Test file for output frame conversion.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Write raw values of all sensors to virtual registers.
+ */
+void set_raw(int16_t *acceleration, int16_t *rotation, int16_t *magnet)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration[i] >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration[i] & 0xFF;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = (uint16_t)rotation[i] >> 8;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = (uint16_t)rotation[i] & 0xFF;
+		ak_virt_mem[HXL + i * 2] = (uint16_t)magnet[i] & 0xFF;
+		ak_virt_mem[HXH + i * 2] = (uint16_t)magnet[i] >> 8;
+	}
+}
+
+/**
+ * @brief Initialize driver with unity magnetometer sensitivity adjustment.
+ */
+void prepare()
+{
+	ak_virt_mem[ASAX] = 128;
+	ak_virt_mem[ASAY] = 128;
+	ak_virt_mem[ASAZ] = 128;
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+}
+
+void test_chip_frame()
+{
+	int16_t acceleration[3] = {ACCELEROMETER_SCALE_2G, 0, 0};
+	int16_t rotation[3] = {131, 262, 393};
+	int16_t magnet[3] = {100, 200, 300};
+
+	prepare();
+	mpu925x_set_mounting_matrix(&mpu925x, NULL);
+	set_raw(acceleration, rotation, magnet);
+
+	mpu925x_get_all(&mpu925x);
+
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.0, mpu925x.sensor_data.acceleration[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 3.0, mpu925x.sensor_data.rotation[2]);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.001, magnet[i] * MAGNETOMETER_SCALE_16_BIT, mpu925x.sensor_data.magnetic_field[i]);
+	}
+}
+
+void test_body_frame()
+{
+	// Sensor is mounted with x axis to body y, y axis to body -x.
+	float mounting[3][3] = {
+		{0, -1, 0},
+		{1, 0, 0},
+		{0, 0, 1}
+	};
+	int16_t acceleration[3] = {ACCELEROMETER_SCALE_2G, 0, 0};
+	int16_t rotation[3] = {131, 262, 393};
+	int16_t magnet[3] = {100, 200, 300};
+
+	prepare();
+	ak_virt_mem[ASAX] = 128 + 64;
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_set_mounting_matrix(&mpu925x, mounting);
+	set_raw(acceleration, rotation, magnet);
+
+	mpu925x_get_all(&mpu925x);
+
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.0, mpu925x.sensor_data.acceleration[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.0, mpu925x.sensor_data.acceleration[1]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, -2.0, mpu925x.sensor_data.rotation[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 1.0, mpu925x.sensor_data.rotation[1]);
+	TEST_ASSERT_FLOAT_WITHIN(0.0001, 3.0, mpu925x.sensor_data.rotation[2]);
+
+	// Magnetometer chip frame is (y, x, -z) of accelerometer frame, x axis
+	// has 1.25 sensitivity adjustment.
+	TEST_ASSERT_FLOAT_WITHIN(0.001, -125 * MAGNETOMETER_SCALE_16_BIT, mpu925x.sensor_data.magnetic_field[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 200 * MAGNETOMETER_SCALE_16_BIT, mpu925x.sensor_data.magnetic_field[1]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, -300 * MAGNETOMETER_SCALE_16_BIT, mpu925x.sensor_data.magnetic_field[2]);
+
+	mpu925x_set_mounting_matrix(&mpu925x, NULL);
+}
+
+int main()
+{
+	RUN_TEST(test_chip_frame);
+	RUN_TEST(test_body_frame);
+
+	return UnityEnd();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file fsync.c
+ * @author Ceyhun Şen
+ * @brief Test file for FSYNC configuration and decoding.
+ */
+
+#include "common.h"
+
+void test_configuration()
+{
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_set_gyroscope_dlpf(&mpu925x, 0b11, 3);
+
+	// EXT_SYNC_SET is set without touching low pass filter and bypass.
+	mpu925x_set_fsync(&mpu925x, mpu925x_fsync_accelerometer_z, 1, 1);
+	TEST_ASSERT_EQUAL_HEX8((7 << 3) | 3, mpu_virt_mem[CONFIG]);
+	TEST_ASSERT_EQUAL_HEX8(INT_PIN_CFG_BYPASS_EN | INT_PIN_CFG_ACTL_FSYNC | INT_PIN_CFG_FSYNC_INT_MODE_EN, mpu_virt_mem[INT_PIN_CFG]);
+	TEST_ASSERT_EQUAL_HEX8(FSYNC_INT_EN, mpu_virt_mem[INT_ENABLE]);
+	TEST_ASSERT_EQUAL(mpu925x_fsync_accelerometer_z, mpu925x.settings.fsync);
+
+	mpu925x_set_fsync(&mpu925x, mpu925x_fsync_temperature, 0, 0);
+	TEST_ASSERT_EQUAL_HEX8((1 << 3) | 3, mpu_virt_mem[CONFIG]);
+	TEST_ASSERT_EQUAL_HEX8(INT_PIN_CFG_BYPASS_EN, mpu_virt_mem[INT_PIN_CFG]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[INT_ENABLE]);
+
+	// Reset clears FSYNC configuration.
+	mpu925x_init(&mpu925x, 0);
+	TEST_ASSERT_EQUAL(mpu925x_fsync_disabled, mpu925x.settings.fsync);
+}
+
+void test_flag()
+{
+	int16_t acceleration[3] = {0, 0, 1};
+	int16_t rotation[3] = {2, 3, 4};
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fsync_flag(mpu925x_fsync_disabled, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fsync_flag(mpu925x_fsync_temperature, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fsync_flag(mpu925x_fsync_gyroscope_x, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fsync_flag(mpu925x_fsync_gyroscope_y, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fsync_flag(mpu925x_fsync_gyroscope_z, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fsync_flag(mpu925x_fsync_accelerometer_y, acceleration, 1, rotation));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fsync_flag(mpu925x_fsync_accelerometer_z, acceleration, 1, rotation));
+
+	// Negative values.
+	acceleration[0] = -1;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fsync_flag(mpu925x_fsync_accelerometer_x, acceleration, 0, rotation));
+}
+
+void test_sample_and_fifo()
+{
+	mpu925x_scheduler scheduler;
+	mpu925x_fifo_capture capture;
+	mpu925x_fifo_block block;
+	mpu925x_fifo_frame frames[4];
+
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+	mpu925x_set_fsync(&mpu925x, mpu925x_fsync_gyroscope_z, 0, 0);
+
+	// Default gyroscope z value 0x00FF has its LSB set.
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x.sensor_data.fsync);
+	mpu_virt_mem[GYRO_ZOUT_L] = 0xFE;
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x.sensor_data.fsync);
+
+	// Strobe is found in FIFO frames.
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_GYROSCOPE, 1000);
+	mock_sample(1);
+	mpu_virt_mem[GYRO_ZOUT_L] = 0xFF;
+	mock_sample(1);
+	TEST_ASSERT_EQUAL_UINT16(2, mpu925x_fifo_read(&mpu925x, &capture, frames, 4, &block));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fsync_flag(mpu925x.settings.fsync, frames[0].acceleration_raw, frames[0].temperature_raw, frames[0].rotation_raw));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fsync_flag(mpu925x.settings.fsync, frames[1].acceleration_raw, frames[1].temperature_raw, frames[1].rotation_raw));
+	mpu925x_fifo_stop(&mpu925x);
+}
+
+int main()
+{
+	RUN_TEST(test_configuration);
+	RUN_TEST(test_flag);
+	RUN_TEST(test_sample_and_fifo);
+
+	return UnityEnd();
+}
@@ -0,0 +1,295 @@
+/**
+ * @file gyroscope.c
+ * @author Ceyhun Şen
+ * @brief Test file for gyroscope.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Write raw values to virtual acceleration and rotation registers.
+ */
+void set_raw(int16_t *acceleration, int16_t *rotation)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration[i] >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration[i] & 0xFF;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = (uint16_t)rotation[i] >> 8;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = (uint16_t)rotation[i] & 0xFF;
+	}
+}
+
+/**
+ * @brief Prepare driver with 2g and 250 dps scales.
+ */
+void prepare()
+{
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+	memset(mpu925x.settings.gyroscope_bias, 0, sizeof(mpu925x.settings.gyroscope_bias));
+	mock_read_count = 0;
+	mock_write_count = 0;
+}
+
+void test_gyroscope_offset_single_pass()
+{
+	int16_t acceleration[3] = {0, 0, ACCELEROMETER_SCALE_2G};
+	int16_t rotation[3] = {40, -80, 120};
+	int16_t offset[3];
+
+	prepare();
+	set_raw(acceleration, rotation);
+
+	mpu925x_get_gyroscope_offset(&mpu925x, 50, offset);
+
+	// One read per sample for all three axes.
+	TEST_ASSERT_EQUAL(50, mock_read_count);
+	TEST_ASSERT_EQUAL(-10, offset[0]);
+	TEST_ASSERT_EQUAL(20, offset[1]);
+	TEST_ASSERT_EQUAL(-30, offset[2]);
+}
+
+void test_gyroscope_bias_estimator_still()
+{
+	int16_t acceleration[3] = {0, 0, ACCELEROMETER_SCALE_2G};
+	int16_t rotation[3] = {131, -262, 0};
+	mpu925x_gyroscope_bias_estimator estimator = {
+		.window = 20,
+		.variance_threshold = 0.01,
+		.acceleration_tolerance = 0.05,
+		.gain = 0.5
+	};
+	uint8_t updated = 0;
+
+	prepare();
+	set_raw(acceleration, rotation);
+
+	for (uint8_t i = 0; i < 20; i++) {
+		mpu925x_get_acceleration_raw(&mpu925x);
+		mpu925x_get_rotation_raw(&mpu925x);
+		updated = mpu925x_gyroscope_bias_update(&mpu925x, &estimator);
+	}
+
+	// Estimator doesn't touch the bus by itself.
+	TEST_ASSERT_EQUAL(40, mock_read_count);
+	TEST_ASSERT_EQUAL(1, updated);
+	TEST_ASSERT_EQUAL(1, estimator.still);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 1.0, mpu925x.settings.gyroscope_bias[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, -2.0, mpu925x.settings.gyroscope_bias[1]);
+
+	// Bias is removed in conversion path.
+	mpu925x_get_rotation(&mpu925x);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, mpu925x.sensor_data.rotation[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, mpu925x.sensor_data.rotation[1]);
+}
+
+void test_gyroscope_bias_estimator_moving()
+{
+	int16_t acceleration[3] = {0, 0, ACCELEROMETER_SCALE_2G};
+	int16_t rotation[3] = {131, 0, 0};
+	mpu925x_gyroscope_bias_estimator estimator = {
+		.window = 20,
+		.variance_threshold = 0.01,
+		.acceleration_tolerance = 0.05,
+		.gain = 0.5
+	};
+
+	prepare();
+
+	// Rotation changes too much.
+	for (uint8_t i = 0; i < 20; i++) {
+		rotation[0] = (i & 1) ? 1310 : -1310;
+		set_raw(acceleration, rotation);
+		mpu925x_get_acceleration_raw(&mpu925x);
+		mpu925x_get_rotation_raw(&mpu925x);
+		TEST_ASSERT_EQUAL(0, mpu925x_gyroscope_bias_update(&mpu925x, &estimator));
+	}
+	TEST_ASSERT_EQUAL(0, estimator.still);
+
+	// Sensor is accelerating.
+	rotation[0] = 131;
+	acceleration[2] = ACCELEROMETER_SCALE_2G * 1.5;
+	set_raw(acceleration, rotation);
+	for (uint8_t i = 0; i < 20; i++) {
+		mpu925x_get_acceleration_raw(&mpu925x);
+		mpu925x_get_rotation_raw(&mpu925x);
+		TEST_ASSERT_EQUAL(0, mpu925x_gyroscope_bias_update(&mpu925x, &estimator));
+	}
+	TEST_ASSERT_EQUAL(0, estimator.still);
+	TEST_ASSERT_EQUAL_FLOAT(0.0, mpu925x.settings.gyroscope_bias[0]);
+}
+
+void test_gyroscope_bias_estimator_range_change()
+{
+	// 225 dps, 0.9 of 250 dps full scale.
+	int16_t acceleration[3] = {0, 0, ACCELEROMETER_SCALE_2G};
+	int16_t rotation[3] = {29500, 0, 0};
+	mpu925x_gyroscope_bias_estimator estimator = {
+		.window = 20,
+		.variance_threshold = 0.01,
+		.acceleration_tolerance = 0.05,
+		.gain = 0.5
+	};
+	uint8_t updated = 0;
+
+	prepare();
+	set_raw(acceleration, rotation);
+	memset(&mpu925x.auto_range, 0, sizeof(mpu925x.auto_range));
+	for (uint8_t i = 0; i < 5; i++) {
+		mpu925x_get_all(&mpu925x);
+		TEST_ASSERT_EQUAL(0, mpu925x_gyroscope_bias_update(&mpu925x, &estimator));
+	}
+
+	// Range changes right after sample is read, sample keeps its old range.
+	mpu925x.auto_range.gyroscope = 1;
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL(mpu925x_500dps, mpu925x.settings.gyroscope_scale);
+	TEST_ASSERT_EQUAL(0, mpu925x_gyroscope_bias_update(&mpu925x, &estimator));
+	TEST_ASSERT_EQUAL(6, estimator.count);
+
+	// Window restarts with first sample of new range.
+	rotation[0] = 14750;
+	set_raw(acceleration, rotation);
+	for (uint8_t i = 0; i < 20; i++) {
+		TEST_ASSERT_EQUAL(0, updated);
+		mpu925x_get_all(&mpu925x);
+		updated = mpu925x_gyroscope_bias_update(&mpu925x, &estimator);
+	}
+	memset(&mpu925x.auto_range, 0, sizeof(mpu925x.auto_range));
+
+	TEST_ASSERT_EQUAL(1, updated);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 29500 / (float)GYROSCOPE_SCALE_250_DPS, mpu925x.settings.gyroscope_bias[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, mpu925x.settings.gyroscope_bias[1]);
+}
+
+void test_gyroscope_bias_commit()
+{
+	prepare();
+
+	// Existing hardware offset must be kept.
+	mpu_virt_mem[XG_OFFSET_L] = 10;
+	mpu925x.settings.gyroscope_bias[0] = 1.0;
+	mpu925x.settings.gyroscope_bias[1] = -2.0;
+
+	mpu925x_gyroscope_bias_commit(&mpu925x);
+
+	TEST_ASSERT_EQUAL(1, mock_read_count);
+	TEST_ASSERT_EQUAL(1, mock_write_count);
+	TEST_ASSERT_EQUAL(10 - 33, (int16_t)convert8bitto16bit(mpu_virt_mem[XG_OFFSET_H], mpu_virt_mem[XG_OFFSET_L]));
+	TEST_ASSERT_EQUAL(66, (int16_t)convert8bitto16bit(mpu_virt_mem[YG_OFFSET_H], mpu_virt_mem[YG_OFFSET_L]));
+	TEST_ASSERT_EQUAL_FLOAT(0.0, mpu925x.settings.gyroscope_bias[0]);
+}
+
+/**
+ * @brief Simulated temperature dependent bias.
+ */
+float bias_at(uint8_t axis, float temperature)
+{
+	float t = temperature - 25.0;
+	float coefficient[3][3] = {
+		{0.5, 0.02, 0.0004},
+		{-1.0, -0.01, 0.0},
+		{0.2, 0.0, -0.0002}
+	};
+
+	return coefficient[axis][0] + coefficient[axis][1] * t + coefficient[axis][2] * t * t;
+}
+
+void test_temperature_compensation()
+{
+	mpu925x_temperature_compensation compensation = {0};
+	float bias[3];
+
+	prepare();
+
+	// Single temperature gives constant model.
+	for (uint8_t i = 0; i < 3; i++) {
+		bias[i] = bias_at(i, 30.0);
+	}
+	mpu925x_temperature_compensation_learn(&compensation, 30.0, bias);
+	TEST_ASSERT_EQUAL(1, compensation.terms);
+
+	// Wide temperature span gives quadratic model.
+	for (float temperature = 0.0; temperature <= 60.0; temperature += 5.0) {
+		for (uint8_t i = 0; i < 3; i++) {
+			bias[i] = bias_at(i, temperature);
+		}
+		mpu925x_temperature_compensation_learn(&compensation, temperature, bias);
+	}
+	TEST_ASSERT_EQUAL(3, compensation.terms);
+
+	mpu925x.sensor_data.temperature = 47.5;
+	mpu925x_temperature_compensation_apply(&mpu925x, &compensation);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.001, bias_at(i, 47.5), mpu925x.settings.gyroscope_bias[i]);
+	}
+
+	// Apply doesn't touch the bus.
+	TEST_ASSERT_EQUAL(0, mock_read_count + mock_write_count);
+
+	// Conversion is only republished when model output moves.
+	uint32_t version = mpu925x.conversion.version;
+	mpu925x.sensor_data.temperature = 47.501;
+	mpu925x_temperature_compensation_apply(&mpu925x, &compensation);
+	TEST_ASSERT_EQUAL_UINT32(version, mpu925x.conversion.version);
+
+	// Bias blended in by estimator is kept on top of model drift.
+	mpu925x.settings.gyroscope_bias[0] += 0.5;
+	mpu925x.sensor_data.temperature = 50.0;
+	mpu925x_temperature_compensation_apply(&mpu925x, &compensation);
+	TEST_ASSERT_EQUAL_UINT32(version + 1, mpu925x.conversion.version);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, bias_at(0, 50.0) + 0.5, mpu925x.settings.gyroscope_bias[0]);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, bias_at(1, 50.0), mpu925x.settings.gyroscope_bias[1]);
+
+	// Relearned model replaces it.
+	for (uint8_t i = 0; i < 3; i++) {
+		bias[i] = bias_at(i, 50.0);
+	}
+	mpu925x_temperature_compensation_learn(&compensation, 50.0, bias);
+	mpu925x_temperature_compensation_apply(&mpu925x, &compensation);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, bias_at(0, 50.0), mpu925x.settings.gyroscope_bias[0]);
+}
+
+void test_temperature_compensation_serialization()
+{
+	mpu925x_temperature_compensation compensation = {0}, restored = {0};
+	uint8_t buffer[MPU925X_TEMPERATURE_COMPENSATION_SIZE];
+	float bias[3];
+
+	for (float temperature = 10.0; temperature <= 40.0; temperature += 1.0) {
+		for (uint8_t i = 0; i < 3; i++) {
+			bias[i] = bias_at(i, temperature);
+		}
+		mpu925x_temperature_compensation_learn(&compensation, temperature, bias);
+	}
+
+	TEST_ASSERT_EQUAL(0, mpu925x_temperature_compensation_export(&compensation, buffer, sizeof(buffer) - 1));
+	TEST_ASSERT_EQUAL(sizeof(buffer), mpu925x_temperature_compensation_export(&compensation, buffer, sizeof(buffer)));
+	TEST_ASSERT_EQUAL(0, mpu925x_temperature_compensation_import(&restored, buffer, sizeof(buffer)));
+	TEST_ASSERT_EQUAL(compensation.terms, restored.terms);
+	for (uint8_t i = 0; i < 3; i++) {
+		for (uint8_t j = 0; j < 3; j++) {
+			TEST_ASSERT_EQUAL_FLOAT(compensation.coefficient[i][j], restored.coefficient[i][j]);
+		}
+	}
+
+	// Corrupted data is rejected.
+	buffer[10] ^= 0x01;
+	TEST_ASSERT_EQUAL(2, mpu925x_temperature_compensation_import(&restored, buffer, sizeof(buffer)));
+	buffer[0] = 0;
+	TEST_ASSERT_EQUAL(1, mpu925x_temperature_compensation_import(&restored, buffer, sizeof(buffer)));
+}
+
+int main()
+{
+	RUN_TEST(test_gyroscope_offset_single_pass);
+	RUN_TEST(test_gyroscope_bias_estimator_still);
+	RUN_TEST(test_gyroscope_bias_estimator_moving);
+	RUN_TEST(test_gyroscope_bias_estimator_range_change);
+	RUN_TEST(test_gyroscope_bias_commit);
+	RUN_TEST(test_temperature_compensation);
+	RUN_TEST(test_temperature_compensation_serialization);
+
+	return UnityEnd();
+}
@@ -0,0 +1,135 @@
+/**
+ * @file health.c
+ * @author Ceyhun Şen
+ * @brief Test file for sensor health monitoring.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Write raw values to virtual acceleration and rotation registers.
+ */
+void set_raw(int16_t acceleration, int16_t rotation)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration & 0xFF;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = (uint16_t)rotation >> 8;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = (uint16_t)rotation & 0xFF;
+	}
+}
+
+/**
+ * @brief Initialize with health monitoring enabled and 2g and 250 dps scales.
+ */
+void prepare()
+{
+	memset(&mpu925x.health, 0, sizeof(mpu925x.health));
+	mpu925x.health.enabled = 1;
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+}
+
+void test_saturation()
+{
+	prepare();
+
+	// Only accelerometer z saturates.
+	set_raw(100, 100);
+	mpu_virt_mem[ACCEL_ZOUT_H] = 0x7F;
+	mpu_virt_mem[ACCEL_ZOUT_L] = 0xFF;
+	for (uint8_t i = 0; i < 4; i++) {
+		mpu925x_get_all(&mpu925x);
+		TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_ACCELEROMETER_SATURATED, mpu925x.health.flags);
+	}
+	TEST_ASSERT_EQUAL_UINT32(4, mpu925x.health.accelerometer_saturations);
+	TEST_ASSERT_EQUAL_UINT32(0, mpu925x.health.gyroscope_saturations);
+
+	// Gyroscope saturates at negative limit.
+	set_raw(100, INT16_MIN);
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_GYROSCOPE_SATURATED, mpu925x.health.flags);
+	TEST_ASSERT_EQUAL(mpu925x_250dps, mpu925x.settings.gyroscope_scale);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_ACCELEROMETER_SATURATED | MPU925X_HEALTH_GYROSCOPE_SATURATED, mpu925x.health.latched);
+}
+
+void test_stuck_and_disconnected()
+{
+	mpu925x_scheduler scheduler;
+
+	prepare();
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+
+	// Frame is stuck after it repeats 16 times.
+	set_raw(100, 200);
+	for (uint8_t i = 0; i < HEALTH_STUCK_LIMIT; i++) {
+		mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	}
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.health.flags);
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_STUCK, mpu925x.health.flags);
+
+	set_raw(101, 200);
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.health.flags);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.health.stuck_samples);
+
+	// Disconnected bus reads 0xFF everywhere.
+	memset(&mpu_virt_mem[ACCEL_XOUT_H], 0xFF, 14);
+	mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_IDENTITY, mpu925x.health.flags);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.health.identity_errors);
+}
+
+void test_temperature_and_magnetometer()
+{
+	prepare();
+	mpu925x.health.temperature_minimum = 0.0;
+	mpu925x.health.temperature_maximum = 50.0;
+
+	// 60 celsius degree and magnetometer overflow.
+	int16_t temperature = (int16_t)((60 - 21) * TEMPERATURE_SCALE);
+	mpu_virt_mem[TEMP_OUT_H] = (uint16_t)temperature >> 8;
+	mpu_virt_mem[TEMP_OUT_L] = (uint16_t)temperature & 0xFF;
+	ak_virt_mem[ST1] = 1;
+	ak_virt_mem[ST2] = MPU925X_MAGNETOMETER_OVERFLOW;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_TEMPERATURE | MPU925X_HEALTH_MAGNETOMETER_OVERFLOW, mpu925x.health.flags);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.health.temperature_errors);
+	TEST_ASSERT_EQUAL_UINT32(1, mpu925x.health.magnetometer_overflows);
+
+	// Default range accepts it.
+	mpu925x.health.temperature_maximum = 0.0;
+	ak_virt_mem[ST2] = 0;
+	mpu925x_get_all_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.health.flags);
+}
+
+void test_identity_check()
+{
+	prepare();
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_health_check_identity(&mpu925x));
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.health.latched);
+
+	mpu_virt_mem[WHO_AM_I] = 0x71;
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_health_check_identity(&mpu925x));
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_HEALTH_IDENTITY, mpu925x.health.latched);
+
+	// Disabled monitoring doesn't touch state.
+	memset(&mpu925x.health, 0, sizeof(mpu925x.health));
+	memset(&mpu_virt_mem[ACCEL_XOUT_H], 0xFF, 14);
+	mpu925x_get_all(&mpu925x);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.health.latched);
+}
+
+int main()
+{
+	RUN_TEST(test_saturation);
+	RUN_TEST(test_stuck_and_disconnected);
+	RUN_TEST(test_temperature_and_magnetometer);
+	RUN_TEST(test_identity_check);
+
+	return UnityEnd();
+}
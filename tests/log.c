@@ -0,0 +1,213 @@
+/**
+ * @file log.c
+ * @author Ceyhun Şen
+ * @brief Test file for binary sample log and replay.
+ */
+
+#include "common.h"
+#include "mpu925x_log.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+uint64_t mock_time;
+
+/**
+ * @brief Mock time function.
+ */
+uint64_t mock_get_time_us(mpu925x_t *mpu925x)
+{
+	return mock_time;
+}
+
+/**
+ * @brief Put a sample pattern to virtual registers, some magnetometer reads
+ * are overrun or overflowed.
+ */
+void set_sample(uint16_t n)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		int16_t acceleration = n * 7 - i * 1000, rotation = -n * 3 + i, magnet = n + i * 50;
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = (uint16_t)acceleration >> 8;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = (uint16_t)acceleration & 0xFF;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = (uint16_t)rotation >> 8;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = (uint16_t)rotation & 0xFF;
+		ak_virt_mem[HXL + i * 2] = (uint16_t)magnet & 0xFF;
+		ak_virt_mem[HXH + i * 2] = (uint16_t)magnet >> 8;
+	}
+	mpu_virt_mem[TEMP_OUT_H] = n >> 8;
+	mpu_virt_mem[TEMP_OUT_L] = n & 0xFF;
+	ak_virt_mem[ST1] = MPU925X_MAGNETOMETER_READY | (n % 5 == 2 ? MPU925X_MAGNETOMETER_OVERRUN : 0);
+	ak_virt_mem[ST2] = n % 7 == 4 ? MPU925X_MAGNETOMETER_OVERFLOW : 0;
+}
+
+void test_log_record_and_replay()
+{
+	char path[] = "/tmp/mpu925x_log_XXXXXX";
+	int fd = mkstemp(path);
+	close(fd);
+
+	float mounting[3][3] = {{0, 1, 0}, {-1, 0, 0}, {0, 0, 1}};
+	mpu925x_log_recorder recorder;
+	struct sensor_data recorded[100];
+
+	// Record.
+	ak_virt_mem[ASAX] = 140;
+	ak_virt_mem[ASAY] = 120;
+	ak_virt_mem[ASAZ] = 128;
+	mpu925x.master_specific.get_time_us = mock_get_time_us;
+	mpu925x.settings.accelerometer_scale = mpu925x_8g;
+	mpu925x.settings.gyroscope_scale = mpu925x_1000dps;
+	mpu925x_init(&mpu925x, 0);
+	mpu925x_set_mounting_matrix(&mpu925x, mounting);
+	mpu925x.settings.gyroscope_bias[1] = 0.25;
+	mpu925x_publish_settings(&mpu925x);
+
+	TEST_ASSERT_EQUAL(0, mpu925x_log_open(&recorder, path));
+	mock_time = 1000;
+	mpu925x_log_write_config(&recorder, &mpu925x);
+	for (uint16_t i = 0; i < 100; i++) {
+		// Include a gap which doesn't fit in 32 bits.
+		mock_time += (i == 50) ? 0x100000000ULL : (uint64_t)(1000 + i);
+		set_sample(i);
+		mpu925x_get_all(&mpu925x);
+		mpu925x_log_write_sample(&recorder, &mpu925x);
+		recorded[i] = mpu925x.sensor_data;
+	}
+	TEST_ASSERT_EQUAL(0, mpu925x_log_close(&recorder));
+	mpu925x.master_specific.get_time_us = NULL;
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERRUN, recorded[2].magnetometer_status);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERFLOW, recorded[4].magnetometer_status);
+
+	// Replay on a fresh driver instance.
+	mpu925x_t replayed = {0};
+	mpu925x_log_replay replay;
+
+	TEST_ASSERT_EQUAL(0, mpu925x_log_replay_open(&replay, path, 0));
+	mpu925x_log_replay_attach(&replay, &replayed);
+	TEST_ASSERT_EQUAL(0, mpu925x_init(&replayed, 0));
+
+	for (uint16_t i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL(0, mpu925x_log_replay_next(&replay));
+		mpu925x_get_all(&replayed);
+
+		TEST_ASSERT_EQUAL_UINT64(recorded[i].timestamp, replayed.sensor_data.timestamp);
+		TEST_ASSERT_EQUAL(recorded[i].temperature_raw, replayed.sensor_data.temperature_raw);
+		TEST_ASSERT_EQUAL_HEX8(recorded[i].magnetometer_status, replayed.sensor_data.magnetometer_status);
+		for (uint8_t j = 0; j < 3; j++) {
+			TEST_ASSERT_EQUAL(recorded[i].acceleration_raw[j], replayed.sensor_data.acceleration_raw[j]);
+			TEST_ASSERT_EQUAL(recorded[i].rotation_raw[j], replayed.sensor_data.rotation_raw[j]);
+			TEST_ASSERT_EQUAL(recorded[i].magnet_raw[j], replayed.sensor_data.magnet_raw[j]);
+			TEST_ASSERT_EQUAL_FLOAT(recorded[i].acceleration[j], replayed.sensor_data.acceleration[j]);
+			TEST_ASSERT_EQUAL_FLOAT(recorded[i].rotation[j], replayed.sensor_data.rotation[j]);
+			TEST_ASSERT_EQUAL_FLOAT(recorded[i].magnetic_field[j], replayed.sensor_data.magnetic_field[j]);
+		}
+	}
+	TEST_ASSERT_EQUAL(1, mpu925x_log_replay_next(&replay));
+	mpu925x_log_replay_close(&replay);
+
+	// Appending doesn't repeat file header.
+	TEST_ASSERT_EQUAL(0, mpu925x_log_open(&recorder, path));
+	mpu925x_log_write_config(&recorder, &mpu925x);
+	mpu925x_log_write_sample(&recorder, &mpu925x);
+	mpu925x_log_close(&recorder);
+
+	TEST_ASSERT_EQUAL(0, mpu925x_log_replay_open(&replay, path, 0));
+	uint16_t count = 0;
+	while (mpu925x_log_replay_next(&replay) == 0) {
+		count++;
+	}
+	TEST_ASSERT_EQUAL(101, count);
+	mpu925x_log_replay_close(&replay);
+
+	mpu925x_set_mounting_matrix(&mpu925x, NULL);
+	mpu925x.settings.gyroscope_bias[1] = 0.0;
+	mpu925x_publish_settings(&mpu925x);
+	remove(path);
+}
+
+/**
+ * @brief Ranges changed by automatic range control mid-log are replayed.
+ */
+void test_log_auto_range()
+{
+	char path[] = "/tmp/mpu925x_log_XXXXXX";
+	int fd = mkstemp(path);
+	close(fd);
+
+	mpu925x_log_recorder recorder;
+	struct sensor_data recorded[40];
+
+	mpu925x.settings.accelerometer_scale = mpu925x_2g;
+	mpu925x.settings.gyroscope_scale = mpu925x_250dps;
+	mpu925x_init(&mpu925x, 0);
+	mpu925x.auto_range.accelerometer = 1;
+	mpu925x.auto_range.gyroscope = 1;
+	mpu925x.auto_range.hold = 5;
+
+	// Near full scale at samples 10 to 19, quiet otherwise.
+	TEST_ASSERT_EQUAL(0, mpu925x_log_open(&recorder, path));
+	mpu925x_log_write_config(&recorder, &mpu925x);
+	for (uint16_t i = 0; i < 40; i++) {
+		set_sample(i);
+		if (i >= 10 && i < 20) {
+			mpu_virt_mem[ACCEL_YOUT_H] = 0x7F;
+			mpu_virt_mem[GYRO_ZOUT_H] = 0x80;
+		}
+		mpu925x_get_all(&mpu925x);
+		mpu925x_log_write_sample(&recorder, &mpu925x);
+		recorded[i] = mpu925x.sensor_data;
+	}
+	mpu925x_log_close(&recorder);
+	memset(&mpu925x.auto_range, 0, sizeof(mpu925x.auto_range));
+	TEST_ASSERT_NOT_EQUAL(recorded[0].accelerometer_scale, recorded[15].accelerometer_scale);
+	TEST_ASSERT_NOT_EQUAL(recorded[0].gyroscope_scale, recorded[15].gyroscope_scale);
+	TEST_ASSERT_EQUAL(mpu925x_2g, recorded[39].accelerometer_scale);
+
+	mpu925x_t replayed = {0};
+	mpu925x_log_replay replay;
+
+	TEST_ASSERT_EQUAL(0, mpu925x_log_replay_open(&replay, path, 0));
+	mpu925x_log_replay_attach(&replay, &replayed);
+	TEST_ASSERT_EQUAL(0, mpu925x_init(&replayed, 0));
+	for (uint16_t i = 0; i < 40; i++) {
+		TEST_ASSERT_EQUAL(0, mpu925x_log_replay_next(&replay));
+		mpu925x_get_all(&replayed);
+
+		TEST_ASSERT_EQUAL(recorded[i].accelerometer_scale, replayed.sensor_data.accelerometer_scale);
+		TEST_ASSERT_EQUAL(recorded[i].gyroscope_scale, replayed.sensor_data.gyroscope_scale);
+		for (uint8_t j = 0; j < 3; j++) {
+			TEST_ASSERT_EQUAL_FLOAT(recorded[i].acceleration[j], replayed.sensor_data.acceleration[j]);
+			TEST_ASSERT_EQUAL_FLOAT(recorded[i].rotation[j], replayed.sensor_data.rotation[j]);
+		}
+	}
+	mpu925x_log_replay_close(&replay);
+	remove(path);
+}
+
+/**
+ * @brief Failed writes are reported by flush and close.
+ */
+void test_log_write_error()
+{
+	mpu925x_log_recorder recorder;
+
+	mpu925x_init(&mpu925x, 0);
+
+	// Writes to /dev/full fail with no space left.
+	TEST_ASSERT_EQUAL(0, mpu925x_log_open(&recorder, "/dev/full"));
+	mpu925x_log_write_config(&recorder, &mpu925x);
+	TEST_ASSERT_EQUAL(1, mpu925x_log_flush(&recorder));
+
+	// Error stays until file is closed.
+	mpu925x_log_write_sample(&recorder, &mpu925x);
+	TEST_ASSERT_EQUAL(1, mpu925x_log_close(&recorder));
+}
+
+int main()
+{
+	RUN_TEST(test_log_record_and_replay);
+	RUN_TEST(test_log_auto_range);
+	RUN_TEST(test_log_write_error);
+
+	return UnityEnd();
+}
@@ -0,0 +1,125 @@
+/**
+ * @file magnetometer.c
+ * @author Ceyhun Şen
+ * @brief Test file for magnetometer.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Write raw magnetic field and status registers.
+ */
+void set_magnet(int16_t *magnet, uint8_t st1, uint8_t st2)
+{
+	for (uint8_t i = 0; i < 3; i++) {
+		ak_virt_mem[HXL + i * 2] = (uint16_t)magnet[i] & 0xFF;
+		ak_virt_mem[HXH + i * 2] = (uint16_t)magnet[i] >> 8;
+	}
+	ak_virt_mem[ST1] = st1;
+	ak_virt_mem[ST2] = st2;
+}
+
+void test_pipelined_measurement()
+{
+	int16_t magnet[3] = {100, -200, 300};
+	int16_t zero[3] = {0, 0, 0};
+
+	mpu925x.settings.bit_mode = mpu925x_16_bit;
+	mpu925x_set_magnetometer_measurement_mode(&mpu925x, mpu925x_pipelined_measurement_mode);
+	TEST_ASSERT_EQUAL_HEX8(0x01, ak_virt_mem[CNTL1] & 0x0F);
+
+	// Conversion is not finished yet, nothing is updated or triggered.
+	set_magnet(magnet, 0x00, 0x10);
+	ak_virt_mem[CNTL1] = 0;
+	mock_read_count = mock_write_count = 0;
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	TEST_ASSERT_EQUAL_UINT32(0, mock_write_count);
+	TEST_ASSERT_EQUAL_INT16_ARRAY(zero, mpu925x.sensor_data.magnet_raw, 3);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu925x.sensor_data.magnetometer_status);
+
+	// Result is collected and next measurement is triggered.
+	set_magnet(magnet, 0x01, 0x10);
+	mock_read_count = mock_write_count = 0;
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_read_count);
+	TEST_ASSERT_EQUAL_UINT32(1, mock_write_count);
+	TEST_ASSERT_EQUAL_HEX8(0x11, ak_virt_mem[CNTL1]);
+	TEST_ASSERT_EQUAL_INT16_ARRAY(magnet, mpu925x.sensor_data.magnet_raw, 3);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_READY, mpu925x.sensor_data.magnetometer_status);
+}
+
+void test_status_flags()
+{
+	int16_t magnet[3] = {1, 2, 3};
+	int16_t overflow[3] = {4000, 4000, 4000};
+
+	mpu925x.settings.measurement_mode = mpu925x_continuous_measurement_mode_2;
+
+	// Data overrun is reported with valid data.
+	set_magnet(magnet, 0x03, 0x10);
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_INT16_ARRAY(magnet, mpu925x.sensor_data.magnet_raw, 3);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERRUN, mpu925x.sensor_data.magnetometer_status);
+
+	// Overflowed data is discarded.
+	set_magnet(overflow, 0x01, 0x18);
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_INT16_ARRAY(magnet, mpu925x.sensor_data.magnet_raw, 3);
+	TEST_ASSERT_EQUAL_HEX8(MPU925X_MAGNETOMETER_READY | MPU925X_MAGNETOMETER_OVERFLOW, mpu925x.sensor_data.magnetometer_status);
+}
+
+void test_scheduler()
+{
+	int16_t magnet[3] = {10, 20, 30};
+	mpu925x_scheduler scheduler;
+	uint16_t magnetometer_reads = 0;
+
+	// Measurement mode set before initialization is kept.
+	mpu925x.settings.measurement_mode = mpu925x_continuous_measurement_mode_1;
+	mpu925x_init(&mpu925x, 0);
+	TEST_ASSERT_EQUAL_HEX8(0x12, ak_virt_mem[CNTL1]);
+
+	mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+	set_magnet(magnet, 0x01, 0x10);
+
+	// One second at 1 kHz, magnetometer has 8 new samples.
+	for (uint16_t i = 0; i < 1000; i++) {
+		mock_read_count = 0;
+		mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+		TEST_ASSERT_TRUE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_ACCELEROMETER);
+		TEST_ASSERT_TRUE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_GYROSCOPE);
+		if (mock_read_count > 1) {
+			magnetometer_reads++;
+			TEST_ASSERT_TRUE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_MAGNETOMETER);
+		}
+		else {
+			TEST_ASSERT_FALSE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_MAGNETOMETER);
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT16(9, magnetometer_reads);
+	TEST_ASSERT_EQUAL_INT16_ARRAY(magnet, mpu925x.sensor_data.magnet_raw, 3);
+
+	// Magnetometer isn't ready at due time, it is polled on every call.
+	ak_virt_mem[ST1] = 0;
+	magnetometer_reads = 0;
+	for (uint16_t i = 0; i < 200; i++) {
+		mock_read_count = 0;
+		mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+		if (mock_read_count > 1) {
+			magnetometer_reads++;
+		}
+		TEST_ASSERT_FALSE(mpu925x.sensor_data.refreshed & MPU925X_REFRESHED_MAGNETOMETER);
+	}
+	TEST_ASSERT_TRUE(magnetometer_reads > 50);
+	mpu925x.settings.measurement_mode = mpu925x_power_down_mode;
+}
+
+int main()
+{
+	RUN_TEST(test_pipelined_measurement);
+	RUN_TEST(test_status_flags);
+	RUN_TEST(test_scheduler);
+
+	return UnityEnd();
+}
@@ -0,0 +1,154 @@
+/**
+ * @file navigation.c
+ * @author Ceyhun Şen
+ * @brief Test file for linear acceleration and dead reckoning.
+ */
+
+#include "common.h"
+#include "mpu925x_navigation.h"
+#include <math.h>
+
+#define SAMPLE_RATE 1000
+
+mpu925x_navigation navigation;
+float samples[SAMPLE_RATE][3];
+
+/**
+ * @brief Configure navigation at 1 kHz with zero velocity updates.
+ */
+void prepare(float gravity)
+{
+	memset(&navigation, 0, sizeof(navigation));
+	navigation.sample_period = 1.0 / SAMPLE_RATE;
+	navigation.gravity = gravity;
+	navigation.zupt_acceleration = 0.02;
+	navigation.zupt_rotation = 2;
+	navigation.zupt_samples = 50;
+	mpu925x_navigation_init(&navigation);
+}
+
+/**
+ * @brief Gravity of a tilted sensor at rest is removed.
+ */
+void test_gravity_compensation()
+{
+	// 30 degrees about x axis, body to world.
+	float angle = 30 * M_PI / 180;
+	float quaternion[4] = {cosf(angle / 2), sinf(angle / 2), 0, 0};
+	float acceleration[3] = {0, sinf(angle), cosf(angle)};
+	float rotation[3] = {0, 0, 0};
+
+	prepare(0);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_navigation_update(&navigation, quaternion, acceleration, rotation));
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, navigation.linear_acceleration[i]);
+	}
+
+	// Calibrated accelerometer reading 1.01 g at rest.
+	for (uint16_t n = 0; n < 100; n++) {
+		for (uint8_t i = 0; i < 3; i++) {
+			samples[n][i] = acceleration[i] * 1.01;
+		}
+	}
+	prepare(0);
+	TEST_ASSERT_FLOAT_WITHIN(1e-4, 1.01, mpu925x_navigation_measure_gravity(&navigation, samples, 100));
+	TEST_ASSERT_EQUAL_UINT16(51, mpu925x_navigation_process(&navigation, quaternion, samples, NULL, 100, 0));
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, samples[99][i]);
+		TEST_ASSERT_FLOAT_WITHIN(1e-6, 0, navigation.position[i]);
+	}
+}
+
+/**
+ * @brief Fill samples with constant acceleration along body x axis.
+ */
+void fill_samples(float x)
+{
+	for (uint16_t n = 0; n < SAMPLE_RATE; n++) {
+		samples[n][0] = x;
+		samples[n][1] = 0;
+		samples[n][2] = 1;
+	}
+}
+
+/**
+ * @brief Constant acceleration integrates to velocity and position in world
+ * frame, over sample period of FIFO blocks.
+ */
+void test_integration()
+{
+	// 90 degrees about z axis, body x axis points to world y axis.
+	float quaternion[4] = {sqrtf(0.5), 0, 0, sqrtf(0.5)};
+	// Sensor oscillator 1.5% slower than nominal 1 kHz.
+	mpu925x_fifo_block block = {.period = 1015};
+	float a = 0.1 * MPU925X_STANDARD_GRAVITY;
+
+	prepare(1);
+	fill_samples(0.1);
+	TEST_ASSERT_EQUAL_UINT16(0, mpu925x_navigation_process(&navigation, quaternion, samples, NULL, SAMPLE_RATE, block.period * 1e-6f));
+
+	float t = SAMPLE_RATE * block.period * 1e-6f;
+	TEST_ASSERT_FLOAT_WITHIN(1e-4, a, samples[0][1]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-4, a, navigation.linear_acceleration[1]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, a * t, navigation.velocity[1]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, 0.5 * a * t * t, navigation.position[1]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, navigation.velocity[0]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-4, 0, navigation.velocity[2]);
+
+	// Block without period falls back to configured sample period.
+	prepare(1);
+	fill_samples(0.1);
+	mpu925x_navigation_process(&navigation, quaternion, samples, NULL, SAMPLE_RATE, 0);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, a, navigation.velocity[1]);
+	TEST_ASSERT_FLOAT_WITHIN(1e-3, 0.5 * a, navigation.position[1]);
+}
+
+/**
+ * @brief Velocity is zeroed after sensor stays still, rotation prevents it.
+ */
+void test_zero_velocity_update()
+{
+	float quaternion[4] = {1, 0, 0, 0};
+	float still[3] = {0, 0, 1.005};
+	float moving[3] = {0.2, 0, 1};
+	float rotation[3] = {0, 0, 0};
+	float turning[3] = {0, 0, 10};
+
+	prepare(1);
+	for (uint16_t n = 0; n < 100; n++) {
+		mpu925x_navigation_update(&navigation, quaternion, moving, rotation);
+	}
+	TEST_ASSERT_TRUE(navigation.velocity[0] > 0.19);
+
+	// Turning in place isn't still.
+	for (uint16_t n = 0; n < 100; n++) {
+		TEST_ASSERT_EQUAL_UINT8(0, mpu925x_navigation_update(&navigation, quaternion, still, turning));
+	}
+	TEST_ASSERT_TRUE(navigation.velocity[0] > 0.19);
+
+	for (uint16_t n = 0; n < 49; n++) {
+		TEST_ASSERT_EQUAL_UINT8(0, mpu925x_navigation_update(&navigation, quaternion, still, rotation));
+	}
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_navigation_update(&navigation, quaternion, still, rotation));
+	TEST_ASSERT_EQUAL_FLOAT(0, navigation.velocity[0]);
+	float position = navigation.position[0];
+	mpu925x_navigation_update(&navigation, quaternion, still, rotation);
+	TEST_ASSERT_EQUAL_FLOAT(position, navigation.position[0]);
+
+	// Disabled zero velocity updates integrate everything.
+	navigation.zupt_acceleration = 0;
+	mpu925x_navigation_init(&navigation);
+	for (uint16_t n = 0; n < 100; n++) {
+		TEST_ASSERT_EQUAL_UINT8(0, mpu925x_navigation_update(&navigation, quaternion, still, rotation));
+	}
+	TEST_ASSERT_TRUE(navigation.velocity[2] > 0);
+}
+
+int main()
+{
+	RUN_TEST(test_gravity_compensation);
+	RUN_TEST(test_integration);
+	RUN_TEST(test_zero_velocity_update);
+
+	return UnityEnd();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file real_time.c
+ * @author Ceyhun Şen
+ * @brief Worst-case bus transaction and delay checks for hot-path functions.
+ */
+
+#include "common.h"
+
+uint32_t delay_count;
+
+/**
+ * @brief Delay function which counts calls.
+ */
+void counting_delay(mpu925x_t *mpu925x, uint32_t delay)
+{
+	delay_count++;
+	mock_delay(mpu925x, delay);
+}
+
+/**
+ * @brief Start measuring a call.
+ */
+void measure()
+{
+	mock_read_count = 0;
+	mock_write_count = 0;
+	delay_count = 0;
+}
+
+/**
+ * @brief Check measured call against its bound.
+ */
+void check(uint32_t bound)
+{
+	TEST_ASSERT_EQUAL_UINT32(0, delay_count);
+	TEST_ASSERT_TRUE(mock_read_count + mock_write_count <= bound);
+}
+
+/**
+ * @brief Initialize sensor with counting delay function.
+ */
+void prepare(uint8_t real_time)
+{
+	mpu925x.master_specific.delay_ms = counting_delay;
+	mpu925x.settings.measurement_mode = mpu925x_continuous_measurement_mode_2;
+	mpu925x.settings.real_time = real_time;
+	mpu925x_init(&mpu925x, 0);
+}
+
+/**
+ * @brief Hot-path functions stay in their bounds in every magnetometer mode,
+ * data ready and overflow state.
+ */
+void test_hot_path_bounds()
+{
+	mpu925x_magnetometer_measurement_mode modes[] = {
+		mpu925x_power_down_mode,
+		mpu925x_single_measurement_mode,
+		mpu925x_continuous_measurement_mode_1,
+		mpu925x_continuous_measurement_mode_2,
+		mpu925x_external_trigger_measurement_mode,
+		mpu925x_pipelined_measurement_mode
+	};
+	mpu925x_scheduler scheduler;
+
+	prepare(0);
+
+	for (uint8_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+		mpu925x.settings.measurement_mode = modes[m];
+		mpu925x_scheduler_init(&mpu925x, &scheduler, 1000);
+
+		for (uint8_t state = 0; state < 4; state++) {
+			ak_virt_mem[ST1] = state & 1;
+			ak_virt_mem[ST2] = (state & 2) ? MPU925X_MAGNETOMETER_OVERFLOW : 0;
+
+			measure();
+			mpu925x_get_acceleration(&mpu925x);
+			check(MPU925X_TRANSACTIONS_ACCELERATION);
+
+			measure();
+			mpu925x_get_rotation(&mpu925x);
+			check(MPU925X_TRANSACTIONS_ROTATION);
+
+			measure();
+			mpu925x_get_temperature(&mpu925x);
+			check(MPU925X_TRANSACTIONS_TEMPERATURE);
+
+			measure();
+			mpu925x_get_magnetic_field(&mpu925x);
+			check(MPU925X_TRANSACTIONS_MAGNETIC_FIELD);
+
+			measure();
+			mpu925x_get_all(&mpu925x);
+			check(MPU925X_TRANSACTIONS_GET_ALL);
+
+			measure();
+			mpu925x_get_all_raw(&mpu925x);
+			check(MPU925X_TRANSACTIONS_GET_ALL);
+
+			// Cover both polling and counting down calls.
+			for (uint16_t i = 0; i < 300; i++) {
+				measure();
+				mpu925x_scheduler_get_all(&mpu925x, &scheduler);
+				check(MPU925X_TRANSACTIONS_SCHEDULER);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Magnetometer setters don't sleep in real-time profile.
+ */
+void test_real_time_setters()
+{
+	prepare(1);
+
+	measure();
+	mpu925x_set_magnetometer_measurement_mode(&mpu925x, mpu925x_continuous_measurement_mode_1);
+	check(MPU925X_TRANSACTIONS_MAGNETOMETER_SETTER);
+	TEST_ASSERT_EQUAL_HEX8(0b0010, ak_virt_mem[CNTL1] & 0x0F);
+
+	measure();
+	mpu925x_set_magnetometer_bit_mode(&mpu925x, mpu925x_14_bit);
+	check(MPU925X_TRANSACTIONS_MAGNETOMETER_SETTER);
+	TEST_ASSERT_EQUAL_HEX8(0, ak_virt_mem[CNTL1] & MAGNETOMETER_16_BIT_OUTPUT);
+
+	// Default profile waits for mode transition.
+	mpu925x.settings.real_time = 0;
+	measure();
+	mpu925x_set_magnetometer_bit_mode(&mpu925x, mpu925x_16_bit);
+	TEST_ASSERT_EQUAL_UINT32(1, delay_count);
+}
+
+/**
+ * @brief Invalid magnetometer data keeps previous raw values.
+ */
+void test_magnetometer_keeps_data()
+{
+	prepare(1);
+
+	ak_virt_mem[ST1] = 1;
+	ak_virt_mem[HXL] = 0x34;
+	ak_virt_mem[HXH] = 0x12;
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_INT16(0x1234, mpu925x.sensor_data.magnet_raw[0]);
+
+	ak_virt_mem[HXH] = 0x56;
+	ak_virt_mem[ST2] = MPU925X_MAGNETOMETER_OVERFLOW;
+	mpu925x_get_magnetic_field_raw(&mpu925x);
+	TEST_ASSERT_EQUAL_INT16(0x1234, mpu925x.sensor_data.magnet_raw[0]);
+}
+
+int main()
+{
+	RUN_TEST(test_hot_path_bounds);
+	RUN_TEST(test_real_time_setters);
+	RUN_TEST(test_magnetometer_keeps_data);
+
+	return UnityEnd();
+}
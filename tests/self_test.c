@@ -0,0 +1,188 @@
+/**
+ * @file self_test.c
+ * @author Ceyhun Şen
+ * @brief Test file for self-test against simulated sensor.
+ */
+
+#include "common.h"
+
+/**
+ * @brief Initialize driver and program factory self-test codes.
+ */
+void prepare()
+{
+	ak_virt_mem[ASAX] = 128;
+	ak_virt_mem[ASAY] = 128;
+	ak_virt_mem[ASAZ] = 128;
+	mpu925x_init(&mpu925x, 0);
+
+	// Factory responses: 2620 * 1.01 ^ (code - 1) LSB.
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[SELF_TEST_X_GYRO + i] = 100;
+		mpu_virt_mem[SELF_TEST_X_ACCEL + i] = 50;
+		mock_self_test_response[i] = 4273;
+		mock_self_test_response[i + 3] = 7005;
+	}
+	mock_magnetometer_self_test[0] = -150;
+	mock_magnetometer_self_test[1] = 120;
+	mock_magnetometer_self_test[2] = -1500;
+
+	// Resting sensor with small gyroscope offset.
+	mpu_virt_mem[ACCEL_ZOUT_H] = ACCELEROMETER_SCALE_2G >> 8;
+	mpu_virt_mem[ACCEL_ZOUT_L] = ACCELEROMETER_SCALE_2G & 0xFF;
+	mpu_virt_mem[GYRO_XOUT_H] = 0;
+	mpu_virt_mem[GYRO_XOUT_L] = 131;
+}
+
+void test_self_test_pass()
+{
+	mpu925x_self_test_result result;
+
+	prepare();
+	mpu_virt_mem[GYRO_CONFIG] = 0x18;
+	mock_read_count = 0;
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_self_test(&mpu925x, &result));
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, result.gyroscope_deviation[i]);
+		TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, result.accelerometer_deviation[i]);
+		TEST_ASSERT_FLOAT_WITHIN(0.01, 7005 / 131.0, result.gyroscope_response[i]);
+		TEST_ASSERT_FLOAT_WITHIN(0.001, 4273 / 16384.0, result.accelerometer_response[i]);
+	}
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 1.0, result.gyroscope_offset[0]);
+	TEST_ASSERT_EQUAL_INT16(-150, result.magnetometer_response[0]);
+	TEST_ASSERT_EQUAL_INT16(120, result.magnetometer_response[1]);
+	TEST_ASSERT_EQUAL_INT16(-1500, result.magnetometer_response[2]);
+	TEST_ASSERT_EQUAL_HEX8(0, result.magnetometer_failed);
+
+	// Settings are restored and FIFO is drained in few transactions.
+	TEST_ASSERT_EQUAL_HEX8(0x18, mpu_virt_mem[GYRO_CONFIG]);
+	TEST_ASSERT_EQUAL_HEX8(0, mpu_virt_mem[USER_CTRL]);
+	TEST_ASSERT_EQUAL(mpu925x_continuous_measurement_mode_2, mpu925x.settings.measurement_mode);
+	TEST_ASSERT_TRUE(mock_read_count < 80);
+}
+
+void test_self_test_fail()
+{
+	mpu925x_self_test_result result;
+
+	prepare();
+	mock_self_test_response[4] = 3000;
+	mock_self_test_response[2] = 9000;
+	mock_magnetometer_self_test[2] = -100;
+
+	TEST_ASSERT_EQUAL_UINT8(MPU925X_SELF_TEST_GYROSCOPE | MPU925X_SELF_TEST_ACCELEROMETER | MPU925X_SELF_TEST_MAGNETOMETER,
+	                        mpu925x_self_test(&mpu925x, &result));
+	TEST_ASSERT_EQUAL_HEX8(0b010, result.gyroscope_failed);
+	TEST_ASSERT_EQUAL_HEX8(0b100, result.accelerometer_failed);
+	TEST_ASSERT_EQUAL_HEX8(0b100, result.magnetometer_failed);
+	TEST_ASSERT_FLOAT_WITHIN(0.01, 3000 / 7005.0 - 1, result.gyroscope_deviation[1]);
+}
+
+/**
+ * @brief Delay function which lets first FIFO fill run long enough to
+ * overflow.
+ */
+uint8_t stretched;
+void stretching_delay(mpu925x_t *mpu925x, uint32_t delay)
+{
+	if (delay == SELF_TEST_FIFO_FILL_MS && !stretched) {
+		stretched = 1;
+		delay = 60;
+	}
+	mock_delay(mpu925x, delay);
+}
+
+void test_self_test_fifo_overflow()
+{
+	mpu925x_self_test_result result;
+
+	prepare();
+	stretched = 0;
+	mpu925x.master_specific.delay_ms = stretching_delay;
+
+	// Misaligned frames after overflow would corrupt averages.
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_self_test(&mpu925x, &result));
+	TEST_ASSERT_EQUAL_UINT8(1, stretched);
+	for (uint8_t i = 0; i < 3; i++) {
+		TEST_ASSERT_FLOAT_WITHIN(0.01, 7005 / 131.0, result.gyroscope_response[i]);
+		TEST_ASSERT_FLOAT_WITHIN(0.001, 4273 / 16384.0, result.accelerometer_response[i]);
+	}
+	mpu925x.master_specific.delay_ms = mock_delay;
+}
+
+/**
+ * @brief Write function which records USER_CTRL writes.
+ */
+uint8_t user_ctrl_written, master_dropped;
+uint8_t recording_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	if (slave_address == MPU925X_ADDRESS && reg == USER_CTRL) {
+		user_ctrl_written = buffer[0];
+		master_dropped |= !(buffer[0] & USER_CTRL_I2C_MST_EN);
+	}
+	return mock_write(mpu925x, slave_address, reg, buffer, size);
+}
+
+void test_self_test_fifo_and_master()
+{
+	mpu925x_self_test_result result;
+	mpu925x_fifo_capture capture;
+
+	prepare();
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_aux_enable(&mpu925x, 0));
+
+	// Running capture would lose its frames.
+	mpu925x_fifo_start(&mpu925x, &capture, MPU925X_FIFO_ACCELEROMETER | MPU925X_FIFO_GYROSCOPE, 1000);
+	mock_write_count = 0;
+	TEST_ASSERT_EQUAL_UINT8(MPU925X_SELF_TEST_BUSY, mpu925x_self_test(&mpu925x, &result));
+	TEST_ASSERT_EQUAL(0, mock_write_count);
+	mpu925x_fifo_stop(&mpu925x);
+
+	// FIFO enabled by application is restored with a reset, so no self-test
+	// frame is left in it, and auxiliary I2C master is never dropped.
+	mpu_virt_mem[FIFO_EN] = FIFO_ACCEL | FIFO_GYRO;
+	mpu_virt_mem[USER_CTRL] |= USER_CTRL_FIFO_EN;
+	master_dropped = 0;
+	mpu925x.master_specific.bus_write = recording_write;
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_self_test(&mpu925x, &result));
+	mpu925x.master_specific.bus_write = mock_write;
+	TEST_ASSERT_EQUAL_UINT8(0, master_dropped);
+	TEST_ASSERT_EQUAL_HEX8(USER_CTRL_FIFO_EN | USER_CTRL_I2C_MST_EN | USER_CTRL_FIFO_RST, user_ctrl_written);
+	TEST_ASSERT_EQUAL_HEX8(USER_CTRL_FIFO_EN | USER_CTRL_I2C_MST_EN, mpu_virt_mem[USER_CTRL]);
+	TEST_ASSERT_EQUAL_INT16(-1500, result.magnetometer_response[2]);
+
+	mpu925x_aux_disable(&mpu925x);
+}
+
+void test_self_test_without_factory_codes()
+{
+	mpu925x_self_test_result result;
+
+	prepare();
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[SELF_TEST_X_GYRO + i] = 0;
+		mpu_virt_mem[SELF_TEST_X_ACCEL + i] = 0;
+	}
+
+	// Absolute limits: at least 60 dps, 225 mg to 675 mg.
+	for (uint8_t i = 0; i < 3; i++) {
+		mock_self_test_response[i + 3] = 8000;
+	}
+	mock_self_test_response[0] = 1000;
+
+	TEST_ASSERT_EQUAL_UINT8(MPU925X_SELF_TEST_ACCELEROMETER, mpu925x_self_test(&mpu925x, &result));
+	TEST_ASSERT_EQUAL_HEX8(0b001, result.accelerometer_failed);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, result.accelerometer_deviation[1]);
+}
+
+int main()
+{
+	RUN_TEST(test_self_test_pass);
+	RUN_TEST(test_self_test_fail);
+	RUN_TEST(test_self_test_fifo_overflow);
+	RUN_TEST(test_self_test_fifo_and_master);
+	RUN_TEST(test_self_test_without_factory_codes);
+
+	return UnityEnd();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file shm.c
+ * @author Ceyhun Şen
+ * @brief Test file for shared memory sample ring.
+ */
+
+#include "common.h"
+#include "mpu925x_shm.h"
+#include <stdio.h>
+#include <unistd.h>
+
+char name[64];
+
+/**
+ * @brief Publish samples with increasing raw acceleration.
+ */
+void publish(mpu925x_shm_writer *writer, uint16_t amount)
+{
+	for (uint16_t i = 0; i < amount; i++) {
+		mpu925x.sensor_data.acceleration_raw[0]++;
+		mpu925x.sensor_data.timestamp += 1000;
+		mpu925x_shm_publish(writer, &mpu925x);
+	}
+}
+
+void test_ring()
+{
+	mpu925x_shm_writer writer;
+	mpu925x_shm_reader reader;
+	mpu925x_shm_sample sample;
+
+	snprintf(name, sizeof(name), "/mpu925x_test_%d", (int)getpid());
+	mpu925x.sensor_data.acceleration_raw[0] = 0;
+	mpu925x.sensor_data.timestamp = 0;
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_shm_create(&writer, name, 4, 1000));
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_shm_open(&reader, name));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_shm_read_latest(&reader, &sample));
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_shm_read_next(&reader, &sample));
+
+	// Samples are read in order.
+	publish(&writer, 2);
+	for (uint8_t i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL_UINT8(0, mpu925x_shm_read_next(&reader, &sample));
+		TEST_ASSERT_EQUAL_UINT64(i, sample.sequence);
+		TEST_ASSERT_EQUAL_INT16(i + 1, sample.acceleration_raw[0]);
+		TEST_ASSERT_EQUAL_UINT64((i + 1) * 1000, sample.timestamp);
+	}
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_shm_read_next(&reader, &sample));
+
+	// Slow reader loses oldest samples and continues from oldest available.
+	publish(&writer, 6);
+	TEST_ASSERT_EQUAL_UINT8(2, mpu925x_shm_read_next(&reader, &sample));
+	TEST_ASSERT_EQUAL_UINT64(4, sample.sequence);
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_shm_read_next(&reader, &sample));
+	TEST_ASSERT_EQUAL_UINT64(5, sample.sequence);
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_shm_read_latest(&reader, &sample));
+	TEST_ASSERT_EQUAL_UINT64(7, sample.sequence);
+	TEST_ASSERT_EQUAL_INT16(8, sample.acceleration_raw[0]);
+
+	mpu925x_shm_close(&reader);
+	mpu925x_shm_destroy(&writer);
+
+	// Ring is removed.
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_shm_open(&reader, name));
+}
+
+int main()
+{
+	RUN_TEST(test_ring);
+
+	return UnityEnd();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file spectrum.c
+ * @author Ceyhun Şen
+ * @brief Test file for FFT and Welch power spectral density.
+ */
+
+#include "common.h"
+#include "mpu925x_spectrum.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define SIZE 64
+
+void test_fft_real()
+{
+	float data[SIZE], input[SIZE];
+
+	TEST_ASSERT_EQUAL_UINT8(1, mpu925x_fft_real(data, 48));
+
+	for (uint16_t n = 0; n < SIZE; n++) {
+		input[n] = data[n] = 2.0f * rand() / RAND_MAX - 1;
+	}
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_fft_real(data, SIZE));
+
+	// Compare packed output with direct DFT.
+	for (uint16_t k = 0; k <= SIZE / 2; k++) {
+		double re = 0, im = 0;
+		for (uint16_t n = 0; n < SIZE; n++) {
+			re += input[n] * cos(2 * M_PI * k * n / SIZE);
+			im -= input[n] * sin(2 * M_PI * k * n / SIZE);
+		}
+		if (k == 0) {
+			TEST_ASSERT_FLOAT_WITHIN(1e-4, re, data[0]);
+		}
+		else if (k == SIZE / 2) {
+			TEST_ASSERT_FLOAT_WITHIN(1e-4, re, data[1]);
+		}
+		else {
+			TEST_ASSERT_FLOAT_WITHIN(1e-4, re, data[2 * k]);
+			TEST_ASSERT_FLOAT_WITHIN(1e-4, im, data[2 * k + 1]);
+		}
+	}
+}
+
+void test_welch()
+{
+	mpu925x_welch welch;
+	float buffer[SIZE * 3 / 2], psd[SIZE / 2 + 1];
+	float samples[100][3];
+	uint16_t segments = 0;
+
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_welch_init(&welch, buffer, psd, SIZE, 1000));
+
+	// 2 amplitude sine at 125 Hz on z axis, noise on other axes.
+	for (uint16_t block = 0; block < 10; block++) {
+		for (uint16_t n = 0; n < 100; n++) {
+			samples[n][0] = samples[n][1] = 2.0f * rand() / RAND_MAX - 1;
+			samples[n][2] = 2 * sinf(2 * M_PI * 125 * (block * 100 + n) / 1000.0f);
+		}
+		segments += mpu925x_welch_push(&welch, &samples[0][2], 100, 3);
+	}
+
+	// 1000 samples make 30 half-overlapped segments of 64.
+	TEST_ASSERT_EQUAL_UINT16(30, segments);
+	TEST_ASSERT_EQUAL_UINT32(30, welch.segments);
+
+	// Power of sine is amplitude^2 / 2, all of it is around 125 Hz.
+	TEST_ASSERT_FLOAT_WITHIN(0.02, 2.0, mpu925x_welch_band_power(&welch, 100, 150));
+	TEST_ASSERT_FLOAT_WITHIN(0.02, 2.0, mpu925x_welch_band_power(&welch, 0, 500));
+	TEST_ASSERT_TRUE(mpu925x_welch_band_power(&welch, 200, 500) < 1e-4);
+
+	mpu925x_welch_reset(&welch);
+	TEST_ASSERT_EQUAL_FLOAT(0, mpu925x_welch_band_power(&welch, 0, 500));
+}
+
+int main()
+{
+	RUN_TEST(test_fft_real);
+	RUN_TEST(test_welch);
+
+	return UnityEnd();
+}
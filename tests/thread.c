@@ -0,0 +1,179 @@
+/**
+ * @file thread.c
+ * @author Ceyhun Şen
+ * @brief Multi-threaded stress test for bus locking and settings publication.
+ */
+
+#include "common.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define ITERATIONS 20000
+
+pthread_mutex_t bus_mutex;
+volatile uint8_t in_transaction;
+volatile uint8_t overlapped;
+volatile uint8_t running;
+uint32_t torn;
+
+/**
+ * @brief Lock hook, recursive mutex.
+ */
+void lock(mpu925x_t *mpu925x)
+{
+	pthread_mutex_lock(&bus_mutex);
+}
+
+/**
+ * @brief Unlock hook.
+ */
+void unlock(mpu925x_t *mpu925x)
+{
+	pthread_mutex_unlock(&bus_mutex);
+}
+
+/**
+ * @brief Mark a transaction, overlapping transactions are recorded.
+ */
+void transaction_begin()
+{
+	if (in_transaction)
+		overlapped = 1;
+	in_transaction = 1;
+}
+
+/**
+ * @brief Read from mock bus and check that no other transaction runs.
+ */
+uint8_t checked_read(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	transaction_begin();
+	mock_read(mpu925x, slave_address, reg, buffer, size);
+	sched_yield();
+	in_transaction = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Write to mock bus and check that no other transaction runs.
+ */
+uint8_t checked_write(mpu925x_t *mpu925x, uint8_t slave_address, uint8_t reg, uint8_t *buffer, uint8_t size)
+{
+	transaction_begin();
+	sched_yield();
+	mock_write(mpu925x, slave_address, reg, buffer, size);
+	in_transaction = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Read and convert samples, all axes must be equal in every snapshot.
+ */
+void *reader(void *argument)
+{
+	while (running) {
+		mpu925x_get_all(&mpu925x);
+
+		float *acceleration = mpu925x.sensor_data.acceleration;
+		float *rotation = mpu925x.sensor_data.rotation;
+		if (acceleration[0] != acceleration[1] || acceleration[1] != acceleration[2] ||
+		    rotation[0] != rotation[1] || rotation[1] != rotation[2]) {
+			torn++;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Change scales, frame and biases.
+ */
+void *configurator(void *argument)
+{
+	float identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+	float inverted[3][3] = {{-1, 0, 0}, {0, -1, 0}, {0, 0, -1}};
+
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		mpu925x_set_gyroscope_scale(&mpu925x, i % 4);
+		mpu925x_set_accelerometer_scale(&mpu925x, i % 4);
+		mpu925x_set_mounting_matrix(&mpu925x, (i & 1) ? inverted : identity);
+		for (uint8_t j = 0; j < 3; j++) {
+			mpu925x.settings.gyroscope_bias[j] = i * 0.001;
+		}
+		mpu925x_publish_settings(&mpu925x);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Change gyroscope low pass filter, which shares GYRO_CONFIG with scale.
+ */
+void *filter(void *argument)
+{
+	for (uint32_t i = 0; i < ITERATIONS; i++) {
+		mpu925x_set_gyroscope_dlpf(&mpu925x, i & 0b11, i & 0b111);
+	}
+
+	return NULL;
+}
+
+void test_concurrent_access()
+{
+	pthread_mutexattr_t attributes;
+	pthread_t threads[3];
+
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&bus_mutex, &attributes);
+
+	mpu925x.master_specific.bus_read = checked_read;
+	mpu925x.master_specific.bus_write = checked_write;
+	mpu925x.master_specific.lock = lock;
+	mpu925x.master_specific.unlock = unlock;
+	TEST_ASSERT_EQUAL_UINT8(0, mpu925x_init(&mpu925x, 0));
+
+	// Same raw value on every axis.
+	for (uint8_t i = 0; i < 3; i++) {
+		mpu_virt_mem[ACCEL_XOUT_H + i * 2] = 0x10;
+		mpu_virt_mem[ACCEL_XOUT_L + i * 2] = 0x00;
+		mpu_virt_mem[GYRO_XOUT_H + i * 2] = 0x01;
+		mpu_virt_mem[GYRO_XOUT_L + i * 2] = 0x23;
+	}
+
+	running = 1;
+	pthread_create(&threads[0], NULL, reader, NULL);
+	pthread_create(&threads[1], NULL, configurator, NULL);
+	pthread_create(&threads[2], NULL, filter, NULL);
+	pthread_join(threads[1], NULL);
+	pthread_join(threads[2], NULL);
+	running = 0;
+	pthread_join(threads[0], NULL);
+
+	TEST_ASSERT_EQUAL_UINT8(0, overlapped);
+	TEST_ASSERT_EQUAL_UINT32(0, torn);
+
+	// Read-modify-write sequences didn't overwrite each other.
+	uint32_t last = ITERATIONS - 1;
+	TEST_ASSERT_EQUAL_HEX8(((last % 4) << 3) | (~last & 0b11), mpu_virt_mem[GYRO_CONFIG]);
+	TEST_ASSERT_EQUAL_HEX8(last & 0b111, mpu_virt_mem[CONFIG] & 0b111);
+
+	// Settings are consistent after all writers are done.
+	mpu925x_get_rotation(&mpu925x);
+	TEST_ASSERT_FLOAT_WITHIN(0.001, -(0x123 / GYROSCOPE_SCALE_2000_DPS - last * 0.001), mpu925x.sensor_data.rotation[0]);
+
+	mpu925x.master_specific.lock = NULL;
+	mpu925x.master_specific.unlock = NULL;
+	mpu925x.master_specific.bus_read = mock_read;
+	mpu925x.master_specific.bus_write = mock_write;
+	pthread_mutex_destroy(&bus_mutex);
+}
+
+int main()
+{
+	RUN_TEST(test_concurrent_access);
+
+	return UnityEnd();
+}